@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2017, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+#include "mbed_checksum.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace utest::v1;
+
+#define BUFFER_SIZE         1600
+#define RANDOM_ITERATIONS   2000
+#define BENCHMARK_BYTES     (256 * 1024)
+
+static uint8_t buffer[BUFFER_SIZE + 8];
+
+// Byte-pair summation straight from RFC 1071
+static uint16_t reference_checksum(const uint8_t *data, size_t len)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += (uint32_t)data[i] << 8 | data[i + 1];
+    }
+    if (len & 1) {
+        sum += (uint32_t)data[len - 1] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return sum;
+}
+
+// Reads a memory order sum as a big-endian value
+static uint16_t network_order(uint16_t sum)
+{
+    const uint8_t *bytes = (const uint8_t *)&sum;
+    return (uint16_t)bytes[0] << 8 | bytes[1];
+}
+
+static void fill_random(uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        data[i] = rand();
+    }
+}
+
+static void check(const uint8_t *data, size_t len)
+{
+    uint16_t expected = reference_checksum(data, len);
+    TEST_ASSERT_EQUAL_HEX16(expected, network_order(mbed_checksum(data, len)));
+    TEST_ASSERT_EQUAL_HEX16(expected, network_order(mbed_checksum_portable(data, len)));
+}
+
+void test_case_known_values()
+{
+    // Example from RFC 1071 section 3
+    const uint8_t rfc1071[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    TEST_ASSERT_EQUAL_HEX16(0xddf2, network_order(mbed_checksum(rfc1071, sizeof(rfc1071))));
+
+    TEST_ASSERT_EQUAL_HEX16(0x0000, mbed_checksum(buffer, 0));
+
+    // Carries must wrap around rather than be lost
+    memset(buffer, 0xff, BUFFER_SIZE);
+    check(buffer, BUFFER_SIZE);
+    check(buffer + 1, BUFFER_SIZE - 1);
+}
+
+void test_case_alignments()
+{
+    fill_random(buffer, sizeof(buffer));
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len < 64; len++) {
+            check(buffer + offset, len);
+        }
+    }
+}
+
+void test_case_random()
+{
+    srand(0x6d626564);
+
+    for (int i = 0; i < RANDOM_ITERATIONS; i++) {
+        size_t offset = rand() % 8;
+        size_t len = rand() % (BUFFER_SIZE + 1);
+        fill_random(buffer + offset, len);
+        check(buffer + offset, len);
+    }
+}
+
+void test_case_benchmark()
+{
+    const size_t lengths[] = { 20, 64, 576, 1500 };
+    fill_random(buffer, sizeof(buffer));
+
+    Timer timer;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            size_t len = lengths[i];
+            size_t rounds = BENCHMARK_BYTES / len;
+            volatile uint16_t sink = 0;
+
+            timer.reset();
+            timer.start();
+            for (size_t r = 0; r < rounds; r++) {
+                sink += reference_checksum(buffer + offset, len);
+            }
+            timer.stop();
+            int reference_us = timer.read_us();
+
+            timer.reset();
+            timer.start();
+            for (size_t r = 0; r < rounds; r++) {
+                sink += mbed_checksum(buffer + offset, len);
+            }
+            timer.stop();
+            int checksum_us = timer.read_us();
+
+            printf("len %4u offset %u: reference %6dus, mbed_checksum %6dus (%.1fMB/s)\r\n",
+                    len, offset, reference_us, checksum_us,
+                    checksum_us ? (float)(rounds * len) / checksum_us : 0.0f);
+        }
+    }
+}
+
+Case cases[] = {
+    Case("known values", test_case_known_values),
+    Case("alignments", test_case_alignments),
+    Case("random equivalence", test_case_random),
+    Case("benchmark", test_case_benchmark),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(60, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    Harness::run(specification);
+}
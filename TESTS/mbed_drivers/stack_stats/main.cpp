@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2013-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+#include "rtos.h"
+#include "mbed_stats.h"
+
+#if !defined(MBED_STACK_STATS_ENABLED) || !MBED_STACK_STATS_ENABLED || !MBED_CONF_RTOS_PRESENT
+  #error [NOT_SUPPORTED] test not supported
+#endif
+
+using namespace utest::v1;
+
+#define MAX_THREADS     16
+#define STACK_SIZE      1024
+#define STACK_USE       600
+#define SAMPLE_PERIOD   20
+
+static Semaphore go;
+static Semaphore ready;
+static osThreadId worker_tid;
+static volatile uint32_t sampled_thread;
+static volatile uint32_t sampled_max;
+
+static void use_stack()
+{
+    volatile uint8_t buffer[STACK_USE];
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i;
+    }
+}
+
+static void worker()
+{
+    worker_tid = Thread::gettid();
+    ready.release();
+    go.wait();
+    use_stack();
+    go.wait();
+}
+
+static const mbed_stats_stack_t *find(const mbed_stats_stack_t *stats, size_t count, osThreadId tid)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (stats[i].thread_id == (uint32_t)tid) {
+            return &stats[i];
+        }
+    }
+    return NULL;
+}
+
+void test_case_sample_matches_full_scan()
+{
+    mbed_stats_stack_t full[MAX_THREADS];
+    mbed_stats_stack_t sampled[MAX_THREADS];
+    Thread thread(osPriorityNormal, STACK_SIZE);
+    thread.start(worker);
+    ready.wait();
+
+    // First sample records the initial high-water mark
+    size_t count = mbed_stats_stack_sample_each(sampled, MAX_THREADS);
+    const mbed_stats_stack_t *before = find(sampled, count, worker_tid);
+    TEST_ASSERT(before != NULL);
+    uint32_t initial = before->max_size;
+
+    go.release();
+    Thread::wait(10);
+
+    // The incremental scan picks up the growth and agrees with a full scan
+    count = mbed_stats_stack_sample_each(sampled, MAX_THREADS);
+    const mbed_stats_stack_t *after = find(sampled, count, worker_tid);
+    TEST_ASSERT(after != NULL);
+    TEST_ASSERT(after->max_size >= initial + STACK_USE);
+
+    count = mbed_stats_stack_get_each(full, MAX_THREADS);
+    const mbed_stats_stack_t *exact = find(full, count, worker_tid);
+    TEST_ASSERT(exact != NULL);
+    TEST_ASSERT_EQUAL_UINT32(exact->max_size, after->max_size);
+    TEST_ASSERT_EQUAL_UINT32(STACK_SIZE, after->reserved_size);
+
+    go.release();
+    thread.join();
+}
+
+static void sampler_cb(const mbed_stats_stack_t *stats)
+{
+    sampled_thread = stats->thread_id;
+    sampled_max = stats->max_size;
+}
+
+void test_case_sampler_threshold()
+{
+    Thread thread(osPriorityNormal, STACK_SIZE);
+    thread.start(worker);
+    ready.wait();
+
+    sampled_thread = 0;
+    TEST_ASSERT_EQUAL(0, mbed_stats_stack_sampler_start(SAMPLE_PERIOD, 50, sampler_cb));
+    TEST_ASSERT_EQUAL(-1, mbed_stats_stack_sampler_start(SAMPLE_PERIOD, 50, sampler_cb));
+
+    go.release();
+    for (int i = 0; i < 10 && sampled_thread != (uint32_t)worker_tid; i++) {
+        Thread::wait(SAMPLE_PERIOD);
+    }
+    mbed_stats_stack_sampler_stop();
+
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)worker_tid, sampled_thread);
+    TEST_ASSERT(sampled_max >= STACK_SIZE / 2);
+
+    go.release();
+    thread.join();
+}
+
+Case cases[] = {
+    Case("incremental sample matches full scan", test_case_sample_matches_full_scan),
+    Case("background sampler threshold", test_case_sampler_threshold),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    Harness::run(specification);
+}
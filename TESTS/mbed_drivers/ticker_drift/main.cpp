@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2013-2016, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "utest/utest.h"
+#include "unity/unity.h"
+
+using namespace utest::v1;
+
+static const int PERIOD_US = 10000;
+static const int PERIODS_PER_TICK = 100;
+static const int total_ticks = 10;
+
+Ticker *ticker1;
+
+volatile int ticker_count = 0;
+volatile bool print_tick = false;
+
+void send_kv_tick() {
+    if (ticker_count <= total_ticks) {
+        print_tick = true;
+    }
+}
+
+// Callback with a varying latency, which must not accumulate into the period
+void ticker_callback_with_latency(void) {
+    static int period_count = 0;
+    wait_us((period_count * 37) % 3000);
+    if (++period_count >= PERIODS_PER_TICK) {
+        period_count = 0;
+        send_kv_tick();
+    }
+}
+
+void wait_and_print() {
+    while(ticker_count <= total_ticks) {
+        if (print_tick) {
+            print_tick = false;
+            greentea_send_kv("tick", ticker_count++);
+        }
+    }
+}
+
+void test_case_read_us() {
+    us_timestamp_t start = us_ticker_read_us();
+    // The low 32 bits track the hardware counter
+    TEST_ASSERT((uint32_t)(us_ticker_read() - (uint32_t)start) < 1000);
+    wait_ms(10);
+    us_timestamp_t end = us_ticker_read_us();
+    TEST_ASSERT(end > start);
+    TEST_ASSERT(end - start >= 10000);
+    TEST_ASSERT(end - start < 20000);
+}
+
+void test_case_drift_with_latency() {
+    ticker_count = 0;
+    ticker1->attach_us(ticker_callback_with_latency, PERIOD_US);
+    wait_and_print();
+}
+
+utest::v1::status_t one_ticker_case_setup_handler_t(const Case *const source, const size_t index_of_case) {
+  ticker1 = new Ticker();
+  return greentea_case_setup_handler(source, index_of_case);
+}
+
+utest::v1::status_t one_ticker_case_teardown_handler_t(const Case *const source, const size_t passed, const size_t failed, const failure_t reason) {
+  delete ticker1;
+  return greentea_case_teardown_handler(source, passed, failed, reason);
+}
+
+// Test cases
+Case cases[] = {
+    Case("Timers: 64-bit read", test_case_read_us),
+    Case("Timers: ticker drift with callback latency", one_ticker_case_setup_handler_t, test_case_drift_with_latency, one_ticker_case_teardown_handler_t),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP((total_ticks + 5) * 2, "timing_drift_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main() {
+    Harness::run(specification);
+}
@@ -0,0 +1,91 @@
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "rtos.h"
+
+#if defined(MBED_RTOS_SINGLE_THREAD)
+  #error [NOT_SUPPORTED] test not supported
+#endif
+
+typedef struct {
+    uint32_t counter;   /* A counter value */
+} message_t;
+
+#define QUEUE_SIZE       16
+#define BATCH_SIZE       5
+#define BATCH_COUNT      8
+#define QUEUE_PUT_DELAY  50
+
+/*
+ * The stack size is defined in cmsis_os.h mainly dependent on the underlying toolchain and
+ * the C standard library. For GCC, ARM_STD and IAR it is defined with a size of 2048 bytes
+ * and for ARM_MICRO 512. Because of reduce RAM size some targets need a reduced stacksize.
+ */
+#if (defined(TARGET_EFM32HG_STK3400)) && !defined(TOOLCHAIN_ARM_MICRO)
+    #define STACK_SIZE 512
+#elif (defined(TARGET_EFM32LG_STK3600) || defined(TARGET_EFM32WG_STK3800) || defined(TARGET_EFM32PG_STK3401)) && !defined(TOOLCHAIN_ARM_MICRO)
+    #define STACK_SIZE 768
+#elif (defined(TARGET_EFM32GG_STK3700)) && !defined(TOOLCHAIN_ARM_MICRO)
+    #define STACK_SIZE 1536
+#elif defined(TARGET_MCU_NRF51822) || defined(TARGET_MCU_NRF52832)
+    #define STACK_SIZE 768
+#elif defined(TARGET_XDOT_L151CC)
+    #define STACK_SIZE 1024
+#else
+    #define STACK_SIZE DEFAULT_STACK_SIZE
+#endif
+
+Queue<message_t, QUEUE_SIZE> queue;
+Mail<message_t, QUEUE_SIZE> mail_box;
+
+/* Send Thread: produces fixed size batches for both the queue and the mail box */
+void send_thread () {
+    static message_t messages[BATCH_COUNT * BATCH_SIZE];
+    uint32_t i = 0;
+
+    for (int batch = 0; batch < BATCH_COUNT; batch++) {
+        message_t *queued[BATCH_SIZE];
+        message_t *mails[BATCH_SIZE];
+        for (int j = 0; j < BATCH_SIZE; j++, i++) {
+            messages[i].counter = i;
+            queued[j] = &messages[i];
+
+            mails[j] = mail_box.alloc();
+            mails[j]->counter = i;
+        }
+        queue.put_many(queued, BATCH_SIZE, osWaitForever);
+        mail_box.put_many(mails, BATCH_SIZE);
+        Thread::wait(QUEUE_PUT_DELAY);
+    }
+}
+
+int main (void) {
+    GREENTEA_SETUP(20, "default_auto");
+
+    Thread thread(osPriorityNormal, STACK_SIZE);
+    thread.start(send_thread);
+    bool result = true;
+    uint32_t expected_queue = 0;
+    uint32_t expected_mail = 0;
+
+    while (result && (expected_queue < BATCH_COUNT * BATCH_SIZE ||
+                      expected_mail < BATCH_COUNT * BATCH_SIZE)) {
+        message_t *received[QUEUE_SIZE];
+
+        uint32_t count = queue.get_many(received, QUEUE_SIZE, 0);
+        for (uint32_t j = 0; j < count; j++) {
+            result = result && (received[j]->counter == expected_queue++);
+        }
+
+        count = mail_box.get_many(received, QUEUE_SIZE, QUEUE_PUT_DELAY);
+        for (uint32_t j = 0; j < count; j++) {
+            result = result && (received[j]->counter == expected_mail++);
+            mail_box.free(received[j]);
+        }
+        printf("queue %u, mail %u ... [%s]\r\n", expected_queue, expected_mail,
+                                                 result ? "OK" : "FAIL");
+    }
+
+    thread.join();
+    GREENTEA_TESTSUITE_RESULT(result);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+#include "rtos.h"
+
+#if defined(MBED_RTOS_SINGLE_THREAD)
+  #error [NOT_SUPPORTED] test not supported
+#endif
+
+#define POOL_STACK_SIZE 512
+#define POOL_WORKERS    3
+#define POOL_DEPTH      4
+
+using namespace utest::v1;
+
+// Counter shared between the test and the pool workers
+class counter_t {
+public:
+    counter_t(int value) : _value(value) {}
+
+    void increment() {
+        _mutex.lock();
+        _value++;
+        _mutex.unlock();
+    }
+
+    operator int() {
+        _mutex.lock();
+        int value = _value;
+        _mutex.unlock();
+        return value;
+    }
+
+private:
+    Mutex _mutex;
+    int _value;
+};
+
+void increment(counter_t* counter) {
+    counter->increment();
+}
+
+void increment_with_wait(counter_t* counter) {
+    Thread::wait(50);
+    counter->increment();
+}
+
+void test_single_job() {
+    counter_t counter(0);
+    counter_t completed(0);
+    ThreadPool pool(1, 1, osPriorityNormal, POOL_STACK_SIZE);
+    ThreadPool::Job job;
+
+    TEST_ASSERT_EQUAL(osOK, pool.post(&job, callback(increment, &counter),
+                                      callback(increment, &completed)));
+    TEST_ASSERT_EQUAL(osOK, job.wait());
+    TEST_ASSERT_TRUE(job.done());
+    TEST_ASSERT_EQUAL(counter, 1);
+    TEST_ASSERT_EQUAL(completed, 1);
+}
+
+void test_job_reuse() {
+    counter_t counter(0);
+    ThreadPool pool(1, 1, osPriorityNormal, POOL_STACK_SIZE);
+    ThreadPool::Job job;
+
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(osOK, pool.post(&job, callback(increment, &counter)));
+        TEST_ASSERT_EQUAL(osOK, job.wait());
+        TEST_ASSERT_EQUAL(counter, i + 1);
+    }
+}
+
+void test_queue_full() {
+    counter_t counter(0);
+    ThreadPool pool(1, 1, osPriorityNormal, POOL_STACK_SIZE);
+    ThreadPool::Job jobs[3];
+
+    // First job occupies the worker, second fills the queue
+    TEST_ASSERT_EQUAL(osOK, pool.post(&jobs[0], callback(increment_with_wait, &counter)));
+    Thread::wait(10);
+    TEST_ASSERT_EQUAL(osOK, pool.post(&jobs[1], callback(increment_with_wait, &counter)));
+    TEST_ASSERT_EQUAL(osErrorResource, pool.post(&jobs[2], callback(increment, &counter)));
+    TEST_ASSERT_EQUAL(osErrorParameter, pool.post(&jobs[1], callback(increment, &counter)));
+
+    // Waiting for room in the queue succeeds once the worker moves on
+    TEST_ASSERT_EQUAL(osOK, pool.post(&jobs[2], callback(increment, &counter), 0, osWaitForever));
+    jobs[2].wait();
+    TEST_ASSERT_EQUAL(counter, 3);
+}
+
+void test_parallel_jobs() {
+    counter_t counter(0);
+    ThreadPool pool(POOL_WORKERS, POOL_DEPTH, osPriorityNormal, POOL_STACK_SIZE);
+    ThreadPool::Job jobs[POOL_WORKERS + POOL_DEPTH];
+
+    for (int i = 0; i < POOL_WORKERS + POOL_DEPTH; i++) {
+        TEST_ASSERT_EQUAL(osOK, pool.post(&jobs[i], callback(increment_with_wait, &counter),
+                                          0, osWaitForever));
+    }
+    for (int i = 0; i < POOL_WORKERS + POOL_DEPTH; i++) {
+        jobs[i].wait();
+    }
+    TEST_ASSERT_EQUAL(counter, POOL_WORKERS + POOL_DEPTH);
+
+    thread_pool_stats_t stats;
+    pool.get_stats(&stats);
+    TEST_ASSERT_EQUAL(POOL_WORKERS, stats.workers);
+    TEST_ASSERT_EQUAL(0, stats.queue_depth);
+    TEST_ASSERT_EQUAL(POOL_WORKERS + POOL_DEPTH, stats.jobs_completed);
+    TEST_ASSERT(stats.max_queue_depth <= POOL_DEPTH);
+    TEST_ASSERT(stats.busy_time_us >= 50000 * (POOL_WORKERS + POOL_DEPTH));
+}
+
+void test_shutdown_drains_queue() {
+    counter_t counter(0);
+    ThreadPool::Job jobs[POOL_DEPTH];
+    {
+        ThreadPool pool(1, POOL_DEPTH, osPriorityNormal, POOL_STACK_SIZE);
+        for (int i = 0; i < POOL_DEPTH; i++) {
+            TEST_ASSERT_EQUAL(osOK, pool.post(&jobs[i], callback(increment_with_wait, &counter)));
+        }
+    }
+    TEST_ASSERT_EQUAL(counter, POOL_DEPTH);
+}
+
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(40, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+// Test cases
+Case cases[] = {
+    Case("Testing single job", test_single_job),
+    Case("Testing job reuse", test_job_reuse),
+    Case("Testing full queue", test_queue_full),
+    Case("Testing parallel jobs", test_parallel_jobs),
+    Case("Testing shutdown drains queue", test_shutdown_drains_queue),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
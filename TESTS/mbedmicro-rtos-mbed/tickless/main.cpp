@@ -0,0 +1,87 @@
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+#include "rtos.h"
+
+#if defined(MBED_RTOS_SINGLE_THREAD)
+  #error [NOT_SUPPORTED] test not supported
+#endif
+
+#if !MBED_CONF_RTOS_TICKLESS_IDLE || !DEVICE_LOWPOWERTIMER || !defined(__MBED_CMSIS_RTOS_CM)
+  #error [NOT_SUPPORTED] Tickless idle not enabled for this target
+#endif
+
+using namespace utest::v1;
+
+// Kernel tick period in microseconds, defined by RTX_CM_lib.h
+extern "C" uint32_t const os_clockrate;
+
+// Kernel time may trail or lead a Timer by a couple of ticks, plus the
+// difference between the low power and the microsecond clocks
+#define KERNEL_DRIFT_TICKS 2
+#define KERNEL_DRIFT_PERCENT 1
+
+static void assert_kernel_time(uint32_t kernel_start, Timer &timer) {
+    uint32_t kernel_ms = (uint64_t)(osKernelSysTick() - kernel_start) * 1000
+            / osKernelSysTickFrequency;
+    int timer_ms = timer.read_ms();
+    int delta = KERNEL_DRIFT_TICKS * os_clockrate / 1000
+            + timer_ms * KERNEL_DRIFT_PERCENT / 100;
+    TEST_ASSERT_INT_WITHIN(delta, timer_ms, kernel_ms);
+}
+
+// Waits of several ticks are slept through in one tickless period
+void test_wait_periods() {
+    const uint32_t waits[] = {10, 25, 100, 333, 1000};
+    for (unsigned i = 0; i < sizeof(waits)/sizeof(waits[0]); i++) {
+        Timer timer;
+        uint32_t kernel_start = osKernelSysTick();
+        timer.start();
+        Thread::wait(waits[i]);
+        timer.stop();
+        assert_kernel_time(kernel_start, timer);
+    }
+}
+
+static volatile uint32_t interrupts;
+
+static void count_interrupt() {
+    interrupts++;
+}
+
+// A Ticker between kernel ticks ends each tickless period part way
+// through a tick, the remainders add up instead of being lost
+void test_partial_ticks() {
+    Ticker ticker;
+    ticker.attach_us(count_interrupt, os_clockrate * 5 / 2);
+
+    Timer timer;
+    uint32_t kernel_start = osKernelSysTick();
+    timer.start();
+    for (int i = 0; i < 20; i++) {
+        Thread::wait(97);
+    }
+    timer.stop();
+    ticker.detach();
+
+    TEST_ASSERT(interrupts > 0);
+    assert_kernel_time(kernel_start, timer);
+}
+
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+// Test cases
+Case cases[] = {
+    Case("Kernel time across tickless waits", test_wait_periods),
+    Case("Kernel time across partial ticks", test_partial_ticks),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
@@ -2,9 +2,14 @@
 #include "greentea-client/test_env.h"
 #include "unity.h"
 #include "utest.h"
+#include "mbed_ipstring.h"
+#include <stdlib.h>
 
 using namespace utest::v1;
 
+#define FUZZ_ITERATIONS     20000
+#define BENCHMARK_ROUNDS    10000
+
 
 // IP parsing verification
 void test_ip_accept(const char *string, nsapi_addr_t addr) {
@@ -13,8 +18,7 @@ void test_ip_accept(const char *string, nsapi_addr_t addr) {
     TEST_ASSERT(address == SocketAddress(addr));
 }
 
-template <const char *string>
-void test_ip_reject() {
+void test_ip_reject(const char *string) {
     SocketAddress address;
     TEST_ASSERT(!address.set_ip_address(string));
     TEST_ASSERT(!address);
@@ -31,6 +35,18 @@ void name() {                                       \
     test_ip_reject(string);                         \
 }
 
+// IP formatting verification
+void test_ip_format(nsapi_addr_t addr, const char *string) {
+    SocketAddress address(addr);
+    TEST_ASSERT_EQUAL_STRING(string, address.get_ip_address());
+}
+
+#define TEST_IP_FORMAT(name, string, ...)           \
+void name() {                                       \
+    nsapi_addr_t addr = __VA_ARGS__;                \
+    test_ip_format(addr, string);                   \
+}
+
 
 // Test cases
 TEST_IP_ACCEPT(test_simple_ipv4_address,
@@ -66,11 +82,155 @@ TEST_IP_ACCEPT(test_null_ipv6_address,
     "::",
     {NSAPI_IPv6,{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
                  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}})
+TEST_IP_ACCEPT(test_upper_case_ipv6_address,
+    "ABCD:EF01::2345",
+    {NSAPI_IPv6,{0xab,0xcd,0xef,0x01,0x00,0x00,0x00,0x00,
+                 0x00,0x00,0x00,0x00,0x00,0x00,0x23,0x45}})
+TEST_IP_ACCEPT(test_single_group_gap_ipv6_address,
+    "1:2:3:4::6:7:8",
+    {NSAPI_IPv6,{0x00,0x01,0x00,0x02,0x00,0x03,0x00,0x04,
+                 0x00,0x00,0x00,0x06,0x00,0x07,0x00,0x08}})
+TEST_IP_ACCEPT(test_mapped_ipv6_address,
+    "::ffff:192.168.1.2",
+    {NSAPI_IPv6,{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+                 0x00,0x00,0xff,0xff,0xc0,0xa8,0x01,0x02}})
+
+TEST_IP_REJECT(test_empty_address, "")
+TEST_IP_REJECT(test_short_ipv4_address, "1.2.3")
+TEST_IP_REJECT(test_long_ipv4_address, "1.2.3.4.5")
+TEST_IP_REJECT(test_overflow_ipv4_address, "256.0.0.1")
+TEST_IP_REJECT(test_trailing_dot_ipv4_address, "1.2.3.4.")
+TEST_IP_REJECT(test_leading_zero_ipv4_address, "010.1.1.1")
+TEST_IP_REJECT(test_zero_padded_ipv4_address, "1.2.3.00")
+TEST_IP_REJECT(test_hostname_address, "example.com")
+TEST_IP_REJECT(test_double_gap_ipv6_address, "1::2::3")
+TEST_IP_REJECT(test_long_group_ipv6_address, "12345::")
+TEST_IP_REJECT(test_long_ipv6_address, "1:2:3:4:5:6:7:8:9")
+TEST_IP_REJECT(test_redundant_gap_ipv6_address, "1:2:3:4:5:6:7:8::")
+TEST_IP_REJECT(test_trailing_colon_ipv6_address, "1:2:3:4:5:6:7:")
+TEST_IP_REJECT(test_zone_ipv6_address, "fe80::1%1")
+
+TEST_IP_FORMAT(test_format_ipv4_address,
+    "192.168.10.1",
+    {NSAPI_IPv4,{192,168,10,1}})
+TEST_IP_FORMAT(test_format_simple_ipv6_address,
+    "2001:db8::1",
+    {NSAPI_IPv6,{0x20,0x01,0x0d,0xb8,0x00,0x00,0x00,0x00,
+                 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01}})
+TEST_IP_FORMAT(test_format_null_ipv6_address,
+    "::",
+    {NSAPI_IPv6,{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+                 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}})
+TEST_IP_FORMAT(test_format_single_zero_ipv6_address,
+    "2001:db8:0:1:1:1:1:1",
+    {NSAPI_IPv6,{0x20,0x01,0x0d,0xb8,0x00,0x00,0x00,0x01,
+                 0x00,0x01,0x00,0x01,0x00,0x01,0x00,0x01}})
+TEST_IP_FORMAT(test_format_longest_run_ipv6_address,
+    "2001:0:0:1::1",
+    {NSAPI_IPv6,{0x20,0x01,0x00,0x00,0x00,0x00,0x00,0x01,
+                 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01}})
+TEST_IP_FORMAT(test_format_first_run_ipv6_address,
+    "2001:db8::1:0:0:1",
+    {NSAPI_IPv6,{0x20,0x01,0x0d,0xb8,0x00,0x00,0x00,0x00,
+                 0x00,0x01,0x00,0x00,0x00,0x00,0x00,0x01}})
+TEST_IP_FORMAT(test_format_full_ipv6_address,
+    "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff",
+    {NSAPI_IPv6,{0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+                 0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff}})
+
+
+// Formatting random addresses must always parse back to the same bytes,
+// and parsing random strings must never overrun or accept garbage silently
+void test_fuzz_round_trip() {
+    srand(0x69707374);
+
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        uint8_t bytes[NSAPI_IPv6_BYTES];
+        uint8_t parsed[NSAPI_IPv6_BYTES];
+        char string[MBED_IPV6_STRING_SIZE];
+
+        // Bias towards zero groups so compression is exercised
+        for (int j = 0; j < NSAPI_IPv6_BYTES; j++) {
+            bytes[j] = (rand() % 2) ? 0 : rand();
+        }
+
+        size_t len = mbed_ipv6_to_string(bytes, string);
+        TEST_ASSERT_EQUAL(strlen(string), len);
+        TEST_ASSERT(mbed_ipv6_from_string(string, len, parsed));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, parsed, NSAPI_IPv6_BYTES);
+
+        len = mbed_ipv4_to_string(bytes, string);
+        TEST_ASSERT_EQUAL(strlen(string), len);
+        TEST_ASSERT(mbed_ipv4_from_string(string, len, parsed));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(bytes, parsed, NSAPI_IPv4_BYTES);
+    }
+}
+
+void test_fuzz_random_strings() {
+    static const char alphabet[] = "0123456789abcdefABCDEF:.%/ g";
+    srand(0x72616e64);
+
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        char string[48];
+        size_t len = rand() % (sizeof(string) - 1);
+        for (size_t j = 0; j < len; j++) {
+            string[j] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+        string[len] = '\0';
+
+        // Accepted strings must format back to an equivalent address
+        SocketAddress address;
+        if (address.set_ip_address(string)) {
+            SocketAddress reformatted;
+            TEST_ASSERT(reformatted.set_ip_address(address.get_ip_address()));
+            TEST_ASSERT(address == reformatted);
+        } else {
+            TEST_ASSERT_EQUAL(NSAPI_UNSPEC, address.get_ip_version());
+        }
+    }
+}
+
+void test_benchmark() {
+    static const char *const strings[] = {
+        "192.168.100.200",
+        "2001:db8::1",
+        "fe80::1234:5678:9abc:def0",
+        "2001:db8:aaaa:bbbb:cccc:dddd:eeee:ffff",
+    };
+
+    Timer timer;
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+        SocketAddress address;
+        volatile int sink = 0;
+
+        timer.reset();
+        timer.start();
+        for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+            sink += address.set_ip_address(strings[i]);
+        }
+        timer.stop();
+        int parse_us = timer.read_us();
+
+        timer.reset();
+        timer.start();
+        for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+            // Setting the bytes drops the cached string
+            address.set_addr(address.get_addr());
+            sink += address.get_ip_address()[0];
+        }
+        timer.stop();
+        int format_us = timer.read_us();
+
+        printf("%-40s parse %5dns, format %5dns\r\n", strings[i],
+                parse_us * 1000 / BENCHMARK_ROUNDS,
+                format_us * 1000 / BENCHMARK_ROUNDS);
+    }
+}
 
 
 // Test setup
 utest::v1::status_t test_setup(const size_t number_of_cases) {
-    GREENTEA_SETUP(10, "default_auto");
+    GREENTEA_SETUP(60, "default_auto");
     return verbose_test_setup_handler(number_of_cases);
 }
 
@@ -85,6 +245,36 @@ Case cases[] = {
     Case("Right-weighted IPv6 address", test_right_weighted_ipv6_address),
     Case("Hollowed IPv6 address", test_hollowed_ipv6_address),
     Case("Null IPv6 address", test_null_ipv6_address),
+    Case("Upper case IPv6 address", test_upper_case_ipv6_address),
+    Case("Single group gap IPv6 address", test_single_group_gap_ipv6_address),
+    Case("IPv4-mapped IPv6 address", test_mapped_ipv6_address),
+
+    Case("Reject empty address", test_empty_address),
+    Case("Reject short IPv4 address", test_short_ipv4_address),
+    Case("Reject long IPv4 address", test_long_ipv4_address),
+    Case("Reject overflowing IPv4 address", test_overflow_ipv4_address),
+    Case("Reject trailing dot IPv4 address", test_trailing_dot_ipv4_address),
+    Case("Reject leading zero IPv4 address", test_leading_zero_ipv4_address),
+    Case("Reject zero padded IPv4 address", test_zero_padded_ipv4_address),
+    Case("Reject hostname", test_hostname_address),
+    Case("Reject double gap IPv6 address", test_double_gap_ipv6_address),
+    Case("Reject long group IPv6 address", test_long_group_ipv6_address),
+    Case("Reject long IPv6 address", test_long_ipv6_address),
+    Case("Reject redundant gap IPv6 address", test_redundant_gap_ipv6_address),
+    Case("Reject trailing colon IPv6 address", test_trailing_colon_ipv6_address),
+    Case("Reject zoned IPv6 address", test_zone_ipv6_address),
+
+    Case("Format IPv4 address", test_format_ipv4_address),
+    Case("Format simple IPv6 address", test_format_simple_ipv6_address),
+    Case("Format null IPv6 address", test_format_null_ipv6_address),
+    Case("Format single zero IPv6 address", test_format_single_zero_ipv6_address),
+    Case("Format longest run IPv6 address", test_format_longest_run_ipv6_address),
+    Case("Format first run IPv6 address", test_format_first_run_ipv6_address),
+    Case("Format full IPv6 address", test_format_full_ipv6_address),
+
+    Case("Fuzz format round trip", test_fuzz_round_trip),
+    Case("Fuzz random strings", test_fuzz_random_strings),
+    Case("Benchmark", test_benchmark),
 };
 
 Specification specification(test_setup, cases);
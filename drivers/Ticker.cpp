@@ -29,16 +29,40 @@ void Ticker::detach() {
     core_util_critical_section_exit();
 }
 
-void Ticker::setup(timestamp_t t) {
+// Longest single wait on the 32-bit ticker queue. Keeping it well below the
+// counter wrap also keeps the 64-bit timebase up to date.
+#define TICKER_MAX_DELTA (1UL << 30)
+
+void Ticker::setup(us_timestamp_t t) {
     core_util_critical_section_enter();
     remove();
     _delay = t;
-    insert(_delay + ticker_read(_ticker_data));
+    _epoch = ticker_read_us(_ticker_data);
+    _periods = 1;
+    schedule(_epoch);
     core_util_critical_section_exit();
 }
 
+void Ticker::schedule(us_timestamp_t now) {
+    // Deadlines are derived from the epoch so callback latency never accumulates
+    us_timestamp_t deadline = _epoch + _periods * _delay;
+    us_timestamp_t delta = (deadline > now) ? deadline - now : 0;
+    if (delta > TICKER_MAX_DELTA) {
+        delta = TICKER_MAX_DELTA;
+    }
+    // The low 32 bits of the 64-bit time are the ticker timestamp
+    insert((timestamp_t)(now + delta));
+}
+
 void Ticker::handler() {
-    insert(event.timestamp + _delay);
+    us_timestamp_t now = ticker_read_us(_ticker_data);
+    if (now < _epoch + _periods * _delay) {
+        // Intermediate wake-up on the way to a distant deadline
+        schedule(now);
+        return;
+    }
+    _periods++;
+    schedule(now);
     _function.call();
 }
 
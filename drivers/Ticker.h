@@ -75,7 +75,8 @@ public:
      *  @param t the time between calls in seconds
      */
     void attach(Callback<void()> func, float t) {
-        attach_us(func, t * 1000000.0f);
+        _function.attach(func);
+        setup((us_timestamp_t)(t * 1000000.0f));
     }
 
     /** Attach a member function to be called by the Ticker, specifiying the interval in seconds
@@ -131,11 +132,14 @@ public:
     void detach();
 
 protected:
-    void setup(timestamp_t t);
+    void setup(us_timestamp_t t);
+    void schedule(us_timestamp_t now);
     virtual void handler();
 
 protected:
-    timestamp_t         _delay;     /**< Time delay (in microseconds) for re-setting the multi-shot callback. */
+    us_timestamp_t      _delay;     /**< Time delay (in microseconds) for re-setting the multi-shot callback. */
+    us_timestamp_t      _epoch;     /**< 64-bit time the callback was attached at. */
+    us_timestamp_t      _periods;   /**< Number of periods elapsed since _epoch. */
     Callback<void()>    _function;  /**< Callback. */
 };
 
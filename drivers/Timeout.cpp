@@ -18,6 +18,12 @@
 namespace mbed {
 
 void Timeout::handler() {
+    us_timestamp_t now = ticker_read_us(_ticker_data);
+    if (now < _epoch + _periods * _delay) {
+        // Intermediate wake-up on the way to a distant deadline
+        schedule(now);
+        return;
+    }
     _function.call();
 }
 
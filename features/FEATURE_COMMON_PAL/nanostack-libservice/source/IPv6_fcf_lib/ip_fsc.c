@@ -15,6 +15,9 @@
  */
 #include "stdint.h"
 #include "ip_fsc.h"
+#ifdef __MBED__
+#include "mbed_checksum.h"
+#endif
 
 /** \brief Compute IP checksum for arbitary data
  *
@@ -26,6 +29,34 @@
  * alignments. The one limitation is that the 32-bit accumulator limits
  * it to basically 64K of total data.
  */
+#ifdef __MBED__
+uint16_t ip_fcf_v(uint_fast8_t count, const ns_iovec_t vec[static count])
+{
+    // Sum each buffer with the platform checksum. Sums are in memory order,
+    // and a buffer starting at an odd offset contributes its sum swapped.
+    uint_fast32_t acc32 = 0;
+    bool odd = false;
+    while (count) {
+        uint16_t sum16 = mbed_checksum(vec->iov_base, vec->iov_len);
+        if (odd) {
+            sum16 = (uint16_t)((sum16 << 8) | (sum16 >> 8));
+        }
+        acc32 += sum16;
+        if (vec->iov_len & 1) {
+            odd = !odd;
+        }
+        vec++;
+        count--;
+    }
+
+    acc32 = (acc32 >> 16) + (acc32 & 0xffff);
+    uint16_t sum16 = (uint16_t)((acc32 >> 16) + (acc32 & 0xffff));
+
+    // Convert from memory order to a host value
+    const uint8_t *sum_bytes = (const uint8_t *) &sum16;
+    return ~((uint16_t) sum_bytes[0] << 8 | sum_bytes[1]);
+}
+#else
 uint16_t ip_fcf_v(uint_fast8_t count, const ns_iovec_t vec[static count])
 {
     uint_fast32_t acc32 = 0;
@@ -58,6 +89,7 @@ uint16_t ip_fcf_v(uint_fast8_t count, const ns_iovec_t vec[static count])
     uint16_t sum16 = (uint16_t)((acc32 >> 16) + (acc32 & 0xffff));
     return ~sum16;
 }
+#endif
 
 /** \brief Compute IPv6 checksum
  *
@@ -17,6 +17,9 @@
 #include <string.h>
 #include "common_functions.h"
 #include "ip6string.h"
+#ifdef __MBED__
+#include "mbed_ipstring.h"
+#endif
 
 /**
  * Print binary IPv6 address to a string.
@@ -25,6 +28,13 @@
  * \param addr IPv6 address.
  * \p buffer to write string to.
  */
+#ifdef __MBED__
+uint_fast8_t ip6tos(const void *ip6addr, char *p)
+{
+    // Shared with SocketAddress, produces the same RFC 5952 output
+    return mbed_ipv6_to_string(ip6addr, p);
+}
+#else
 uint_fast8_t ip6tos(const void *ip6addr, char *p)
 {
     char *p_orig = p;
@@ -98,6 +108,7 @@ uint_fast8_t ip6tos(const void *ip6addr, char *p)
     // Return length of generated string, excluding the terminating null character
     return p - p_orig;
 }
+#endif
 
 uint_fast8_t ip6_prefix_tos(const void *prefix, uint_fast8_t prefix_len, char *p)
 {
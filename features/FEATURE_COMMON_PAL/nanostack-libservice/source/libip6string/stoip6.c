@@ -16,10 +16,16 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <ctype.h>
 #include "common_functions.h"
 #include "ip6string.h"
+#ifdef __MBED__
+#include "mbed_ipstring.h"
+#endif
 
+#ifndef __MBED__
 static uint16_t hex(const char *p);
+#endif
 
 /**
  * Convert numeric IPv6 address string to a binary.
@@ -28,6 +34,24 @@ static uint16_t hex(const char *p);
  * \param len Length of ipv6 string.
  * \param dest buffer for address. MUST be 16 bytes.
  */
+#ifdef __MBED__
+void stoip6(const char *ip6addr, size_t len, void *dest)
+{
+    // Callers may pass strings with trailing text such as a prefix length,
+    // so only the leading address characters are parsed
+    size_t addr_len = 0;
+    while (addr_len < len && ip6addr[addr_len] &&
+            (isxdigit((unsigned char) ip6addr[addr_len]) ||
+             ip6addr[addr_len] == ':' || ip6addr[addr_len] == '.')) {
+        addr_len++;
+    }
+
+    // Malformed addresses give the unspecified address
+    if (!mbed_ipv6_from_string(ip6addr, addr_len, dest)) {
+        memset(dest, 0, 16);
+    }
+}
+#else
 void stoip6(const char *ip6addr, size_t len, void *dest)
 {
     uint8_t *addr;
@@ -70,6 +94,7 @@ void stoip6(const char *ip6addr, size_t len, void *dest)
         memset(addr, 0, 16 - field_no * 2);
     }
 }
+#endif
 unsigned char  sipv6_prefixlength(const char *ip6addr)
 {
     char *ptr = strchr(ip6addr, '/');
@@ -78,6 +103,7 @@ unsigned char  sipv6_prefixlength(const char *ip6addr)
     }
     return 0;
 }
+#ifndef __MBED__
 static uint16_t hex(const char *p)
 {
     uint16_t val = 0;
@@ -96,3 +122,4 @@ static uint16_t hex(const char *p)
     }
     return val;
 }
+#endif
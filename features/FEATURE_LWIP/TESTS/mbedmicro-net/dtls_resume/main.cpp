@@ -0,0 +1,111 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+#if !DEVICE_TRNG
+    #error [NOT_SUPPORTED] DTLS needs an entropy source
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "DTLSSocket.h"
+#include "mbedtls/certs.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_DTLS_RESUME_CONNECTIONS
+#define MBED_CFG_DTLS_RESUME_CONNECTIONS 4
+#endif
+
+namespace {
+    // ssl_server2 answers any request with a short HTML page
+    const char request[] = "GET / HTTP/1.0\r\n\r\n";
+    const char response[] = "HTTP/1.0 200 OK";
+    char rx_buffer[512] = {0};
+}
+
+// Requests a page and checks the start of the answer
+bool dtls_request(DTLSSocket *sock, NetworkInterface *net, const SocketAddress &addr) {
+    TEST_ASSERT_EQUAL(0, sock->open(net));
+    sock->set_timeout(10000);
+
+    int err = sock->connect(addr);
+    if (err) {
+        printf("MBED: DTLS connect failed: %d\r\n", err);
+        sock->close();
+        return false;
+    }
+
+    if (sock->sendto(addr, request, sizeof(request) - 1) != sizeof(request) - 1) {
+        sock->close();
+        return false;
+    }
+
+    SocketAddress from;
+    int ret = sock->recvfrom(&from, rx_buffer, sizeof(rx_buffer) - 1);
+    sock->close();
+    if (ret <= 0 || from != addr) {
+        return false;
+    }
+
+    rx_buffer[ret] = '\0';
+    return strncmp(rx_buffer, response, sizeof(response) - 1) == 0;
+}
+
+int main() {
+    GREENTEA_SETUP(120, "dtls_server");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("MBED: DTLSClient IP address is '%s'\n", eth.get_ip_address());
+    printf("MBED: DTLSClient waiting for server IP and port...\n");
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress dtls_addr(ipbuf, port);
+
+    bool result = true;
+    nsapi_dtls_stats_t stats;
+
+    // The test server certificate is issued to localhost
+    DTLSSocket sock;
+    TEST_ASSERT_EQUAL(0, sock.set_root_ca_cert(mbedtls_test_cas_pem));
+    TEST_ASSERT_EQUAL(0, sock.set_hostname("localhost"));
+
+    for (int i = 0; i < MBED_CFG_DTLS_RESUME_CONNECTIONS; i++) {
+        if (!dtls_request(&sock, &eth, dtls_addr)) {
+            result = false;
+            break;
+        }
+
+        // Only the first connection needs a full handshake
+        sock.get_stats(&stats);
+        printf("MBED: connection %d: %u handshakes, %u resumed\r\n",
+                i, stats.handshakes, stats.resumed);
+        if (stats.handshakes != (unsigned)i + 1 || stats.resumed != (unsigned)i) {
+            result = false;
+        }
+    }
+
+    sock.get_stats(&stats);
+    printf("MBED: %u failures, %u datagrams dropped\r\n", stats.failures, stats.dropped);
+    result = result && stats.failures == 0 && stats.peers == 0;
+
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
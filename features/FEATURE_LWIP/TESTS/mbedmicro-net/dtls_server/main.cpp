@@ -0,0 +1,105 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+#if !DEVICE_TRNG
+    #error [NOT_SUPPORTED] DTLS needs an entropy source
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "DTLSSocket.h"
+#include "mbedtls/certs.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_DTLS_SERVER_PORT
+#define MBED_CFG_DTLS_SERVER_PORT 4433
+#endif
+
+#ifndef MBED_CFG_DTLS_SERVER_TIMEOUT
+#define MBED_CFG_DTLS_SERVER_TIMEOUT 60000
+#endif
+
+namespace {
+    // ssl_client2 prints whatever it gets back
+    const char response[] = "HTTP/1.0 200 OK\r\n\r\n";
+    char rx_buffer[512] = {0};
+    const int PEER_MAX = MBED_CONF_NSAPI_DTLS_PEER_MAX;
+}
+
+void print_stats(const nsapi_dtls_stats_t &stats) {
+    printf("MBED: peers %u, hello verify %u, handshakes %u, resumed %u, failures %u\r\n",
+            stats.peers, stats.hello_verify, stats.handshakes, stats.resumed, stats.failures);
+    printf("MBED: closed %u, evicted %u, dropped %u\r\n",
+            stats.closed, stats.evicted, stats.dropped);
+}
+
+// Two ssl_client2 runs each resume on reconnecting, by session ID and
+// by session ticket, and the raw clients overflow the peer table
+bool host_done(const nsapi_dtls_stats_t &stats) {
+    return stats.resumed >= 2 && stats.evicted >= 1 &&
+           stats.peers == (unsigned)PEER_MAX;
+}
+
+int main() {
+    GREENTEA_SETUP(120, "dtls_client");
+
+    EthernetInterface eth;
+    int err = eth.connect();
+    TEST_ASSERT_EQUAL(0, err);
+
+    printf("MBED: DTLSServer IP address is '%s'\n", eth.get_ip_address());
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    // The test server certificate is issued to localhost
+    DTLSSocket sock;
+    TEST_ASSERT_EQUAL(0, sock.open(&eth));
+    TEST_ASSERT_EQUAL(0, sock.set_own_cert_key(
+            mbedtls_test_srv_crt, mbedtls_test_srv_crt_len,
+            mbedtls_test_srv_key, mbedtls_test_srv_key_len));
+    TEST_ASSERT_EQUAL(0, sock.bind(MBED_CFG_DTLS_SERVER_PORT));
+    sock.set_timeout(1000);
+
+    char port_buffer[32];
+    snprintf(port_buffer, sizeof(port_buffer), "%d,%d",
+            MBED_CFG_DTLS_SERVER_PORT, PEER_MAX);
+    greentea_send_kv("server_port", port_buffer);
+
+    // Serve until the host has run its clients
+    nsapi_dtls_stats_t stats;
+    Timer timer;
+    timer.start();
+    while (timer.read_ms() < MBED_CFG_DTLS_SERVER_TIMEOUT) {
+        SocketAddress addr;
+        int ret = sock.recvfrom(&addr, rx_buffer, sizeof(rx_buffer));
+        if (ret > 0) {
+            printf("MBED: %d bytes from %s:%d\r\n", ret,
+                    addr.get_ip_address(), addr.get_port());
+            sock.sendto(addr, response, sizeof(response) - 1);
+        } else if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            printf("MBED: recvfrom failed: %d\r\n", ret);
+        }
+
+        sock.get_stats(&stats);
+        if (host_done(stats)) {
+            break;
+        }
+    }
+
+    print_stats(stats);
+    bool result = host_done(stats);
+    TEST_ASSERT(stats.handshakes >= 4);
+    TEST_ASSERT(stats.hello_verify >= (unsigned)PEER_MAX + 1);
+
+    char recv_key[] = "host_result";
+    char result_buffer[16] = {0};
+    greentea_parse_kv(recv_key, result_buffer, sizeof(recv_key), sizeof(result_buffer));
+    result = result && strcmp(result_buffer, "pass") == 0;
+
+    sock.close();
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
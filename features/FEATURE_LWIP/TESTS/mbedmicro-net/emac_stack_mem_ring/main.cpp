@@ -0,0 +1,271 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if !DEVICE_EMAC
+    #error [NOT_SUPPORTED] Emac not supported for this target
+#endif
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+
+#include "emac_stack_mem.h"
+#include "lwip/sys.h"
+#include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#if defined(LWIP_PLATFORM_POSIX)
+#include "posix_emac.h"
+#endif
+
+using namespace utest::v1;
+
+
+#ifndef MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE
+#define MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE 1518
+#endif
+
+#ifndef MBED_CFG_EMAC_STACK_MEM_RING_ALIGN
+#define MBED_CFG_EMAC_STACK_MEM_RING_ALIGN 32
+#endif
+
+static void get_stats(emac_stack_mem_ring_t *ring, emac_stack_mem_ring_stats_t *stats) {
+    emac_stack_mem_ring_get_stats(NULL, ring, stats);
+}
+
+// Buffers are aligned, full size, and counted as they are taken and returned
+void test_ring_take() {
+    const uint32_t count = 4;
+    emac_stack_mem_ring_t *ring = emac_stack_mem_ring_create(NULL, count,
+            MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE, MBED_CFG_EMAC_STACK_MEM_RING_ALIGN);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    emac_stack_mem_ring_stats_t stats;
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(count, stats.count);
+    TEST_ASSERT_EQUAL(count, stats.available);
+    TEST_ASSERT_EQUAL(count, stats.low_water);
+
+    emac_stack_mem_t *mem[count];
+    for (uint32_t i = 0; i < count; i++) {
+        mem[i] = emac_stack_mem_ring_take(NULL, ring);
+        TEST_ASSERT_NOT_NULL(mem[i]);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)emac_stack_mem_ptr(NULL, mem[i])
+                % MBED_CFG_EMAC_STACK_MEM_RING_ALIGN);
+        TEST_ASSERT_EQUAL(MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE,
+                emac_stack_mem_len(NULL, mem[i]));
+
+        get_stats(ring, &stats);
+        TEST_ASSERT_EQUAL(count - i - 1, stats.available);
+        TEST_ASSERT_EQUAL(count - i - 1, stats.low_water);
+    }
+
+    // Exhausted, the take fails and is counted
+    TEST_ASSERT_NULL(emac_stack_mem_ring_take(NULL, ring));
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(0, stats.available);
+    TEST_ASSERT_EQUAL(count, stats.taken);
+    TEST_ASSERT_EQUAL(1, stats.starved);
+
+    // Returned buffers are available again, the low water mark stays
+    for (uint32_t i = 0; i < count; i++) {
+        emac_stack_mem_free(NULL, mem[i]);
+    }
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(count, stats.available);
+    TEST_ASSERT_EQUAL(0, stats.low_water);
+
+    emac_stack_mem_ring_destroy(NULL, ring);
+
+    TEST_ASSERT_NULL(emac_stack_mem_ring_create(NULL, 0, 64, 0));
+    TEST_ASSERT_NULL(emac_stack_mem_ring_create(NULL, count, 0x10000, 0));
+}
+
+// Frames freed by the stack return their buffers through the custom pbuf
+void test_ring_pbuf_free() {
+    const uint32_t count = 3;
+    emac_stack_mem_ring_t *ring = emac_stack_mem_ring_create(NULL, count,
+            MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE, 0);
+    TEST_ASSERT_NOT_NULL(ring);
+
+    emac_stack_mem_t *mem[count];
+    for (uint32_t i = 0; i < count; i++) {
+        mem[i] = emac_stack_mem_ring_take(NULL, ring);
+        TEST_ASSERT_NOT_NULL(mem[i]);
+    }
+
+    // Received frame, as the stack sees it
+    struct pbuf *p = (struct pbuf *)mem[0];
+    emac_stack_mem_set_len(NULL, mem[0], 60);
+    TEST_ASSERT_EQUAL(60, p->tot_len);
+    TEST_ASSERT_EQUAL(0, pbuf_header(p, -14));
+    // The payload cannot grow into the neighbouring buffer
+    TEST_ASSERT_NOT_EQUAL(0, pbuf_header(p, 20));
+
+    // The buffer returns with the last reference
+    emac_stack_mem_ring_stats_t stats;
+    pbuf_ref(p);
+    pbuf_free(p);
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(0, stats.available);
+    pbuf_free(p);
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(1, stats.available);
+
+    // Chained buffers return together
+    pbuf_cat((struct pbuf *)mem[1], (struct pbuf *)mem[2]);
+    pbuf_free((struct pbuf *)mem[1]);
+    get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL(count, stats.available);
+
+    // A reused buffer starts over
+    p = (struct pbuf *)emac_stack_mem_ring_take(NULL, ring);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL(MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE, p->tot_len);
+    TEST_ASSERT_EQUAL(1, p->ref);
+    TEST_ASSERT_NULL(p->next);
+
+    // Destroyed while the stack holds a frame, released when it is freed
+    emac_stack_mem_ring_destroy(NULL, ring);
+    pbuf_free(p);
+}
+
+#if !defined(LWIP_PLATFORM_POSIX)
+static emac_stack_mem_ring_t *isr_ring;
+static emac_stack_mem_t *volatile isr_mem;
+static emac_stack_mem_ring_stats_t isr_stats;
+
+static void isr_take() {
+    isr_mem = emac_stack_mem_ring_take(NULL, isr_ring);
+    emac_stack_mem_ring_get_stats(NULL, isr_ring, &isr_stats);
+}
+
+// Receive interrupts refill their descriptors from the ring
+void test_ring_take_from_isr() {
+    isr_ring = emac_stack_mem_ring_create(NULL, 2,
+            MBED_CFG_EMAC_STACK_MEM_RING_BUFFER_SIZE, 0);
+    TEST_ASSERT_NOT_NULL(isr_ring);
+
+    Timeout timeout;
+    timeout.attach_us(isr_take, 1000);
+    wait_ms(10);
+
+    TEST_ASSERT_NOT_NULL(isr_mem);
+    TEST_ASSERT_EQUAL(1, isr_stats.available);
+    TEST_ASSERT_EQUAL(1, isr_stats.taken);
+
+    emac_stack_mem_free(NULL, isr_mem);
+    emac_stack_mem_ring_stats_t stats;
+    get_stats(isr_ring, &stats);
+    TEST_ASSERT_EQUAL(2, stats.available);
+
+    emac_stack_mem_ring_destroy(NULL, isr_ring);
+}
+#endif
+
+#if defined(LWIP_PLATFORM_POSIX)
+#define HOST_FRAMES_MAX 64
+
+static emac_stack_mem_t *held[HOST_FRAMES_MAX];
+static volatile int held_count;
+
+// Stands in for a stack that has not processed its frames yet
+static void hold_frame(void *data, emac_stack_mem_chain_t *buf) {
+    held[held_count++] = (emac_stack_mem_t *)buf;
+}
+
+static void release_frames() {
+    for (int i = 0; i < held_count; i++) {
+        emac_stack_mem_free(NULL, held[i]);
+    }
+    held_count = 0;
+}
+
+static void send_frames(emac_interface_t *emac, int count) {
+    emac_stack_mem_t *mem = emac_stack_mem_alloc(NULL, 60, 0);
+    TEST_ASSERT_NOT_NULL(mem);
+    memset(emac_stack_mem_ptr(NULL, mem), 0xff, 60);
+
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT(emac->ops.link_out(emac, mem));
+    }
+
+    emac_stack_mem_free(NULL, mem);
+}
+
+static void wait_frames(emac_interface_t *emac, uint32_t count, posix_emac_stats_t *stats) {
+    for (int i = 0; i < 200; i++) {
+        posix_emac_get_stats(emac, stats);
+        if (stats->rx_frames + stats->rx_dropped >= count) {
+            return;
+        }
+        wait_ms(10);
+    }
+    TEST_ASSERT_EQUAL(count, stats->rx_frames + stats->rx_dropped);
+}
+
+// The host Emac receives into its ring and reports how low it ran
+void test_posix_emac_low_water() {
+    emac_interface_t *tx;
+    emac_interface_t *rx;
+    TEST_ASSERT_EQUAL(0, posix_emac_pair(&tx, &rx));
+
+    rx->ops.set_link_input_cb(rx, hold_frame, NULL);
+    TEST_ASSERT(rx->ops.power_up(rx));
+
+    posix_emac_stats_t stats;
+    posix_emac_get_stats(rx, &stats);
+    const uint32_t ring_size = stats.rx_ring_low_water;
+    TEST_ASSERT(ring_size > 4 && ring_size < HOST_FRAMES_MAX);
+
+    send_frames(tx, 3);
+    wait_frames(rx, 3, &stats);
+    TEST_ASSERT_EQUAL(3, stats.rx_frames);
+    TEST_ASSERT_EQUAL(ring_size - 3, stats.rx_ring_low_water);
+    release_frames();
+
+    // Buffers came back, the low water mark stays
+    send_frames(tx, 1);
+    wait_frames(rx, 4, &stats);
+    TEST_ASSERT_EQUAL(4, stats.rx_frames);
+    TEST_ASSERT_EQUAL(ring_size - 3, stats.rx_ring_low_water);
+
+    // One more frame than the ring holds is dropped
+    send_frames(tx, ring_size);
+    wait_frames(rx, 4 + ring_size, &stats);
+    TEST_ASSERT_EQUAL(3 + ring_size, stats.rx_frames);
+    TEST_ASSERT_EQUAL(1, stats.rx_dropped);
+    TEST_ASSERT_EQUAL(0, stats.rx_ring_low_water);
+    release_frames();
+
+    rx->ops.power_down(rx);
+    tx->ops.power_down(tx);
+}
+#endif
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    // The stack is not brought up, only its protection and heap are used
+    sys_init();
+    mem_init();
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Ring take and return", test_ring_take),
+    Case("Ring return through pbuf_free", test_ring_pbuf_free),
+#if !defined(LWIP_PLATFORM_POSIX)
+    Case("Ring take from interrupt", test_ring_take_from_isr),
+#endif
+#if defined(LWIP_PLATFORM_POSIX)
+    Case("Host Emac ring low water mark", test_posix_emac_low_water),
+#endif
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
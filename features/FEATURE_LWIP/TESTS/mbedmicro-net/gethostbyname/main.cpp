@@ -10,6 +10,7 @@
 #include "unity.h"
 #include "utest.h"
 #include "EthernetInterface.h"
+#include "nsapi_dns.h"
 
 using namespace utest::v1;
 
@@ -88,10 +89,90 @@ void test_dns_literal_pref() {
     TEST_ASSERT(strcmp(ip_literal, addr.get_ip_address()) == 0);
 }
 
+void test_dns_cache() {
+    SocketAddress first;
+    SocketAddress second;
+    nsapi_dns_cache_stats_t before;
+    nsapi_dns_cache_stats_t after;
+
+    nsapi_dns_cache_flush();
+    nsapi_dns_cache_get_stats(&before);
+
+    int err = net.gethostbyname(MBED_DNS_TEST_HOST, &first, ip_pref);
+    TEST_ASSERT_EQUAL(0, err);
+    err = net.gethostbyname(MBED_DNS_TEST_HOST, &second, ip_pref);
+    TEST_ASSERT_EQUAL(0, err);
+
+    nsapi_dns_cache_get_stats(&after);
+    printf("DNS: cache hits %u, misses %u\n",
+            after.hits - before.hits, after.misses - before.misses);
+
+    TEST_ASSERT_EQUAL(1, after.misses - before.misses);
+    TEST_ASSERT_EQUAL(1, after.hits - before.hits);
+    TEST_ASSERT(first == second);
+}
+
+void test_dns_cache_multiple() {
+    SocketAddress addr[MBED_CONF_NSAPI_DNS_CACHE_ADDRESSES];
+    nsapi_dns_cache_stats_t before;
+    nsapi_dns_cache_stats_t after;
+
+    nsapi_dns_cache_flush();
+    nsapi_dns_cache_get_stats(&before);
+
+    // A query for one address still caches the full answer
+    int err = net.gethostbyname(MBED_DNS_TEST_HOST, &addr[0], ip_pref);
+    TEST_ASSERT_EQUAL(0, err);
+    int count = nsapi_dns_query_multiple(&net, MBED_DNS_TEST_HOST, addr,
+            MBED_CONF_NSAPI_DNS_CACHE_ADDRESSES, ip_pref);
+    TEST_ASSERT(count > 0);
+
+    nsapi_dns_cache_get_stats(&after);
+    printf("DNS: %d addresses, cache hits %u, misses %u\n", count,
+            after.hits - before.hits, after.misses - before.misses);
+
+    TEST_ASSERT_EQUAL(1, after.misses - before.misses);
+    TEST_ASSERT_EQUAL(1, after.hits - before.hits);
+}
+
+Semaphore async_done;
+nsapi_error_t async_result;
+SocketAddress async_addr;
+
+void async_hostbyname(nsapi_error_t result, SocketAddress *address) {
+    async_result = result;
+    if (address) {
+        async_addr = *address;
+    }
+    async_done.release();
+}
+
+void test_dns_query_async() {
+    nsapi_dns_cache_flush();
+
+    nsapi_value_or_error_t id = net.gethostbyname_async(MBED_DNS_TEST_HOST,
+            async_hostbyname, ip_pref);
+    TEST_ASSERT(id > 0);
+
+    TEST_ASSERT(async_done.wait(30000) > 0);
+    printf("DNS: async query \"%s\" => \"%s\"\n",
+            MBED_DNS_TEST_HOST, async_addr.get_ip_address());
+
+    TEST_ASSERT_EQUAL(0, async_result);
+    TEST_ASSERT(async_addr);
+    TEST_ASSERT_EQUAL(ip_pref, async_addr.get_ip_version());
+
+    // the answer is now cached and completes immediately
+    id = net.gethostbyname_async(MBED_DNS_TEST_HOST, async_hostbyname, ip_pref);
+    TEST_ASSERT_EQUAL(0, id);
+    TEST_ASSERT(async_done.wait(0) > 0);
+    TEST_ASSERT_EQUAL(0, async_result);
+}
+
 
 // Test setup
 utest::v1::status_t test_setup(const size_t number_of_cases) {
-    GREENTEA_SETUP(20, "default_auto");
+    GREENTEA_SETUP(60, "default_auto");
     net_bringup();
     return verbose_test_setup_handler(number_of_cases);
 }
@@ -101,6 +182,9 @@ Case cases[] = {
     Case("Testing DNS preference query",    test_dns_query_pref),
     Case("Testing DNS literal",             test_dns_literal),
     Case("Testing DNS preference literal",  test_dns_literal_pref),
+    Case("Testing DNS cache",               test_dns_cache),
+    Case("Testing DNS cache multiple",      test_dns_cache_multiple),
+    Case("Testing DNS async query",         test_dns_query_async),
 };
 
 Specification specification(test_setup, cases);
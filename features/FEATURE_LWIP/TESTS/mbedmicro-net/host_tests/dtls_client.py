@@ -0,0 +1,138 @@
+# Copyright 2017 ARM Limited, All rights reserved
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import socket
+import struct
+import subprocess
+from mbed_host_tests import BaseHostTest, event_callback
+
+
+# ECDHE suites, as the target's mbed TLS has no plain RSA key exchange
+CIPHER_SUITES = [0xc02b, 0xc02f, 0xc023, 0xc027, 0xc009, 0xc013]
+
+# secp256r1, secp384r1 and uncompressed points
+EXTENSIONS = (struct.pack(">HHH", 10, 6, 4) + struct.pack(">HH", 23, 24) +
+              struct.pack(">HHBB", 11, 2, 1, 0) +
+              struct.pack(">HHH", 13, 6, 4) + struct.pack(">BBBB", 4, 3, 4, 1))
+
+
+def client_hello(seq, cookie):
+    """
+    Builds an unfragmented DTLS 1.2 ClientHello record
+    """
+    body = (b"\xfe\xfd" + os.urandom(32) + b"\x00" +
+            struct.pack(">B", len(cookie)) + cookie +
+            struct.pack(">H", 2*len(CIPHER_SUITES)) +
+            struct.pack(">%dH" % len(CIPHER_SUITES), *CIPHER_SUITES) +
+            b"\x01\x00" + struct.pack(">H", len(EXTENSIONS)) + EXTENSIONS)
+    length = struct.pack(">I", len(body))[1:]
+    msg = (b"\x01" + length + struct.pack(">H", seq) + b"\x00\x00\x00" +
+           length + body)
+    return (b"\x16\xfe\xfd\x00\x00" + struct.pack(">IH", 0, seq) +
+            struct.pack(">H", len(msg)) + msg)
+
+
+class DTLSClientTest(BaseHostTest):
+    """
+    Connects to a DTLSSocket server on the target.
+
+    - ssl_client2 connects and reconnects, resuming its session by
+      session ID and then by session ticket.
+    - Raw clients each answer the HelloVerifyRequest with the cookie and
+      then stop, leaving a handshake in the peer table. One more client
+      than the table holds means a peer is evicted.
+
+    ssl_client2 is built with the mbed TLS programs on Linux. It is taken
+    from the MBEDTLS_SSL_CLIENT2 environment variable, or from the PATH.
+    """
+
+    def __init__(self):
+        BaseHostTest.__init__(self)
+        self.target_ip = None
+        self.peers = []
+
+    def run_ssl_client2(self, port, tickets):
+        binary = os.environ.get("MBEDTLS_SSL_CLIENT2", "ssl_client2")
+        args = [binary,
+                "server_addr=%s" % self.target_ip,
+                "server_port=%d" % port,
+                "server_name=localhost",
+                "dtls=1",
+                "reconnect=1",
+                "tickets=%d" % tickets,
+                "debug_level=0"]
+
+        # Nothing reads the client's output, discard it
+        devnull = open(os.devnull, "w")
+        try:
+            ret = subprocess.call(args, stdout=devnull, stderr=subprocess.STDOUT)
+        except OSError as e:
+            self.log("HOST: Cannot start %s: %s" % (binary, e))
+            ret = -1
+        devnull.close()
+
+        self.log("HOST: ssl_client2 tickets=%d returned %d" % (tickets, ret))
+        return ret == 0
+
+    def open_peer(self, port):
+        """
+        Gets a cookie and leaves the handshake after the server's reply
+        """
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        s.settimeout(5)
+        self.peers.append(s)
+        try:
+            s.sendto(client_hello(0, b""), (self.target_ip, port))
+            data = bytearray(s.recv(2048))
+            # record header, handshake header, server_version
+            if len(data) < 28 or data[0] != 22 or data[13] != 3:
+                return False
+            cookie = bytes(data[28:28 + data[27]])
+
+            s.sendto(client_hello(1, cookie), (self.target_ip, port))
+            data = bytearray(s.recv(2048))
+            # ServerHello
+            return len(data) > 13 and data[0] == 22 and data[13] == 2
+        except socket.error as e:
+            self.log("HOST: Raw client failed: %s" % e)
+            return False
+
+    @event_callback("target_ip")
+    def _callback_target_ip(self, key, value, timestamp):
+        self.target_ip = value
+
+    @event_callback("server_port")
+    def _callback_server_port(self, key, value, timestamp):
+        """
+        Runs the clients, the value is "port,peer_max"
+        """
+        port, peer_max = [int(v) for v in value.split(",")]
+
+        result = self.run_ssl_client2(port, 0)
+        result = self.run_ssl_client2(port, 1) and result
+
+        opened = 0
+        for i in range(peer_max + 1):
+            if self.open_peer(port):
+                opened += 1
+        self.log("HOST: %d of %d raw clients got a ServerHello" % (opened, peer_max + 1))
+        result = result and opened == peer_max + 1
+
+        self.send_kv("host_result", "pass" if result else "fail")
+
+    def teardown(self):
+        for s in self.peers:
+            s.close()
+        self.peers = []
@@ -0,0 +1,110 @@
+# Copyright 2017 ARM Limited, All rights reserved
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import time
+import socket
+import subprocess
+from mbed_host_tests import BaseHostTest, event_callback
+
+
+class DTLSServerTest(BaseHostTest):
+    """
+    Runs the mbed TLS example server, ssl_server2, in DTLS mode for the
+    target to connect to. The server uses the mbed TLS test certificates,
+    keeps a session cache and issues session tickets, so the target can
+    test session resumption over DTLS.
+
+    ssl_server2 is built with the mbed TLS programs on Linux. It is taken
+    from the MBEDTLS_SSL_SERVER2 environment variable, or from the PATH.
+    """
+
+    def __init__(self):
+        BaseHostTest.__init__(self)
+        self.SERVER_IP = None # Will be determined after knowing the target IP
+        self.SERVER_PORT = 0
+        self.server = None
+        self.devnull = None
+        self.target_ip = None
+
+    @staticmethod
+    def find_interface_to_target_addr(target_ip):
+        """
+        Finds IP address of the interface through which it is connected to the target.
+
+        :return:
+        """
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        try:
+            s.connect((target_ip, 0)) # Target IP, any port
+        except socket.error:
+            s.connect((target_ip, 8000)) # Target IP, 'random' port
+        ip = s.getsockname()[0]
+        s.close()
+        return ip
+
+    @staticmethod
+    def find_free_port(ip):
+        s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        s.bind((ip, 0))
+        port = s.getsockname()[1]
+        s.close()
+        return port
+
+    def setup_dtls_server(self):
+        binary = os.environ.get("MBEDTLS_SSL_SERVER2", "ssl_server2")
+        self.SERVER_PORT = self.find_free_port(self.SERVER_IP)
+        args = [binary,
+                "server_addr=%s" % self.SERVER_IP,
+                "server_port=%d" % self.SERVER_PORT,
+                "dtls=1",
+                "tickets=1",
+                "cache_max=16",
+                "debug_level=0"]
+
+        # Nothing reads the server's output, so a pipe would fill and
+        # stall it
+        self.devnull = open(os.devnull, "w")
+        try:
+            self.server = subprocess.Popen(args, stdout=self.devnull,
+                                           stderr=subprocess.STDOUT)
+        except OSError as e:
+            self.log("HOST: Cannot start %s: %s" % (binary, e))
+            self.notify_complete(False)
+            return
+
+        # Give the server time to bind before the target connects
+        time.sleep(1)
+        self.log("HOST: ssl_server2 listening on " + self.SERVER_IP + ":" + str(self.SERVER_PORT))
+
+    @event_callback("target_ip")
+    def _callback_target_ip(self, key, value, timestamp):
+        self.target_ip = value
+        self.SERVER_IP = self.find_interface_to_target_addr(self.target_ip)
+        self.setup_dtls_server()
+
+    @event_callback("host_ip")
+    def _callback_host_ip(self, key, value, timestamp):
+        self.send_kv("host_ip", self.SERVER_IP)
+
+    @event_callback("host_port")
+    def _callback_host_port(self, key, value, timestamp):
+        self.send_kv("host_port", self.SERVER_PORT)
+
+    def teardown(self):
+        if self.server:
+            self.server.terminate()
+            self.server.wait()
+        if self.devnull:
+            self.devnull.close()
@@ -0,0 +1,65 @@
+# Copyright 2017 ARM Limited, All rights reserved
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import socket
+from mbed_host_tests import BaseHostTest, event_callback
+
+
+class TCPConnectTest(BaseHostTest):
+    """
+    Opens connections to a TCPServer on the target. Each connection sends
+    its own address as the target should see it, "ip:port", so the target
+    can check the address accept returned for it. The connections stay
+    open until the target is done with them.
+    """
+
+    def __init__(self):
+        BaseHostTest.__init__(self)
+        self.target_ip = None
+        self.connections = []
+
+    @event_callback("target_ip")
+    def _callback_target_ip(self, key, value, timestamp):
+        self.target_ip = value
+
+    @event_callback("connect")
+    def _callback_connect(self, key, value, timestamp):
+        """
+        Connects to the target, the value is "port,count"
+        """
+        port, count = [int(v) for v in value.split(",")]
+        for i in range(count):
+            try:
+                s = socket.create_connection((self.target_ip, port), 10)
+                self.connections.append(s)
+                s.sendall("%s:%d" % s.getsockname()[:2])
+            except socket.error as e:
+                self.log("HOST: Connection %d failed: %s" % (i, e))
+                break
+
+        self.log("HOST: Opened %d connections to %s:%d" %
+                 (len(self.connections), self.target_ip, port))
+        self.send_kv("connected", len(self.connections))
+
+    @event_callback("done")
+    def _callback_done(self, key, value, timestamp):
+        self.close_connections()
+
+    def close_connections(self):
+        for s in self.connections:
+            s.close()
+        self.connections = []
+
+    def teardown(self):
+        self.close_connections()
@@ -20,6 +20,7 @@ namespace {
     char tx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE] = {0};
     char rx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE] = {0};
     const char ASCII_MAX = '~' - ' ';
+    const int LATENCY_LOOPS = 16;
 }
 
 void prep_buffer(char *tx_buffer, size_t tx_size) {
@@ -28,6 +29,76 @@ void prep_buffer(char *tx_buffer, size_t tx_size) {
     }
 }
 
+struct latency {
+    int min, max, total, count;
+
+    latency() : min(0), max(0), total(0), count(0) {}
+
+    void add(int us) {
+        if (count == 0 || us < min) {
+            min = us;
+        }
+        if (us > max) {
+            max = us;
+        }
+        total += us;
+        count += 1;
+    }
+
+    void print(const char *name) {
+        printf("MBED: %s: min %dus, avg %dus, max %dus\r\n",
+                name, min, count ? total/count : 0, max);
+    }
+};
+
+// Times the socket calls themselves, which is where passing each call
+// to tcpip_thread shows up, as well as the full round trip
+bool measure_latency(TCPSocket &sock) {
+    latency send_latency;
+    latency recv_latency;
+    latency round_trip;
+    Timer timer;
+
+    for (int i = 0; i < LATENCY_LOOPS; i++) {
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+
+        timer.reset();
+        timer.start();
+        int ret = sock.send(tx_buffer, sizeof(tx_buffer));
+        send_latency.add(timer.read_us());
+        if (ret != sizeof(tx_buffer)) {
+            return false;
+        }
+
+        size_t received = 0;
+        while (received < sizeof(rx_buffer)) {
+            int start = timer.read_us();
+            ret = sock.recv(rx_buffer + received, sizeof(rx_buffer) - received);
+            recv_latency.add(timer.read_us() - start);
+            if (ret <= 0) {
+                return false;
+            }
+            received += ret;
+        }
+        round_trip.add(timer.read_us());
+        timer.stop();
+
+        if (memcmp(tx_buffer, rx_buffer, sizeof(tx_buffer)) != 0) {
+            return false;
+        }
+    }
+
+#if MBED_CONF_LWIP_TCPIP_CORE_LOCKING
+    printf("MBED: lwIP core locking enabled\r\n");
+#else
+    printf("MBED: lwIP core locking disabled\r\n");
+#endif
+    send_latency.print("send()");
+    recv_latency.print("recv()");
+    round_trip.print("Round trip");
+    return true;
+}
+
 int main() {
     GREENTEA_SETUP(20, "tcp_echo");
 
@@ -72,6 +143,9 @@ int main() {
         
         TEST_ASSERT_EQUAL(ret, sizeof(rx_buffer));
         TEST_ASSERT_EQUAL(true, result);
+
+        result = measure_latency(sock);
+        TEST_ASSERT_EQUAL(true, result);
     }
 
     sock.close();
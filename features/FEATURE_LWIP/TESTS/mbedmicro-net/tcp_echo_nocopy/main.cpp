@@ -0,0 +1,96 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "TCPSocket.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+
+#ifndef MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE 256
+#endif
+
+namespace {
+    char tx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    char rx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    Semaphore tx_done(0);
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+void tx_complete() {
+    tx_done.release();
+}
+
+int main() {
+    GREENTEA_SETUP(20, "tcp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+
+    printf("MBED: TCPClient IP address is '%s'\n", eth.get_ip_address());
+    printf("MBED: TCPClient waiting for server IP and port...\n");
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    bool result = false;
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: Server IP address received: %s:%d \n", ipbuf, port);
+
+    TCPSocket sock(&eth);
+    SocketAddress tcp_addr(ipbuf, port);
+    if (sock.connect(tcp_addr) == 0) {
+        printf("HTTP: Connected to %s:%d\r\n", ipbuf, port);
+
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+        const int sent = sock.send_nocopy(tx_buffer, sizeof(tx_buffer), tx_complete);
+        TEST_ASSERT_EQUAL(sizeof(tx_buffer), sent);
+
+        // Gather the echo from the chains held by the stack
+        size_t received = 0;
+        while (received < sizeof(rx_buffer)) {
+            nsapi_chain_t chain;
+            const int ret = sock.recv_chain(&chain);
+            TEST_ASSERT(ret > 0);
+            TEST_ASSERT(received + ret <= sizeof(rx_buffer));
+
+            for (unsigned i = 0; i < chain.count; i++) {
+                memcpy(&rx_buffer[received], chain.segment[i].data, chain.segment[i].size);
+                received += chain.segment[i].size;
+            }
+            sock.recv_release(&chain);
+        }
+
+        // The echo can only arrive once the data has been acknowledged
+        TEST_ASSERT(tx_done.wait(5000) > 0);
+
+        result = !memcmp(tx_buffer, rx_buffer, sizeof(tx_buffer));
+        TEST_ASSERT_EQUAL(true, result);
+    }
+
+    sock.close();
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
@@ -0,0 +1,118 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "TCPSocket.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+
+namespace {
+    // A request written as a small header and body, the pattern Nagle's
+    // algorithm holds back until the header is acknowledged
+    const int HEADER_SIZE = 8;
+    const int BODY_SIZE = 24;
+    char tx_buffer[HEADER_SIZE + BODY_SIZE] = {0};
+    char rx_buffer[HEADER_SIZE + BODY_SIZE] = {0};
+    const int LATENCY_LOOPS = 32;
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+// Average round trip in us of split writes, or -1 on failure
+int measure_round_trip(NetworkInterface *net, const SocketAddress &tcp_addr, bool nodelay) {
+    TCPSocket sock;
+    TEST_ASSERT_EQUAL(0, sock.open(net));
+
+    int value = nodelay;
+    TEST_ASSERT_EQUAL(0, sock.setsockopt(NSAPI_SOCKET, NSAPI_TCP_NODELAY, &value, sizeof(value)));
+
+    // Reset rather than wait on close if anything is left unsent
+    nsapi_linger_t linger = {1, 0};
+    TEST_ASSERT_EQUAL(0, sock.setsockopt(NSAPI_SOCKET, NSAPI_LINGER, &linger, sizeof(linger)));
+
+    if (sock.connect(tcp_addr) != 0) {
+        return -1;
+    }
+
+    value = -1;
+    unsigned optlen = sizeof(value);
+    TEST_ASSERT_EQUAL(0, sock.getsockopt(NSAPI_SOCKET, NSAPI_TCP_NODELAY, &value, &optlen));
+    TEST_ASSERT_EQUAL(nodelay, value);
+
+    int total = 0;
+    Timer timer;
+    for (int i = 0; i < LATENCY_LOOPS; i++) {
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+
+        timer.reset();
+        timer.start();
+        if (sock.send(tx_buffer, HEADER_SIZE) != HEADER_SIZE ||
+            sock.send(tx_buffer + HEADER_SIZE, BODY_SIZE) != BODY_SIZE) {
+            return -1;
+        }
+
+        size_t received = 0;
+        while (received < sizeof(rx_buffer)) {
+            int ret = sock.recv(rx_buffer + received, sizeof(rx_buffer) - received);
+            if (ret <= 0) {
+                return -1;
+            }
+            received += ret;
+        }
+        timer.stop();
+        total += timer.read_us();
+
+        if (memcmp(tx_buffer, rx_buffer, sizeof(tx_buffer)) != 0) {
+            return -1;
+        }
+    }
+
+    sock.close();
+    return total / LATENCY_LOOPS;
+}
+
+int main() {
+    GREENTEA_SETUP(60, "tcp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("MBED: TCPClient IP address is '%s'\n", eth.get_ip_address());
+    printf("MBED: TCPClient waiting for server IP and port...\n");
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress tcp_addr(ipbuf, port);
+
+    int nagle = measure_round_trip(&eth, tcp_addr, false);
+    int nodelay = measure_round_trip(&eth, tcp_addr, true);
+
+    printf("MBED: %d+%d byte requests, average round trip\r\n", HEADER_SIZE, BODY_SIZE);
+    printf("MBED: Nagle:       %dus\r\n", nagle);
+    printf("MBED: TCP_NODELAY: %dus\r\n", nodelay);
+
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(nagle >= 0 && nodelay >= 0);
+}
@@ -13,6 +13,8 @@
 #include "TCPSocket.h"
 #include "greentea-client/test_env.h"
 #include "unity/unity.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
 
 
 #ifndef MBED_CFG_TCP_CLIENT_PACKET_PRESSURE_MIN
@@ -221,6 +223,12 @@ int main() {
     printf("MBED: Speed: %.3fkb/s\r\n",
             8*(2*MBED_CFG_TCP_CLIENT_PACKET_PRESSURE_MAX - 
             MBED_CFG_TCP_CLIENT_PACKET_PRESSURE_MIN) / (1000*timer.read()));
+    // The RAM the speed was bought with, to compare lwip.throughput-profile
+    printf("MBED: lwIP TCP_MSS %d, TCP_WND %d, TCP_SND_BUF %d, heap %d bytes, "
+            "PBUF_POOL %d x %d = %d bytes\r\n",
+            (int)TCP_MSS, (int)TCP_WND, (int)TCP_SND_BUF, (int)MEM_SIZE,
+            (int)PBUF_POOL_SIZE, (int)PBUF_POOL_BUFSIZE,
+            (int)(PBUF_POOL_SIZE * PBUF_POOL_BUFSIZE));
 
     eth.disconnect();
     GREENTEA_TESTSUITE_RESULT(result);
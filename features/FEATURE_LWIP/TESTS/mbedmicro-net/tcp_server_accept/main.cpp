@@ -0,0 +1,131 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "TCPServer.h"
+#include "TCPSocket.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#include "lwip/opt.h"
+
+
+#ifndef MBED_CFG_TCP_SERVER_ACCEPT_PORT
+#define MBED_CFG_TCP_SERVER_ACCEPT_PORT 7045
+#endif
+
+// The server and its connections all fit in lwip.socket-max
+#ifndef MBED_CFG_TCP_SERVER_ACCEPT_CONNECTIONS
+#define MBED_CFG_TCP_SERVER_ACCEPT_CONNECTIONS 3
+#endif
+
+#ifndef MBED_CFG_TCP_SERVER_ACCEPT_TIMEOUT
+#define MBED_CFG_TCP_SERVER_ACCEPT_TIMEOUT 10000
+#endif
+
+namespace {
+    const int CONNECTIONS = MBED_CFG_TCP_SERVER_ACCEPT_CONNECTIONS;
+    char rx_buffer[64] = {0};
+    char addr_buffer[64] = {0};
+
+    volatile int accept_events = 0;
+    Semaphore accept_sem(0);
+}
+
+void accept_event() {
+    accept_events += 1;
+    accept_sem.release();
+}
+
+// Each connection sends the address the host connected from
+bool check_connection(TCPSocket *sock, const SocketAddress &addr) {
+    sock->set_timeout(MBED_CFG_TCP_SERVER_ACCEPT_TIMEOUT);
+    int size = sock->recv(rx_buffer, sizeof(rx_buffer) - 1);
+    if (size <= 0) {
+        printf("MBED: Connection from %s:%d, recv failed: %d\r\n",
+                addr.get_ip_address(), addr.get_port(), size);
+        return false;
+    }
+    rx_buffer[size] = '\0';
+
+    snprintf(addr_buffer, sizeof(addr_buffer), "%s:%d",
+            addr.get_ip_address(), addr.get_port());
+    printf("MBED: Accepted %s, host sent %s\r\n", addr_buffer, rx_buffer);
+    return strcmp(addr_buffer, rx_buffer) == 0;
+}
+
+int main() {
+    GREENTEA_SETUP(40, "tcp_connect");
+
+    // The accept queue is the stack's accept mailbox
+    TEST_ASSERT_EQUAL(MBED_CONF_LWIP_ACCEPT_QUEUE_SIZE, DEFAULT_ACCEPTMBOX_SIZE);
+    TEST_ASSERT(CONNECTIONS <= DEFAULT_ACCEPTMBOX_SIZE);
+
+    EthernetInterface eth;
+    int err = eth.connect();
+    TEST_ASSERT_EQUAL(0, err);
+
+    printf("MBED: TCPServer IP address is '%s'\n", eth.get_ip_address());
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    TCPServer server;
+    TEST_ASSERT_EQUAL(0, server.open(&eth));
+    TEST_ASSERT_EQUAL(0, server.bind(MBED_CFG_TCP_SERVER_ACCEPT_PORT));
+    TEST_ASSERT_EQUAL(0, server.listen(CONNECTIONS));
+    server.set_blocking(false);
+    server.attach_accept(accept_event);
+
+    // One spare entry so a miscount shows up
+    TCPSocket connections[CONNECTIONS + 1];
+    SocketAddress addresses[CONNECTIONS + 1];
+
+    // Nothing is queued yet
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_WOULD_BLOCK,
+            server.accept_many(connections, addresses, CONNECTIONS + 1));
+
+    char connect_buffer[32];
+    snprintf(connect_buffer, sizeof(connect_buffer), "%d,%d",
+            MBED_CFG_TCP_SERVER_ACCEPT_PORT, CONNECTIONS);
+    greentea_send_kv("connect", connect_buffer);
+
+    char recv_key[] = "connected";
+    char count_buffer[16] = {0};
+    greentea_parse_kv(recv_key, count_buffer, sizeof(recv_key), sizeof(count_buffer));
+    TEST_ASSERT_EQUAL(CONNECTIONS, atoi(count_buffer));
+
+    // attach_accept fires once for each queued connection
+    while (accept_events < CONNECTIONS) {
+        if (accept_sem.wait(MBED_CFG_TCP_SERVER_ACCEPT_TIMEOUT) < 1) {
+            break;
+        }
+    }
+    printf("MBED: %d accept events\r\n", accept_events);
+    TEST_ASSERT(accept_events >= CONNECTIONS);
+
+    // The count limits how many are taken, the rest stay queued
+    TEST_ASSERT_EQUAL(1, server.accept_many(connections, addresses, 1));
+    TEST_ASSERT_EQUAL(CONNECTIONS - 1,
+            server.accept_many(&connections[1], &addresses[1], CONNECTIONS));
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_WOULD_BLOCK,
+            server.accept_many(connections, addresses, CONNECTIONS + 1));
+
+    bool result = true;
+    for (int i = 0; i < CONNECTIONS; i++) {
+        result = check_connection(&connections[i], addresses[i]) && result;
+    }
+    TEST_ASSERT_EQUAL(true, result);
+
+    greentea_send_kv("done", " ");
+
+    for (int i = 0; i < CONNECTIONS; i++) {
+        connections[i].close();
+    }
+    server.close();
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
@@ -0,0 +1,134 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+#if !DEVICE_TRNG
+    #error [NOT_SUPPORTED] TLS needs an entropy source
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "TLSSocket.h"
+#include "mbedtls/certs.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_TLS_RESUME_CONNECTIONS
+#define MBED_CFG_TLS_RESUME_CONNECTIONS 4
+#endif
+
+namespace {
+    // ssl_server2 answers any request with a short HTML page
+    const char request[] = "GET / HTTP/1.0\r\n\r\n";
+    const char response[] = "HTTP/1.0 200 OK";
+    char rx_buffer[512] = {0};
+}
+
+// Requests a page and reads it until the server closes
+bool tls_request(TLSSocket *sock, NetworkInterface *net, const SocketAddress &addr) {
+    TEST_ASSERT_EQUAL(0, sock->open(net));
+
+    int err = sock->connect(addr);
+    if (err) {
+        printf("MBED: TLS connect failed: %d\r\n", err);
+        sock->close();
+        return false;
+    }
+
+    if (sock->send(request, sizeof(request) - 1) != sizeof(request) - 1) {
+        sock->close();
+        return false;
+    }
+
+    size_t received = 0;
+    while (true) {
+        int ret = sock->recv(rx_buffer + received, sizeof(rx_buffer) - 1 - received);
+        if (ret <= 0) {
+            break;
+        }
+
+        // Only the start of the page is kept
+        if (received + ret < sizeof(rx_buffer) - 1) {
+            received += ret;
+        }
+    }
+    rx_buffer[received] = '\0';
+
+    sock->close();
+    return strncmp(rx_buffer, response, sizeof(response) - 1) == 0;
+}
+
+int main() {
+    GREENTEA_SETUP(120, "tls_server");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("MBED: TLSClient IP address is '%s'\n", eth.get_ip_address());
+    printf("MBED: TLSClient waiting for server IP and port...\n");
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress tls_addr(ipbuf, port);
+
+    bool result = true;
+    nsapi_tls_stats_t stats;
+
+    // The test server certificate is issued to localhost
+    TLSSocket sock;
+    TEST_ASSERT_EQUAL(0, sock.set_root_ca_cert(mbedtls_test_cas_pem));
+    TEST_ASSERT_EQUAL(0, sock.set_hostname("localhost"));
+
+    for (int i = 0; i < MBED_CFG_TLS_RESUME_CONNECTIONS; i++) {
+        if (!tls_request(&sock, &eth, tls_addr)) {
+            result = false;
+            break;
+        }
+
+        sock.get_stats(&stats);
+        printf("MBED: connection %d: %s handshake in %ums\r\n", i,
+                stats.last_resumed ? "resumed" : "full", stats.last_ms);
+
+        // Only the first connection needs a full handshake
+        if (stats.last_resumed != (i > 0)) {
+            result = false;
+        }
+    }
+
+    sock.get_stats(&stats);
+    unsigned full = stats.handshakes - stats.resumed;
+    printf("MBED: %u full handshakes, average %ums\r\n",
+            full, full ? stats.full_ms / full : 0);
+    printf("MBED: %u resumed handshakes, average %ums\r\n",
+            stats.resumed, stats.resumed ? stats.resumed_ms / stats.resumed : 0);
+
+    // Sessions are kept in the default cache, so other sockets resume too
+    TLSSocket other;
+    TEST_ASSERT_EQUAL(0, other.set_root_ca_cert(mbedtls_test_cas_pem));
+    TEST_ASSERT_EQUAL(0, other.set_hostname("localhost"));
+    if (tls_request(&other, &eth, tls_addr)) {
+        other.get_stats(&stats);
+        printf("MBED: new socket: %s handshake in %ums\r\n",
+                stats.last_resumed ? "resumed" : "full", stats.last_ms);
+        result = result && stats.last_resumed;
+    } else {
+        result = false;
+    }
+
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
@@ -0,0 +1,121 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "UDPSocket.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE 64
+#endif
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT
+#define MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT 500
+#endif
+
+
+namespace {
+    // Stays within the default lwIP receive mailbox
+    const int ECHO_BURST = 4;
+    const int ECHO_LOOPS = 16;
+    char tx_buffer[ECHO_BURST][MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {{0}};
+    char rx_buffer[ECHO_BURST][MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {{0}};
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+int main() {
+    GREENTEA_SETUP(20, "udp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("UDP client IP Address is %s\n", eth.get_ip_address());
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    UDPSocket sock;
+    sock.open(&eth);
+    sock.set_timeout(MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT);
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: UDP Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress udp_addr(ipbuf, port);
+
+    int success = 0;
+
+    for (int i=0; i < ECHO_LOOPS; ++i) {
+        nsapi_datagram_t tx_msgs[ECHO_BURST];
+        for (int j = 0; j < ECHO_BURST; j++) {
+            prep_buffer(tx_buffer[j], sizeof(tx_buffer[j]));
+            tx_msgs[j].addr = udp_addr.get_addr();
+            tx_msgs[j].port = udp_addr.get_port();
+            tx_msgs[j].data = tx_buffer[j];
+            tx_msgs[j].size = sizeof(tx_buffer[j]);
+        }
+
+        // Send the whole burst in one call
+        int sent = 0;
+        while (sent < ECHO_BURST) {
+            const int ret = sock.sendto_many(&tx_msgs[sent], ECHO_BURST - sent);
+            printf("[%02d] sent...%d datagrams \n", i, ret);
+            if (ret <= 0) {
+                break;
+            }
+            sent += ret;
+        }
+
+        // Collect the echoes, as many per call as have arrived
+        nsapi_datagram_t rx_msgs[ECHO_BURST];
+        for (int j = 0; j < ECHO_BURST; j++) {
+            rx_msgs[j].data = rx_buffer[j];
+            rx_msgs[j].size = sizeof(rx_buffer[j]);
+        }
+
+        int received = 0;
+        while (received < sent) {
+            const int n = sock.recvfrom_many(&rx_msgs[received], sent - received);
+            printf("[%02d] recv...%d datagrams \n", i, n);
+            if (n <= 0) {
+                break;
+            }
+            received += n;
+        }
+
+        // The echo server answers in order, match each datagram to its burst slot
+        for (int j = 0; j < received; j++) {
+            SocketAddress temp_addr(rx_msgs[j].addr, rx_msgs[j].port);
+            if (temp_addr == udp_addr &&
+                rx_msgs[j].length == sizeof(tx_buffer[j]) &&
+                memcmp(rx_buffer[j], tx_buffer[j], sizeof(tx_buffer[j])) == 0) {
+                success += 1;
+            }
+        }
+    }
+
+    bool result = (success > 3*ECHO_LOOPS*ECHO_BURST/4);
+
+    sock.close();
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
@@ -0,0 +1,109 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "UDPSocket.h"
+#include "lwip_stack.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE 256
+#endif
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT
+#define MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT 500
+#endif
+
+
+namespace {
+    char tx_buffer[MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    char rx_buffer[MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    const int ECHO_LOOPS = 16;
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+// Echo through a socket opened on the given stack, true if most come back
+bool echo(NetworkStack *stack, const SocketAddress &udp_addr) {
+    UDPSocket sock;
+    TEST_ASSERT_EQUAL(0, sock.open(stack));
+    sock.set_timeout(MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT);
+
+    int success = 0;
+    for (int i=0; i < ECHO_LOOPS; ++i) {
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+        const int ret = sock.sendto(udp_addr, tx_buffer, sizeof(tx_buffer));
+        printf("[%02d] sent...%d Bytes \n", i, ret);
+
+        SocketAddress temp_addr;
+        const int n = sock.recvfrom(&temp_addr, rx_buffer, sizeof(rx_buffer));
+        printf("[%02d] recv...%d Bytes \n", i, n);
+
+        if ((temp_addr == udp_addr &&
+             n == sizeof(tx_buffer) &&
+             memcmp(rx_buffer, tx_buffer, sizeof(rx_buffer)) == 0)) {
+            success += 1;
+        }
+    }
+
+    sock.close();
+    return success > 3*ECHO_LOOPS/4;
+}
+
+int main() {
+    GREENTEA_SETUP(30, "udp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("UDP client IP Address is %s\n", eth.get_ip_address());
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: UDP Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress udp_addr(ipbuf, port);
+
+    // The Ethernet interface's own view of the stack
+    nsapi_stack_t *netif_stack = mbed_lwip_get_netif_stack(0);
+    TEST_ASSERT_NOT_NULL(netif_stack);
+    NetworkStack *stack = nsapi_create_stack(netif_stack);
+    TEST_ASSERT_EQUAL_STRING(eth.get_ip_address(), stack->get_ip_address());
+
+    printf("MBED: Echo through the interface view\r\n");
+    bool result = echo(stack, udp_addr);
+
+    // A host route through the same interface, only when routing is enabled
+    nsapi_error_t err = mbed_lwip_add_route(ipbuf, "255.255.255.255", 0, 0);
+    if (err == NSAPI_ERROR_UNSUPPORTED) {
+        printf("MBED: Routing is disabled, set lwip.netif-max above 1\r\n");
+    } else {
+        TEST_ASSERT_EQUAL(0, err);
+        printf("MBED: Echo through the routing table\r\n");
+        result = echo(nsapi_create_stack(&eth), udp_addr) && result;
+        TEST_ASSERT_EQUAL(0, mbed_lwip_remove_route(ipbuf, "255.255.255.255", 0));
+    }
+
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
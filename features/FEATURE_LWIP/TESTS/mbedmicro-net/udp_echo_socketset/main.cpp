@@ -0,0 +1,187 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "UDPSocket.h"
+#include "SocketSet.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE 64
+#endif
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT
+#define MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT 500
+#endif
+
+
+namespace {
+    const int ECHO_SOCKETS = 2;
+    const int ECHO_LOOPS = 16;
+    char tx_buffer[ECHO_SOCKETS][MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {{0}};
+    char rx_buffer[MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+
+    UDPSocket sock[ECHO_SOCKETS];
+    SocketAddress udp_addr;
+    volatile bool echoed[ECHO_SOCKETS];
+    volatile int pending;
+    int success = 0;
+    Semaphore round_done;
+    int stale_calls = 0;
+    Semaphore queue_blocked;
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+// Events are only hints, drain until the socket would block
+void drain(int i, int j) {
+    SocketAddress temp_addr;
+    int n;
+    while ((n = sock[j].recvfrom(&temp_addr, rx_buffer, sizeof(rx_buffer))) >= 0) {
+        printf("[%02d:%d] recv...%d Bytes \n", i, j, n);
+        if (!echoed[j] &&
+            temp_addr == udp_addr &&
+            n == sizeof(rx_buffer) &&
+            memcmp(rx_buffer, tx_buffer[j], sizeof(rx_buffer)) == 0) {
+            echoed[j] = true;
+            pending -= 1;
+            success += 1;
+        }
+    }
+}
+
+void send_round(int i) {
+    for (int j = 0; j < ECHO_SOCKETS; j++) {
+        echoed[j] = false;
+        prep_buffer(tx_buffer[j], sizeof(tx_buffer[j]));
+        const int ret = sock[j].sendto(udp_addr, tx_buffer[j], sizeof(tx_buffer[j]));
+        printf("[%02d:%d] sent...%d Bytes \n", i, j, ret);
+    }
+}
+
+int queue_round;
+
+// Runs on the event queue for each signalled socket
+void queue_handler(Socket *socket) {
+    drain(queue_round, static_cast<UDPSocket*>(socket) - sock);
+    if (pending == 0) {
+        round_done.release();
+    }
+}
+
+void stale_handler(Socket *socket) {
+    stale_calls++;
+}
+
+void block_queue() {
+    queue_blocked.wait();
+}
+
+int main() {
+    GREENTEA_SETUP(40, "udp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("UDP client IP Address is %s\n", eth.get_ip_address());
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: UDP Server IP address received: %s:%d \n", ipbuf, port);
+    udp_addr = SocketAddress(ipbuf, port);
+
+    SocketSet set;
+    for (int j = 0; j < ECHO_SOCKETS; j++) {
+        sock[j].open(&eth);
+        TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, set.add(&sock[j]));
+    }
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_PARAMETER, set.add(&sock[0]));
+
+    for (int i=0; i < ECHO_LOOPS; ++i) {
+        // Send from every socket, then serve the echoes from one thread
+        pending = ECHO_SOCKETS;
+        send_round(i);
+
+        while (pending > 0) {
+            Socket *ready[ECHO_SOCKETS];
+            int count = set.wait(ready, ECHO_SOCKETS, MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT);
+            if (count == NSAPI_ERROR_WOULD_BLOCK) {
+                printf("[%02d] timeout waiting for %d echoes\n", i, pending);
+                break;
+            }
+
+            for (int k = 0; k < count; k++) {
+                drain(i, static_cast<UDPSocket*>(ready[k]) - sock);
+            }
+        }
+    }
+
+    // Serve the same echoes from an event queue instead of wait
+    EventQueue queue;
+    Thread queue_thread;
+    queue_thread.start(callback(&queue, &EventQueue::dispatch_forever));
+
+    for (int i=0; i < ECHO_LOOPS; ++i) {
+        while (round_done.wait(0) > 0) {
+        }
+
+        // the handler starts once the round has been sent
+        queue.call(block_queue);
+        queue_round = ECHO_LOOPS + i;
+        pending = ECHO_SOCKETS;
+        set.attach(&queue, queue_handler);
+        send_round(queue_round);
+        queue_blocked.release();
+
+        if (round_done.wait(MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT) < 1) {
+            printf("[%02d] timeout waiting for %d echoes\n", queue_round, pending);
+        }
+
+        // stop dispatching before the next round updates the buffers
+        queue.call(block_queue);
+        set.attach(&queue, 0);
+        queue_blocked.release();
+    }
+
+    // A set destroyed with a dispatch still queued must not be called
+    queue.call(block_queue);
+    SocketSet *stale = new SocketSet;
+    stale->attach(&queue, stale_handler);
+    stale->add(&sock[0]);
+    delete stale;
+    queue_blocked.release();
+    queue.call(block_queue);
+    queue_blocked.release();
+    Thread::wait(100);
+    printf("MBED: %d calls to a destroyed set\n", stale_calls);
+
+    bool result = (success > 3*2*ECHO_LOOPS*ECHO_SOCKETS/4) && stale_calls == 0;
+
+    for (int j = 0; j < ECHO_SOCKETS; j++) {
+        set.remove(&sock[j]);
+        sock[j].close();
+    }
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
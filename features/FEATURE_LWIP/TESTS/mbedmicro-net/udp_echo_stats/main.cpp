@@ -0,0 +1,133 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "UDPSocket.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE 256
+#endif
+
+#ifndef MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT
+#define MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT 500
+#endif
+
+
+namespace {
+    char tx_buffer[MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    char rx_buffer[MBED_CFG_UDP_CLIENT_ECHO_BUFFER_SIZE] = {0};
+    const int ECHO_LOOPS = 16;
+}
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+void print_pool(const char *name, const nsapi_stack_pool_stats_t *pool) {
+    printf("MBED: %s used: %lu (max %lu) of %lu, %lu failed\r\n", name,
+            (unsigned long)pool->used, (unsigned long)pool->max,
+            (unsigned long)pool->avail, (unsigned long)pool->err);
+}
+
+int main() {
+    GREENTEA_SETUP(20, "udp_echo");
+
+    EthernetInterface eth;
+    eth.connect();
+    printf("UDP client IP Address is %s\n", eth.get_ip_address());
+
+    NetworkStack *stack = nsapi_create_stack(&eth);
+    nsapi_stack_stats_t before;
+    unsigned optlen = sizeof(before);
+    nsapi_error_t err = stack->getstackopt(NSAPI_STACK, NSAPI_STACK_STATS, &before, &optlen);
+    if (err == NSAPI_ERROR_UNSUPPORTED) {
+        printf("MBED: Stack statistics are disabled, set lwip.stats-enabled\r\n");
+    } else {
+        TEST_ASSERT_EQUAL(0, err);
+        TEST_ASSERT_EQUAL(sizeof(before), optlen);
+    }
+
+    greentea_send_kv("target_ip", eth.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    UDPSocket sock;
+    sock.open(&eth);
+    sock.set_timeout(MBED_CFG_UDP_CLIENT_ECHO_TIMEOUT);
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: UDP Server IP address received: %s:%d \n", ipbuf, port);
+    SocketAddress udp_addr(ipbuf, port);
+
+    int sent = 0;
+    int success = 0;
+
+    for (int i=0; i < ECHO_LOOPS; ++i) {
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+        const int ret = sock.sendto(udp_addr, tx_buffer, sizeof(tx_buffer));
+        printf("[%02d] sent...%d Bytes \n", i, ret);
+        if (ret == sizeof(tx_buffer)) {
+            sent += 1;
+        }
+
+        SocketAddress temp_addr;
+        const int n = sock.recvfrom(&temp_addr, rx_buffer, sizeof(rx_buffer));
+        printf("[%02d] recv...%d Bytes \n", i, n);
+
+        if ((temp_addr == udp_addr &&
+             n == sizeof(tx_buffer) &&
+             memcmp(rx_buffer, tx_buffer, sizeof(rx_buffer)) == 0)) {
+            success += 1;
+        }
+    }
+
+    bool result = (success > 3*ECHO_LOOPS/4);
+
+    if (err == 0) {
+        // Every datagram we sent or got back has to show up in the counters
+        nsapi_stack_stats_t after;
+        optlen = sizeof(after);
+        TEST_ASSERT_EQUAL(0, stack->getstackopt(NSAPI_STACK, NSAPI_STACK_STATS, &after, &optlen));
+
+        printf("MBED: UDP: %lu sent, %lu received, %lu dropped\r\n",
+                (unsigned long)(after.udp.xmit - before.udp.xmit),
+                (unsigned long)(after.udp.recv - before.udp.recv),
+                (unsigned long)(after.udp.drop - before.udp.drop));
+        printf("MBED: Link: %lu sent, %lu received, %lu dropped\r\n",
+                (unsigned long)(after.link.xmit - before.link.xmit),
+                (unsigned long)(after.link.recv - before.link.recv),
+                (unsigned long)(after.link.drop - before.link.drop));
+        printf("MBED: Mailbox full: %lu\r\n", (unsigned long)after.mbox_full);
+        print_pool("Heap", &after.heap);
+        print_pool("PBUF_POOL", &after.pbuf_pool);
+        print_pool("PBUF", &after.pbuf);
+
+        result = result &&
+            after.udp.xmit - before.udp.xmit >= (uint32_t)sent &&
+            after.udp.recv - before.udp.recv >= (uint32_t)success &&
+            after.link.xmit - before.link.xmit >= (uint32_t)sent &&
+            after.link.recv - before.link.recv >= (uint32_t)success;
+    }
+
+    sock.close();
+    eth.disconnect();
+    GREENTEA_TESTSUITE_RESULT(result);
+}
@@ -16,8 +16,50 @@
 
 #if DEVICE_EMAC
 
+#include <stdlib.h>
 #include "emac_stack_mem.h"
 #include "pbuf.h"
+#include "lwip/sys.h"
+#if !defined(LWIP_PLATFORM_POSIX)
+#include "critical.h"
+#endif
+
+/* Receive ring buffer, the custom pbuf must come first */
+struct emac_ring_buffer {
+    struct pbuf_custom pc;
+    struct emac_ring *ring;
+    uint8_t *mem;
+};
+
+struct emac_ring {
+    struct emac_ring_buffer *buffers;
+    struct emac_ring_buffer **free_list;    // first stats.available are ready
+    uint8_t *block;
+    uint32_t size;
+    bool destroyed;
+    emac_stack_mem_ring_stats_t stats;
+};
+
+/* Drivers refill DMA descriptors from their receive interrupt, where the
+ * lwIP protection mutex cannot be taken, so the ring uses a critical
+ * section. The host has no interrupts and its drivers are threads. */
+static inline void emac_ring_lock(void)
+{
+#if defined(LWIP_PLATFORM_POSIX)
+    sys_arch_protect();
+#else
+    core_util_critical_section_enter();
+#endif
+}
+
+static inline void emac_ring_unlock(void)
+{
+#if defined(LWIP_PLATFORM_POSIX)
+    sys_arch_unprotect(1);
+#else
+    core_util_critical_section_exit();
+#endif
+}
 
 emac_stack_mem_t *emac_stack_mem_alloc(emac_stack_t* stack, uint32_t size, uint32_t align)
 {
@@ -28,7 +70,7 @@ emac_stack_mem_t *emac_stack_mem_alloc(emac_stack_t* stack, uint32_t size, uint3
     }
 
     if (align) {
-        uint32_t remainder = (uint32_t)pbuf->payload % align;
+        uint32_t remainder = (uintptr_t)pbuf->payload % align;
         uint32_t offset = align - remainder;
         if (offset >= align) {
             offset = align;
@@ -67,6 +109,9 @@ void emac_stack_mem_set_len(emac_stack_t* stack, emac_stack_mem_t *mem, uint32_t
     struct pbuf *pbuf = (struct pbuf*)mem;
 
     pbuf->len = len;
+    if (!pbuf->next) {
+        pbuf->tot_len = len;
+    }
 }
 
 emac_stack_mem_t *emac_stack_mem_chain_dequeue(emac_stack_t* stack, emac_stack_mem_chain_t **chain)
@@ -88,4 +133,123 @@ void emac_stack_mem_ref(emac_stack_t* stack, emac_stack_mem_t *mem)
     pbuf_ref((struct pbuf*)mem);
 }
 
+static void emac_ring_release(struct emac_ring *ring)
+{
+    free(ring->block);
+    free(ring->free_list);
+    free(ring->buffers);
+    free(ring);
+}
+
+/* Called by pbuf_free when the stack is done with a received frame */
+static void emac_ring_buffer_free(struct pbuf *p)
+{
+    struct emac_ring_buffer *buffer = (struct emac_ring_buffer*)p;
+    struct emac_ring *ring = buffer->ring;
+    bool release;
+
+    emac_ring_lock();
+    ring->free_list[ring->stats.available++] = buffer;
+    release = ring->destroyed && ring->stats.available == ring->stats.count;
+    emac_ring_unlock();
+
+    if (release) {
+        emac_ring_release(ring);
+    }
+}
+
+emac_stack_mem_ring_t *emac_stack_mem_ring_create(emac_stack_t* stack, uint32_t count, uint32_t size, uint32_t align)
+{
+    // pbuf lengths are 16 bits
+    if (!count || !size || size > 0xffff) {
+        return NULL;
+    }
+
+    if (align < MEM_ALIGNMENT) {
+        align = MEM_ALIGNMENT;
+    }
+    uint32_t stride = (size + align - 1) / align * align;
+
+    struct emac_ring *ring = (struct emac_ring*)calloc(1, sizeof(struct emac_ring));
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->buffers = (struct emac_ring_buffer*)calloc(count, sizeof(struct emac_ring_buffer));
+    ring->free_list = (struct emac_ring_buffer**)malloc(count * sizeof(struct emac_ring_buffer*));
+    ring->block = (uint8_t*)malloc(count * stride + align - 1);
+    if (!ring->buffers || !ring->free_list || !ring->block) {
+        emac_ring_release(ring);
+        return NULL;
+    }
+
+    // Alignment is only worked out once, for the whole block
+    uint8_t *mem = ring->block + (align - (uintptr_t)ring->block % align) % align;
+    for (uint32_t i = 0; i < count; i++) {
+        struct emac_ring_buffer *buffer = &ring->buffers[i];
+        buffer->pc.custom_free_function = emac_ring_buffer_free;
+        buffer->ring = ring;
+        buffer->mem = mem + i * stride;
+        ring->free_list[i] = buffer;
+    }
+
+    ring->size = size;
+    ring->stats.count = count;
+    ring->stats.available = count;
+    ring->stats.low_water = count;
+
+    return (emac_stack_mem_ring_t*)ring;
+}
+
+void emac_stack_mem_ring_destroy(emac_stack_t* stack, emac_stack_mem_ring_t *ring)
+{
+    struct emac_ring *r = (struct emac_ring*)ring;
+    bool release;
+
+    emac_ring_lock();
+    r->destroyed = true;
+    release = r->stats.available == r->stats.count;
+    emac_ring_unlock();
+
+    if (release) {
+        emac_ring_release(r);
+    }
+}
+
+emac_stack_mem_t *emac_stack_mem_ring_take(emac_stack_t* stack, emac_stack_mem_ring_t *ring)
+{
+    struct emac_ring *r = (struct emac_ring*)ring;
+    struct emac_ring_buffer *buffer = NULL;
+
+    emac_ring_lock();
+    if (r->stats.available) {
+        buffer = r->free_list[--r->stats.available];
+        if (r->stats.available < r->stats.low_water) {
+            r->stats.low_water = r->stats.available;
+        }
+        r->stats.taken++;
+    } else {
+        r->stats.starved++;
+    }
+    emac_ring_unlock();
+
+    if (!buffer) {
+        return NULL;
+    }
+
+    // The payload points into the preallocated block, so the pbuf is a
+    // reference that the stack never tries to grow into
+    return (emac_stack_mem_t*)pbuf_alloced_custom(PBUF_RAW, r->size, PBUF_REF,
+            &buffer->pc, buffer->mem, r->size);
+}
+
+void emac_stack_mem_ring_get_stats(emac_stack_t* stack, emac_stack_mem_ring_t *ring, emac_stack_mem_ring_stats_t *stats)
+{
+    struct emac_ring *r = (struct emac_ring*)ring;
+
+    emac_ring_lock();
+    *stats = r->stats;
+    emac_ring_unlock();
+}
+
 #endif /* DEVICE_EMAC */
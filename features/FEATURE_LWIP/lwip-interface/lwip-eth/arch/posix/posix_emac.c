@@ -0,0 +1,341 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if DEVICE_EMAC && defined(LWIP_PLATFORM_POSIX)
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "posix_emac.h"
+#include "emac_stack_mem.h"
+
+#define POSIX_EMAC_MTU          1500
+#define POSIX_EMAC_FRAME_MAX    (POSIX_EMAC_MTU + 18)
+#define POSIX_EMAC_HWADDR_SIZE  6
+
+/* Receive thread checks for power down at this interval */
+#define POSIX_EMAC_POLL_MS      100
+
+/* Receive buffers preallocated by the stack, as DMA descriptors would hold */
+#define POSIX_EMAC_RX_RING_SIZE 16
+
+typedef struct posix_emac {
+    int fd;
+    uint8_t hwaddr[POSIX_EMAC_HWADDR_SIZE];
+    char ifname[2];
+
+    emac_link_input_fn input_cb;
+    void *input_data;
+    emac_link_state_change_fn state_cb;
+    void *state_data;
+
+    pthread_t rx_thread;
+    volatile bool running;
+    emac_stack_mem_ring_t *rx_ring;
+
+    posix_emac_stats_t stats;
+} posix_emac_t;
+
+static uint32_t posix_emac_get_mtu_size(emac_interface_t *emac)
+{
+    (void)emac;
+    return POSIX_EMAC_MTU;
+}
+
+static void posix_emac_get_ifname(emac_interface_t *emac, char *name, uint8_t size)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    memcpy(name, hw->ifname, (size < sizeof(hw->ifname)) ? size : sizeof(hw->ifname));
+}
+
+static uint8_t posix_emac_get_hwaddr_size(emac_interface_t *emac)
+{
+    (void)emac;
+    return POSIX_EMAC_HWADDR_SIZE;
+}
+
+static void posix_emac_get_hwaddr(emac_interface_t *emac, uint8_t *addr)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    memcpy(addr, hw->hwaddr, POSIX_EMAC_HWADDR_SIZE);
+}
+
+static void posix_emac_set_hwaddr(emac_interface_t *emac, uint8_t *addr)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    memcpy(hw->hwaddr, addr, POSIX_EMAC_HWADDR_SIZE);
+}
+
+static bool posix_emac_link_out(emac_interface_t *emac, emac_stack_mem_t *buf)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    uint8_t frame[POSIX_EMAC_FRAME_MAX];
+    uint32_t len = 0;
+
+    if (emac_stack_mem_chain_len(NULL, buf) > sizeof(frame)) {
+        hw->stats.tx_errors++;
+        return false;
+    }
+
+    // TAP devices and datagram sockets take a frame per write, gather the chain
+    emac_stack_mem_chain_t *chain = (emac_stack_mem_chain_t *)buf;
+    while (chain) {
+        emac_stack_mem_t *mem = emac_stack_mem_chain_dequeue(NULL, &chain);
+        uint32_t mem_len = emac_stack_mem_len(NULL, mem);
+        memcpy(&frame[len], emac_stack_mem_ptr(NULL, mem), mem_len);
+        len += mem_len;
+    }
+
+    if (write(hw->fd, frame, len) != (ssize_t)len) {
+        hw->stats.tx_errors++;
+        return false;
+    }
+
+    hw->stats.tx_frames++;
+    hw->stats.tx_bytes += len;
+    return true;
+}
+
+static void *posix_emac_rx_thread(void *arg)
+{
+    emac_interface_t *emac = (emac_interface_t *)arg;
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    uint8_t discard[POSIX_EMAC_FRAME_MAX];
+    emac_stack_mem_t *mem = NULL;
+
+    while (hw->running) {
+        struct pollfd pfd = { hw->fd, POLLIN, 0 };
+        if (poll(&pfd, 1, POSIX_EMAC_POLL_MS) <= 0) {
+            continue;
+        }
+
+        // Like a DMA descriptor, a ring buffer is held until a frame is
+        // received into it, then passed up without copying
+        if (!mem) {
+            mem = emac_stack_mem_ring_take(NULL, hw->rx_ring);
+        }
+        if (!mem) {
+            if (read(hw->fd, discard, sizeof(discard)) > 0) {
+                hw->stats.rx_dropped++;
+            }
+            continue;
+        }
+
+        ssize_t len = read(hw->fd, emac_stack_mem_ptr(NULL, mem), POSIX_EMAC_FRAME_MAX);
+        if (len <= 0) {
+            continue;
+        }
+
+        emac_stack_mem_set_len(NULL, mem, len);
+
+        hw->stats.rx_frames++;
+        hw->stats.rx_bytes += len;
+
+        if (hw->input_cb) {
+            hw->input_cb(hw->input_data, mem);
+        } else {
+            emac_stack_mem_free(NULL, mem);
+        }
+        mem = NULL;
+    }
+
+    if (mem) {
+        emac_stack_mem_free(NULL, mem);
+    }
+
+    return NULL;
+}
+
+static bool posix_emac_power_up(emac_interface_t *emac)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+
+    hw->rx_ring = emac_stack_mem_ring_create(NULL, POSIX_EMAC_RX_RING_SIZE,
+            POSIX_EMAC_FRAME_MAX, sizeof(uint32_t));
+    if (!hw->rx_ring) {
+        return false;
+    }
+
+    hw->running = true;
+    if (pthread_create(&hw->rx_thread, NULL, posix_emac_rx_thread, emac) != 0) {
+        hw->running = false;
+        emac_stack_mem_ring_destroy(NULL, hw->rx_ring);
+        hw->rx_ring = NULL;
+        return false;
+    }
+
+    // There is no carrier to wait for on a host
+    if (hw->state_cb) {
+        hw->state_cb(hw->state_data, true);
+    }
+
+    return true;
+}
+
+static void posix_emac_power_down(emac_interface_t *emac)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+
+    if (hw->running) {
+        hw->running = false;
+        pthread_join(hw->rx_thread, NULL);
+    }
+
+    // Frames still held by the stack keep their buffers until freed
+    if (hw->rx_ring) {
+        emac_stack_mem_ring_destroy(NULL, hw->rx_ring);
+        hw->rx_ring = NULL;
+    }
+
+    if (hw->state_cb) {
+        hw->state_cb(hw->state_data, false);
+    }
+}
+
+static void posix_emac_set_link_input_cb(emac_interface_t *emac, emac_link_input_fn input_cb, void *data)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    hw->input_cb = input_cb;
+    hw->input_data = data;
+}
+
+static void posix_emac_set_link_state_cb(emac_interface_t *emac, emac_link_state_change_fn state_cb, void *data)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    hw->state_cb = state_cb;
+    hw->state_data = data;
+}
+
+static const emac_interface_ops_t posix_emac_interface = {
+    .get_mtu_size = posix_emac_get_mtu_size,
+    .get_ifname = posix_emac_get_ifname,
+    .get_hwaddr_size = posix_emac_get_hwaddr_size,
+    .get_hwaddr = posix_emac_get_hwaddr,
+    .set_hwaddr = posix_emac_set_hwaddr,
+    .link_out = posix_emac_link_out,
+    .power_up = posix_emac_power_up,
+    .power_down = posix_emac_power_down,
+    .set_link_input_cb = posix_emac_set_link_input_cb,
+    .set_link_state_cb = posix_emac_set_link_state_cb,
+};
+
+static emac_interface_t *posix_emac_create(int fd, uint8_t index)
+{
+    emac_interface_t *emac = (emac_interface_t *)malloc(sizeof(emac_interface_t));
+    posix_emac_t *hw = (posix_emac_t *)calloc(1, sizeof(posix_emac_t));
+    if (!emac || !hw) {
+        free(emac);
+        free(hw);
+        return NULL;
+    }
+
+    memcpy((void *)&emac->ops, &posix_emac_interface, sizeof(posix_emac_interface));
+    emac->hw = hw;
+
+    hw->fd = fd;
+    hw->ifname[0] = 't';
+    hw->ifname[1] = '0' + index;
+
+    // Locally administered address, unique per process and interface
+    pid_t pid = getpid();
+    hw->hwaddr[0] = 0x02;
+    hw->hwaddr[1] = 0x6d;
+    hw->hwaddr[2] = (uint8_t)(pid >> 16);
+    hw->hwaddr[3] = (uint8_t)(pid >> 8);
+    hw->hwaddr[4] = (uint8_t)(pid);
+    hw->hwaddr[5] = index;
+
+    return emac;
+}
+
+emac_interface_t *posix_emac_tap(const char *ifname)
+{
+    if (!ifname) {
+        ifname = getenv("MBED_TAP_IF");
+    }
+    if (!ifname) {
+        ifname = "tap0";
+    }
+
+    int fd = open("/dev/net/tun", O_RDWR);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    emac_interface_t *emac = posix_emac_create(fd, 0);
+    if (!emac) {
+        close(fd);
+    }
+
+    return emac;
+}
+
+int posix_emac_pair(emac_interface_t **first, emac_interface_t **second)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) < 0) {
+        return -1;
+    }
+
+    *first = posix_emac_create(fds[0], 0);
+    *second = posix_emac_create(fds[1], 1);
+    if (!*first || !*second) {
+        if (*first) {
+            free((*first)->hw);
+            free(*first);
+        }
+        if (*second) {
+            free((*second)->hw);
+            free(*second);
+        }
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    return 0;
+}
+
+void posix_emac_get_stats(emac_interface_t *emac, posix_emac_stats_t *stats)
+{
+    posix_emac_t *hw = (posix_emac_t *)emac->hw;
+    *stats = hw->stats;
+
+    if (hw->rx_ring) {
+        emac_stack_mem_ring_stats_t ring_stats;
+        emac_stack_mem_ring_get_stats(NULL, hw->rx_ring, &ring_stats);
+        stats->rx_ring_low_water = ring_stats.low_water;
+    }
+}
+
+#endif /* DEVICE_EMAC && LWIP_PLATFORM_POSIX */
@@ -0,0 +1,86 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POSIX_EMAC_H
+#define POSIX_EMAC_H
+
+#if DEVICE_EMAC && defined(LWIP_PLATFORM_POSIX)
+
+#include <stdint.h>
+#include "emac_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Host Emac interfaces
+ *
+ * Lets the lwIP stack run as a Linux process so throughput and memory use
+ * can be measured without a board. Frames are exchanged with the kernel
+ * through a TAP device, or with a second process through a socket pair.
+ */
+
+/** Traffic counters of a host Emac interface */
+typedef struct posix_emac_stats {
+    uint32_t tx_frames;
+    uint32_t tx_bytes;
+    uint32_t tx_errors;
+    uint32_t rx_frames;
+    uint32_t rx_bytes;
+    uint32_t rx_dropped;    /**< Frames dropped because the stack held every receive buffer */
+    uint32_t rx_ring_low_water; /**< Fewest receive buffers that have been free */
+} posix_emac_stats_t;
+
+/**
+ * Open a TAP device
+ *
+ * The device has to exist and be accessible by the user, for example
+ * created with "ip tuntap add dev tap0 mode tap user $USER".
+ *
+ * @param ifname Name of the TAP device, or NULL to use the MBED_TAP_IF
+ *               environment variable, falling back to "tap0"
+ * @return       Emac interface, or NULL if the device could not be opened
+ */
+emac_interface_t *posix_emac_tap(const char *ifname);
+
+/**
+ * Create a pair of connected Emac interfaces
+ *
+ * Frames sent on one interface are received on the other. Each end is
+ * expected to be used by its own stack, for example by forking after
+ * the pair is created.
+ *
+ * @param first  Destination for the first interface
+ * @param second Destination for the second interface
+ * @return       0 on success, -1 on failure
+ */
+int posix_emac_pair(emac_interface_t **first, emac_interface_t **second);
+
+/**
+ * Read the traffic counters of a host Emac interface
+ *
+ * @param emac  Interface created by posix_emac_tap or posix_emac_pair
+ * @param stats Destination for the counters
+ */
+void posix_emac_get_stats(emac_interface_t *emac, posix_emac_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEVICE_EMAC && LWIP_PLATFORM_POSIX */
+#endif /* POSIX_EMAC_H */
@@ -48,10 +48,17 @@ typedef uintptr_t          mem_ptr_t;
 #define U16_F "hu"
 #define S16_F "hd"
 #define X16_F "hx"
+#if defined(LWIP_PLATFORM_POSIX)
+#define U32_F "u"
+#define S32_F "d"
+#define X32_F "x"
+#define SZT_F "zu"
+#else
 #define U32_F "lu"
 #define S32_F "ld"
 #define X32_F "lx"
 #define SZT_F "uz"
+#endif
 
 /* ARM/LPC17xx is little endian only */
 #if !defined(BYTE_ORDER) || (BYTE_ORDER != LITTLE_ENDIAN && BYTE_ORDER != BIG_ENDIAN)
@@ -99,8 +106,11 @@ typedef uintptr_t          mem_ptr_t;
     void* thumb2_memcpy(void* pDest, const void* pSource, size_t length);
     u16_t thumb2_checksum(const void* pData, int length);
 #else
-    /* Used with IP headers only */
-    #define LWIP_CHKSUM_ALGORITHM   1
+    /* Word-at-a-time checksum from the platform, shared with other stacks */
+    #define LWIP_CHKSUM             mbed_checksum
+    #define LWIP_CHKSUM_ALGORITHM   0
+
+    #include "mbed_checksum.h"
 #endif
 
 
@@ -118,8 +128,13 @@ void assert_printf(char *msg, int line, char *file);
 #define LWIP_PLATFORM_ASSERT(flag) { ; }
 #endif 
 
+#if defined(LWIP_PLATFORM_POSIX)
+#define LWIP_PLATFORM_HTONS(x)      __builtin_bswap16(x)
+#define LWIP_PLATFORM_HTONL(x)      __builtin_bswap32(x)
+#else
 #include "cmsis.h"
 #define LWIP_PLATFORM_HTONS(x)      __REV16(x)
 #define LWIP_PLATFORM_HTONL(x)      __REV(x)
+#endif
 
 #endif /* __CC_H__ */ 
@@ -21,6 +21,7 @@
 #include "mbed_error.h"
 #include "mbed_interface.h"
 #include "us_ticker_api.h"
+#include "critical.h"
 
 /* lwIP includes. */
 #include "lwip/opt.h"
@@ -106,10 +107,233 @@ u32_t sys_now(void) {
   return (u32_t) systick_timems;
 }
 
-#else
-/* CMSIS-RTOS implementation of the lwip operating system abstraction */
+#elif !defined(LWIP_PLATFORM_POSIX)
+/* CMSIS-RTOS implementation of the lwip operating system abstraction,
+ * host builds use lwip_sys_arch_posix.c instead */
 #include "arch/sys_arch.h"
 
+static sys_mbox_stats_t lwip_sys_mbox_stats;
+
+#if MBED_CONF_LWIP_MBOX_LOCKLESS
+/* Handoffs only enter the kernel when a thread actually has to sleep, the
+ * ring itself is guarded by critical sections of a few instructions */
+
+/* Called in a critical section with space in the ring. Returns whether a
+ * sleeping consumer has to be woken once the critical section is left. */
+static int sys_mbox_push(sys_mbox_t *mbox, void *msg) {
+    mbox->queue[mbox->post_idx % MB_SIZE] = msg;
+    mbox->post_idx++;
+    lwip_sys_mbox_stats.post++;
+
+    if (mbox->fetch_waiters == 0)
+        return 0;
+    mbox->fetch_waiters--;
+    return 1;
+}
+
+/* Called in a critical section with a message in the ring. Returns whether
+ * a sleeping producer has to be woken once the critical section is left. */
+static int sys_mbox_pop(sys_mbox_t *mbox, void **msg) {
+    if (msg)
+        *msg = mbox->queue[mbox->fetch_idx % MB_SIZE];
+    mbox->fetch_idx++;
+    lwip_sys_mbox_stats.fetch++;
+
+    if (mbox->post_waiters == 0)
+        return 0;
+    mbox->post_waiters--;
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_new
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Creates a new mailbox
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      int queue_sz            -- Size of elements in the mailbox
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_new(sys_mbox_t *mbox, int queue_sz) {
+    if (queue_sz > MB_SIZE)
+        error("sys_mbox_new size error\n");
+
+    memset(mbox, 0, sizeof(*mbox));
+    mbox->size = (queue_sz > 0) ? (queue_sz) : (MB_SIZE);
+    sys_sem_new(&mbox->not_empty, 0);
+    sys_sem_new(&mbox->not_full, 0);
+    mbox->valid = 1;
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_free
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Deallocates a mailbox. If there are messages still present in the
+ *      mailbox when the mailbox is deallocated, it is an indication of a
+ *      programming error in lwIP and the developer should be notified.
+ * Inputs:
+ *      sys_mbox_t *mbox         -- Handle of mailbox
+ *---------------------------------------------------------------------------*/
+void sys_mbox_free(sys_mbox_t *mbox) {
+    if (mbox->post_idx != mbox->fetch_idx)
+        error("sys_mbox_free error\n");
+    sys_sem_free(&mbox->not_empty);
+    sys_sem_free(&mbox->not_full);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_post
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Post the "msg" to the mailbox, sleeps while the mailbox is full.
+ * Inputs:
+ *      sys_mbox_t mbox        -- Handle of mailbox
+ *      void *msg              -- Pointer to data to post
+ *---------------------------------------------------------------------------*/
+void sys_mbox_post(sys_mbox_t *mbox, void *msg) {
+    while (1) {
+        core_util_critical_section_enter();
+        if (mbox->post_idx - mbox->fetch_idx < mbox->size) {
+            int wake = sys_mbox_push(mbox, msg);
+            core_util_critical_section_exit();
+            if (wake)
+                sys_sem_signal(&mbox->not_empty);
+            return;
+        }
+        mbox->post_waiters++;
+        lwip_sys_mbox_stats.post_wait++;
+        core_util_critical_section_exit();
+
+        if (osSemaphoreWait(mbox->not_full.id, osWaitForever) < 1)
+            error("sys_mbox_post error\n");
+    }
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_trypost
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Try to post the "msg" to the mailbox.  Returns immediately with
+ *      error if cannot.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void *msg               -- Pointer to data to post
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *                                  if not.
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg) {
+    core_util_critical_section_enter();
+    if (mbox->post_idx - mbox->fetch_idx >= mbox->size) {
+        lwip_sys_mbox_stats.post_full++;
+        core_util_critical_section_exit();
+        return ERR_MEM;
+    }
+    int wake = sys_mbox_push(mbox, msg);
+    core_util_critical_section_exit();
+
+    if (wake)
+        sys_sem_signal(&mbox->not_empty);
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_fetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Blocks the thread until a message arrives in the mailbox, but does
+ *      not block the thread longer than "timeout" milliseconds (similar to
+ *      the sys_arch_sem_wait() function). The "msg" argument is a result
+ *      parameter that is set by the function (i.e., by doing "*msg =
+ *      ptr"). The "msg" parameter maybe NULL to indicate that the message
+ *      should be dropped.
+ *
+ *      The return values are the same as for the sys_arch_sem_wait() function:
+ *      Number of milliseconds spent waiting or SYS_ARCH_TIMEOUT if there was a
+ *      timeout.
+ *
+ *      A consumer only sleeps on the semaphore after registering itself as
+ *      a waiter, a producer takes a waiter off the count for every signal
+ *      it gives. A consumer that times out while a signal is already on
+ *      its way collects the signal and retries.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ *      u32_t timeout           -- Number of milliseconds until timeout
+ * Outputs:
+ *      u32_t                   -- SYS_ARCH_TIMEOUT if timeout, else number
+ *                                  of milliseconds until received.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
+    u32_t start = us_ticker_read();
+
+    while (1) {
+        core_util_critical_section_enter();
+        if (mbox->post_idx != mbox->fetch_idx) {
+            int wake = sys_mbox_pop(mbox, msg);
+            core_util_critical_section_exit();
+            if (wake)
+                sys_sem_signal(&mbox->not_full);
+            return (us_ticker_read() - start) / 1000;
+        }
+        mbox->fetch_waiters++;
+        lwip_sys_mbox_stats.fetch_wait++;
+        core_util_critical_section_exit();
+
+        uint32_t wait = osWaitForever;
+        if (timeout != 0) {
+            u32_t elapsed = (us_ticker_read() - start) / 1000;
+            wait = (elapsed < timeout) ? (timeout - elapsed) : (0);
+        }
+
+        if (osSemaphoreWait(mbox->not_empty.id, wait) < 1) {
+            core_util_critical_section_enter();
+            if (mbox->fetch_waiters > 0) {
+                mbox->fetch_waiters--;
+                core_util_critical_section_exit();
+                return SYS_ARCH_TIMEOUT;
+            }
+            core_util_critical_section_exit();
+
+            // A producer already counted us as woken, take its signal
+            osSemaphoreWait(mbox->not_empty.id, osWaitForever);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_tryfetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Similar to sys_arch_mbox_fetch, but if message is not ready
+ *      immediately, we'll return with SYS_MBOX_EMPTY.  On success, 0 is
+ *      returned.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ * Outputs:
+ *      u32_t                   -- SYS_MBOX_EMPTY if no messages.  Otherwise,
+ *                                  return ERR_OK.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg) {
+    core_util_critical_section_enter();
+    if (mbox->post_idx == mbox->fetch_idx) {
+        core_util_critical_section_exit();
+        return SYS_MBOX_EMPTY;
+    }
+    int wake = sys_mbox_pop(mbox, msg);
+    core_util_critical_section_exit();
+
+    if (wake)
+        sys_sem_signal(&mbox->not_full);
+    return ERR_OK;
+}
+
+#else
 /*---------------------------------------------------------------------------*
  * Routine:  sys_mbox_new
  *---------------------------------------------------------------------------*
@@ -162,6 +386,7 @@ void sys_mbox_free(sys_mbox_t *mbox) {
 void sys_mbox_post(sys_mbox_t *mbox, void *msg) {
     if (osMessagePut(mbox->id, (uint32_t)msg, osWaitForever) != osOK)
         error("sys_mbox_post error\n");
+    core_util_atomic_incr_u32(&lwip_sys_mbox_stats.post, 1);
 }
 
 /*---------------------------------------------------------------------------*
@@ -179,7 +404,12 @@ void sys_mbox_post(sys_mbox_t *mbox, void *msg) {
  *---------------------------------------------------------------------------*/
 err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg) {
     osStatus status = osMessagePut(mbox->id, (uint32_t)msg, 0);
-    return (status == osOK) ? (ERR_OK) : (ERR_MEM);
+    if (status != osOK) {
+        core_util_atomic_incr_u32(&lwip_sys_mbox_stats.post_full, 1);
+        return ERR_MEM;
+    }
+    core_util_atomic_incr_u32(&lwip_sys_mbox_stats.post, 1);
+    return ERR_OK;
 }
 
 /*---------------------------------------------------------------------------*
@@ -215,6 +445,7 @@ u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
         return SYS_ARCH_TIMEOUT;
     
     *msg = (void *)event.value.v;
+    core_util_atomic_incr_u32(&lwip_sys_mbox_stats.fetch, 1);
     
     return (us_ticker_read() - start) / 1000;
 }
@@ -239,10 +470,27 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg) {
         return SYS_MBOX_EMPTY;
     
     *msg = (void *)event.value.v;
+    core_util_atomic_incr_u32(&lwip_sys_mbox_stats.fetch, 1);
     
     return ERR_OK;
 }
 
+#endif
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_stats
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Snapshot of the mailbox counters
+ * Inputs:
+ *      sys_mbox_stats_t *stats -- Destination of the counters
+ *---------------------------------------------------------------------------*/
+void sys_arch_mbox_stats(sys_mbox_stats_t *stats) {
+    core_util_critical_section_enter();
+    *stats = lwip_sys_mbox_stats;
+    core_util_critical_section_exit();
+}
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_sem_new
  *---------------------------------------------------------------------------*
@@ -0,0 +1,516 @@
+/* Copyright (C) 2017 mbed.org, MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/debug.h"
+#include "lwip/def.h"
+#include "lwip/sys.h"
+
+#if defined(LWIP_PLATFORM_POSIX) && (NO_SYS == 0)
+/* POSIX threads implementation of the lwip operating system abstraction,
+ * lets the stack run as a host process for benchmarking and regression
+ * testing. Select it by building with LWIP_PLATFORM_POSIX defined. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include "arch/sys_arch.h"
+
+static void sys_posix_error(const char *msg) {
+    fprintf(stderr, "%s", msg);
+    abort();
+}
+
+/* Conditions use the monotonic clock so timeouts are not affected by
+ * changes to the wall clock */
+static void sys_posix_cond_init(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void sys_posix_deadline(struct timespec *ts, u32_t timeout) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout / 1000;
+    ts->tv_nsec += (timeout % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec += 1;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Waits on the condition until the deadline, or forever if it is NULL.
+ * Returns 0 if the condition was signalled, ETIMEDOUT otherwise */
+static int sys_posix_cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock,
+                               const struct timespec *deadline) {
+    if (!deadline) {
+        return pthread_cond_wait(cond, lock);
+    }
+
+    return pthread_cond_timedwait(cond, lock, deadline);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_new
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Creates a new mailbox
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      int queue_sz            -- Size of elements in the mailbox
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_new(sys_mbox_t *mbox, int queue_sz) {
+    if (queue_sz > MB_SIZE)
+        sys_posix_error("sys_mbox_new size error\n");
+
+    pthread_mutex_init(&mbox->lock, NULL);
+    sys_posix_cond_init(&mbox->not_empty);
+    sys_posix_cond_init(&mbox->not_full);
+    mbox->head = 0;
+    mbox->count = 0;
+    mbox->size = (queue_sz > 0) ? queue_sz : MB_SIZE;
+    mbox->valid = 1;
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_free
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Deallocates a mailbox. If there are messages still present in the
+ *      mailbox when the mailbox is deallocated, it is an indication of a
+ *      programming error in lwIP and the developer should be notified.
+ * Inputs:
+ *      sys_mbox_t *mbox         -- Handle of mailbox
+ *---------------------------------------------------------------------------*/
+void sys_mbox_free(sys_mbox_t *mbox) {
+    if (mbox->count != 0)
+        sys_posix_error("sys_mbox_free error\n");
+
+    pthread_cond_destroy(&mbox->not_full);
+    pthread_cond_destroy(&mbox->not_empty);
+    pthread_mutex_destroy(&mbox->lock);
+}
+
+/* Counters shared by all mailboxes, each mailbox lock only covers its own */
+static sys_mbox_stats_t lwip_sys_mbox_stats;
+static pthread_mutex_t lwip_sys_mbox_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void sys_mbox_count(u32_t *counter) {
+    pthread_mutex_lock(&lwip_sys_mbox_stats_lock);
+    *counter += 1;
+    pthread_mutex_unlock(&lwip_sys_mbox_stats_lock);
+}
+
+static void sys_mbox_push(sys_mbox_t *mbox, void *msg) {
+    mbox->queue[(mbox->head + mbox->count) % mbox->size] = msg;
+    mbox->count += 1;
+    pthread_cond_signal(&mbox->not_empty);
+    sys_mbox_count(&lwip_sys_mbox_stats.post);
+}
+
+static void *sys_mbox_pop(sys_mbox_t *mbox) {
+    void *msg = mbox->queue[mbox->head];
+    mbox->head = (mbox->head + 1) % mbox->size;
+    mbox->count -= 1;
+    pthread_cond_signal(&mbox->not_full);
+    sys_mbox_count(&lwip_sys_mbox_stats.fetch);
+    return msg;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_post
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Post the "msg" to the mailbox.
+ * Inputs:
+ *      sys_mbox_t mbox        -- Handle of mailbox
+ *      void *msg              -- Pointer to data to post
+ *---------------------------------------------------------------------------*/
+void sys_mbox_post(sys_mbox_t *mbox, void *msg) {
+    pthread_mutex_lock(&mbox->lock);
+    while (mbox->count == mbox->size) {
+        sys_mbox_count(&lwip_sys_mbox_stats.post_wait);
+        pthread_cond_wait(&mbox->not_full, &mbox->lock);
+    }
+    sys_mbox_push(mbox, msg);
+    pthread_mutex_unlock(&mbox->lock);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_mbox_trypost
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Try to post the "msg" to the mailbox.  Returns immediately with
+ *      error if cannot.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void *msg               -- Pointer to data to post
+ * Outputs:
+ *      err_t                   -- ERR_OK if message posted, else ERR_MEM
+ *                                  if not.
+ *---------------------------------------------------------------------------*/
+err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg) {
+    err_t err = ERR_MEM;
+
+    pthread_mutex_lock(&mbox->lock);
+    if (mbox->count < mbox->size) {
+        sys_mbox_push(mbox, msg);
+        err = ERR_OK;
+    } else {
+        sys_mbox_count(&lwip_sys_mbox_stats.post_full);
+    }
+    pthread_mutex_unlock(&mbox->lock);
+    return err;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_fetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Blocks the thread until a message arrives in the mailbox, but does
+ *      not block the thread longer than "timeout" milliseconds (similar to
+ *      the sys_arch_sem_wait() function).
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ *      u32_t timeout           -- Number of milliseconds until timeout
+ * Outputs:
+ *      u32_t                   -- SYS_ARCH_TIMEOUT if timeout, else number
+ *                                  of milliseconds until received.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
+    u32_t start = sys_now();
+    struct timespec deadline;
+    if (timeout != 0) {
+        sys_posix_deadline(&deadline, timeout);
+    }
+
+    pthread_mutex_lock(&mbox->lock);
+    while (mbox->count == 0) {
+        sys_mbox_count(&lwip_sys_mbox_stats.fetch_wait);
+        if (sys_posix_cond_wait(&mbox->not_empty, &mbox->lock,
+                (timeout != 0) ? &deadline : NULL) == ETIMEDOUT) {
+            pthread_mutex_unlock(&mbox->lock);
+            return SYS_ARCH_TIMEOUT;
+        }
+    }
+
+    void *value = sys_mbox_pop(mbox);
+    pthread_mutex_unlock(&mbox->lock);
+
+    if (msg) {
+        *msg = value;
+    }
+
+    return sys_now() - start;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_tryfetch
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Similar to sys_arch_mbox_fetch, but if message is not ready
+ *      immediately, we'll return with SYS_MBOX_EMPTY.  On success, 0 is
+ *      returned.
+ * Inputs:
+ *      sys_mbox_t mbox         -- Handle of mailbox
+ *      void **msg              -- Pointer to pointer to msg received
+ * Outputs:
+ *      u32_t                   -- SYS_MBOX_EMPTY if no messages.  Otherwise,
+ *                                  return ERR_OK.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg) {
+    pthread_mutex_lock(&mbox->lock);
+    if (mbox->count == 0) {
+        pthread_mutex_unlock(&mbox->lock);
+        return SYS_MBOX_EMPTY;
+    }
+
+    void *value = sys_mbox_pop(mbox);
+    pthread_mutex_unlock(&mbox->lock);
+
+    if (msg) {
+        *msg = value;
+    }
+
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_mbox_stats
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Snapshot of the mailbox counters
+ * Inputs:
+ *      sys_mbox_stats_t *stats -- Destination of the counters
+ *---------------------------------------------------------------------------*/
+void sys_arch_mbox_stats(sys_mbox_stats_t *stats) {
+    pthread_mutex_lock(&lwip_sys_mbox_stats_lock);
+    *stats = lwip_sys_mbox_stats;
+    pthread_mutex_unlock(&lwip_sys_mbox_stats_lock);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_sem_new
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Creates and returns a new semaphore. The "count" argument specifies
+ *      the initial state of the semaphore.
+ * Inputs:
+ *      sys_sem_t sem         -- Handle of semaphore
+ *      u8_t count            -- Initial count of semaphore
+ * Outputs:
+ *      err_t                 -- ERR_OK if semaphore created
+ *---------------------------------------------------------------------------*/
+err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
+    pthread_mutex_init(&sem->lock, NULL);
+    sys_posix_cond_init(&sem->cond);
+    sem->count = count;
+    sem->valid = 1;
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_sem_wait
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Blocks the thread while waiting for the semaphore to be
+ *      signaled. A timeout of zero waits forever.
+ * Inputs:
+ *      sys_sem_t sem           -- Semaphore to wait on
+ *      u32_t timeout           -- Number of milliseconds until timeout
+ * Outputs:
+ *      u32_t                   -- Time elapsed or SYS_ARCH_TIMEOUT.
+ *---------------------------------------------------------------------------*/
+u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout) {
+    u32_t start = sys_now();
+    struct timespec deadline;
+    if (timeout != 0) {
+        sys_posix_deadline(&deadline, timeout);
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (sys_posix_cond_wait(&sem->cond, &sem->lock,
+                (timeout != 0) ? &deadline : NULL) == ETIMEDOUT) {
+            pthread_mutex_unlock(&sem->lock);
+            return SYS_ARCH_TIMEOUT;
+        }
+    }
+    sem->count -= 1;
+    pthread_mutex_unlock(&sem->lock);
+
+    return sys_now() - start;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_sem_signal
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Signals (releases) a semaphore
+ * Inputs:
+ *      sys_sem_t sem           -- Semaphore to signal
+ *---------------------------------------------------------------------------*/
+void sys_sem_signal(sys_sem_t *sem) {
+    pthread_mutex_lock(&sem->lock);
+    sem->count += 1;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_sem_free
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Deallocates a semaphore
+ * Inputs:
+ *      sys_sem_t sem           -- Semaphore to free
+ *---------------------------------------------------------------------------*/
+void sys_sem_free(sys_sem_t *sem) {
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+}
+
+/** Create a new mutex
+ * @param mutex pointer to the mutex to create
+ * @return a new mutex */
+err_t sys_mutex_new(sys_mutex_t *mutex) {
+    // Recursive like the RTOS mutexes, the core lock may be retaken from
+    // socket callbacks
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    int err = pthread_mutex_init(&mutex->id, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (err != 0)
+        return ERR_MEM;
+
+    return ERR_OK;
+}
+
+/** Lock a mutex
+ * @param mutex the mutex to lock */
+void sys_mutex_lock(sys_mutex_t *mutex) {
+    if (pthread_mutex_lock(&mutex->id) != 0)
+        sys_posix_error("sys_mutex_lock error\n");
+}
+
+/** Unlock a mutex
+ * @param mutex the mutex to unlock */
+void sys_mutex_unlock(sys_mutex_t *mutex) {
+    if (pthread_mutex_unlock(&mutex->id) != 0)
+        sys_posix_error("sys_mutex_unlock error\n");
+}
+
+/** Delete a mutex
+ * @param mutex the mutex to delete */
+void sys_mutex_free(sys_mutex_t *mutex) {
+    pthread_mutex_destroy(&mutex->id);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_init
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Initialize sys arch
+ *---------------------------------------------------------------------------*/
+static pthread_mutex_t lwip_sys_mutex;
+
+void sys_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    if (pthread_mutex_init(&lwip_sys_mutex, &attr) != 0)
+        sys_posix_error("sys_init error\n");
+    pthread_mutexattr_destroy(&attr);
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_jiffies
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Used by PPP as a timestamp-ish value
+ *---------------------------------------------------------------------------*/
+u32_t sys_jiffies(void) {
+    return sys_now() / 10;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_protect
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Enters a critical region. Uses a recursive mutex as lwIP may nest
+ *      protected regions.
+ * Outputs:
+ *      sys_prot_t              -- Previous protection level (not used here)
+ *---------------------------------------------------------------------------*/
+sys_prot_t sys_arch_protect(void) {
+    if (pthread_mutex_lock(&lwip_sys_mutex) != 0)
+        sys_posix_error("sys_arch_protect error\n");
+    return (sys_prot_t) 1;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_arch_unprotect
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Leaves a critical region entered with sys_arch_protect.
+ * Inputs:
+ *      sys_prot_t              -- Previous protection level (not used here)
+ *---------------------------------------------------------------------------*/
+void sys_arch_unprotect(sys_prot_t p) {
+    LWIP_UNUSED_ARG(p);
+    if (pthread_mutex_unlock(&lwip_sys_mutex) != 0)
+        sys_posix_error("sys_arch_unprotect error\n");
+}
+
+u32_t sys_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void sys_msleep(u32_t ms) {
+    osDelay(ms);
+}
+
+void osDelay(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+struct sys_posix_thread {
+    void (*thread)(void *arg);
+    void *arg;
+};
+
+static void *sys_posix_thread_start(void *data) {
+    struct sys_posix_thread start = *(struct sys_posix_thread *)data;
+    free(data);
+
+    start.thread(start.arg);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*
+ * Routine:  sys_thread_new
+ *---------------------------------------------------------------------------*
+ * Description:
+ *      Starts a new thread that will begin its execution in the function
+ *      "thread()". The stack size and priority are left to the host, lwIP's
+ *      values are sized for microcontrollers.
+ * Inputs:
+ *      char *name                -- Name of thread
+ *      void (*thread)(void *arg) -- Pointer to function to run.
+ *      void *arg                 -- Argument passed into function
+ *      int stacksize             -- Required stack amount in bytes
+ *      int priority              -- Thread priority
+ * Outputs:
+ *      sys_thread_t              -- Thread handle.
+ *---------------------------------------------------------------------------*/
+sys_thread_t sys_thread_new(const char *pcName,
+                            void (*thread)(void *arg),
+                            void *arg, int stacksize, int priority) {
+    LWIP_UNUSED_ARG(pcName);
+    LWIP_UNUSED_ARG(stacksize);
+    LWIP_UNUSED_ARG(priority);
+    LWIP_DEBUGF(SYS_DEBUG, ("New Thread: %s\n", pcName));
+
+    struct sys_posix_thread *start = malloc(sizeof(struct sys_posix_thread));
+    if (start == NULL)
+        sys_posix_error("Error allocating the thread\n");
+    start->thread = thread;
+    start->arg = arg;
+
+    pthread_t t;
+    if (pthread_create(&t, NULL, sys_posix_thread_start, start) != 0)
+        sys_posix_error("sys_thread_new create error\n");
+
+    pthread_detach(t);
+    return t;
+}
+
+#endif /* LWIP_PLATFORM_POSIX && NO_SYS == 0 */
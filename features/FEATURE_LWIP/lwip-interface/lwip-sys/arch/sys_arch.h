@@ -23,6 +23,71 @@
 extern u8_t lwip_ram_heap[];
 
 #if NO_SYS == 0
+#if defined(LWIP_PLATFORM_POSIX)
+/* POSIX threads implementation, used to run the stack on a host */
+#include <pthread.h>
+
+// === SEMAPHORE ===
+typedef struct {
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    unsigned         count;
+    int              valid;
+} sys_sem_t;
+
+#define sys_sem_valid(x)        ((*x).valid)
+#define sys_sem_set_invalid(x)  ( (*x).valid = 0)
+
+// === MUTEX ===
+typedef struct {
+    pthread_mutex_t  id;
+} sys_mutex_t;
+
+// === MAIL BOX ===
+#ifndef MB_SIZE
+#define MB_SIZE      8
+#endif
+
+typedef struct {
+    pthread_mutex_t  lock;
+    pthread_cond_t   not_empty;
+    pthread_cond_t   not_full;
+    void            *queue[MB_SIZE];
+    unsigned         head;
+    unsigned         count;
+    unsigned         size;
+    int              valid;
+} sys_mbox_t;
+
+#define SYS_MBOX_NULL               NULL
+#define sys_mbox_valid(x)           ((*x).valid)
+#define sys_mbox_set_invalid(x)     ( (*x).valid = 0 )
+
+// === THREAD ===
+typedef pthread_t sys_thread_t;
+
+#define SYS_DEFAULT_THREAD_STACK_DEPTH      0
+
+// === PROTECTION ===
+typedef int sys_prot_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/** \brief  Delay for the specified number of milliSeconds
+ *
+ *  Provided so that code shared with the CMSIS-RTOS port can sleep.
+ *
+ *  \param[in]  ms Time in milliSeconds to delay
+ */
+void osDelay(uint32_t ms);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#else
 #include "cmsis_os.h"
 
 // === SEMAPHORE ===
@@ -51,8 +116,35 @@ typedef struct {
 } sys_mutex_t;
 
 // === MAIL BOX ===
+#ifndef MB_SIZE
 #define MB_SIZE      8
+#endif
+
+#if MBED_CONF_LWIP_MBOX_LOCKLESS
+#if (MB_SIZE) & ((MB_SIZE) - 1)
+#error MB_SIZE must be a power of two for the lockless mailbox
+#endif
+
+/* Ring buffer indexed by free running counters, only touched inside short
+ * critical sections. The semaphores are used only when a consumer finds the
+ * ring empty or a producer finds it full. */
+typedef struct {
+    void            *queue[MB_SIZE];
+    u32_t           post_idx;
+    u32_t           fetch_idx;
+    u32_t           size;
+    u8_t            post_waiters;
+    u8_t            fetch_waiters;
+    u8_t            valid;
+    sys_sem_t       not_empty;
+    sys_sem_t       not_full;
+} sys_mbox_t;
+
+#define SYS_MBOX_NULL               ((uint32_t) NULL)
+#define sys_mbox_valid(x)           ((*x).valid)
+#define sys_mbox_set_invalid(x)     ( (*x).valid = 0 )
 
+#else
 typedef struct {
     osMessageQId    id;
     osMessageQDef_t def;
@@ -64,6 +156,9 @@ typedef struct {
 #define SYS_MBOX_NULL               ((uint32_t) NULL)
 #define sys_mbox_valid(x)           (((*x).id == NULL) ? 0 : 1 )
 #define sys_mbox_set_invalid(x)     ( (*x).id = NULL )
+#endif
+
+#endif
 
 #if ((DEFAULT_RAW_RECVMBOX_SIZE) > (MB_SIZE)) || \
     ((DEFAULT_UDP_RECVMBOX_SIZE) > (MB_SIZE)) || \
@@ -73,6 +168,28 @@ typedef struct {
 #   error Mailbox size not supported
 #endif
 
+/* Mailbox counters across all mailboxes, kept by every mailbox
+ * implementation. post_full counts the messages refused by trypost. The
+ * waits count the handoffs that had to sleep, which only the lockless and
+ * host mailboxes can see, the queue mailbox leaves them at zero. */
+typedef struct {
+    u32_t           post;
+    u32_t           fetch;
+    u32_t           post_wait;
+    u32_t           post_full;
+    u32_t           fetch_wait;
+} sys_mbox_stats_t;
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+void sys_arch_mbox_stats(sys_mbox_stats_t *stats);
+#ifdef  __cplusplus
+}
+#endif
+
+#if !defined(LWIP_PLATFORM_POSIX)
+
 // === THREAD ===
 typedef struct {
     osThreadId    id;
@@ -86,6 +203,8 @@ typedef sys_thread_data_t* sys_thread_t;
 // === PROTECTION ===
 typedef int sys_prot_t;
 
+#endif
+
 #else
 #ifdef  __cplusplus
 extern "C" {
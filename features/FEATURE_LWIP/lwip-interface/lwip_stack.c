@@ -15,6 +15,7 @@
  */
 
 #include "nsapi.h"
+#include "nsapi_dns.h"
 #include "mbed_interface.h"
 #include <stdio.h>
 #include <stdbool.h>
@@ -27,22 +28,49 @@
 #include "lwip/netif.h"
 #include "lwip/dhcp.h"
 #include "lwip/tcpip.h"
+#include "lwip/priv/tcpip_priv.h"
 #include "lwip/tcp.h"
 #include "lwip/ip.h"
 #include "lwip/mld6.h"
 #include "lwip/dns.h"
 #include "lwip/udp.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
 
 #include "emac_api.h"
 
 #if DEVICE_EMAC
     #define MBED_NETIF_INIT_FN emac_lwip_if_init
+#if defined(LWIP_PLATFORM_POSIX)
+    #include "posix_emac.h"
+#endif
 #else
     #define MBED_NETIF_INIT_FN eth_arch_enetif_init
 #endif
 
 #define DHCP_TIMEOUT 15000
 
+/* Time to wait on close for zero-copy data to be acknowledged */
+#define NOCOPY_CLOSE_TIMEOUT 5000
+
+#ifdef MBED_CONF_LWIP_TCP_NOCOPY_MAX
+#define TCP_NOCOPY_MAX MBED_CONF_LWIP_TCP_NOCOPY_MAX
+#else
+#define TCP_NOCOPY_MAX 4
+#endif
+
+#ifdef MBED_CONF_LWIP_NETIF_MAX
+#define NETIF_COUNT MBED_CONF_LWIP_NETIF_MAX
+#else
+#define NETIF_COUNT 1
+#endif
+
+#ifdef MBED_CONF_LWIP_ROUTE_MAX
+#define ROUTE_COUNT MBED_CONF_LWIP_ROUTE_MAX
+#else
+#define ROUTE_COUNT 4
+#endif
+
 /* Static arena of sockets */
 static struct lwip_socket {
     bool in_use;
@@ -53,9 +81,27 @@ static struct lwip_socket {
 
     void (*cb)(void *);
     void *data;
-} lwip_arena[MEMP_NUM_NETCONN];
 
-static bool lwip_connected = false;
+    /* interface the socket was opened on, or null to follow the routes */
+    struct mbed_lwip_netif *netif;
+
+    /* TCP options, kept so accepted connections inherit them */
+    bool nodelay;
+    tcpwnd_size_t sndbuf;
+
+    /* zero-copy sends waiting to be acknowledged, oldest first */
+    struct lwip_nocopy {
+        u32_t end;
+        void (*cb)(void *);
+        void *context;
+    } nocopy[TCP_NOCOPY_MAX];
+    u8_t nocopy_head;
+    u8_t nocopy_count;
+
+    /* signalled when the last zero-copy send completes while closing */
+    bool nocopy_waiting;
+    sys_sem_t nocopy_done;
+} lwip_arena[MEMP_NUM_NETCONN];
 
 static void mbed_lwip_arena_init(void)
 {
@@ -85,26 +131,179 @@ static void mbed_lwip_arena_dealloc(struct lwip_socket *s)
     s->in_use = false;
 }
 
+/* Resize the send buffer of a TCP pcb. The data already queued stays
+ * accounted for, so the buffer can only shrink by its free space.
+ * Called in the stack's context. */
+static bool mbed_lwip_tcp_resize_sndbuf(struct tcp_pcb *pcb, tcpwnd_size_t from, tcpwnd_size_t to)
+{
+    if (to < from && pcb->snd_buf < from - to) {
+        return false;
+    }
+
+    pcb->snd_buf = pcb->snd_buf - from + to;
+    return true;
+}
+
+/* Complete the zero-copy sends that have been acknowledged, or all of
+ * them once the pcb is gone. Only called from the tcpip thread. */
+static void mbed_lwip_nocopy_check(struct lwip_socket *s)
+{
+    while (true) {
+        struct lwip_nocopy done = {0};
+        bool popped = false;
+
+        sys_prot_t prot = sys_arch_protect();
+        if (s->in_use && s->nocopy_count) {
+            struct tcp_pcb *pcb = s->conn->pcb.tcp;
+            struct lwip_nocopy *n = &s->nocopy[s->nocopy_head];
+
+            if (!pcb || (s32_t)(pcb->lastack - n->end) >= 0) {
+                done = *n;
+                popped = true;
+                s->nocopy_head = (s->nocopy_head + 1) % TCP_NOCOPY_MAX;
+                s->nocopy_count--;
+
+                if (!s->nocopy_count && s->nocopy_waiting) {
+                    sys_sem_signal(&s->nocopy_done);
+                }
+            }
+        }
+        sys_arch_unprotect(prot);
+
+        if (!popped) {
+            return;
+        }
+
+        if (done.cb) {
+            done.cb(done.context);
+        }
+    }
+}
+
+static void mbed_lwip_nocopy_poll(void *arg)
+{
+    mbed_lwip_nocopy_check((struct lwip_socket *)arg);
+}
+
+/* Reads the end of a TCP connection's send stream in the stack's context */
+struct mbed_lwip_snd_lbb_call {
+    struct tcpip_api_call_data call;    // first, so the call maps back
+    struct netconn *conn;
+    u32_t snd_lbb;
+};
+
+static err_t mbed_lwip_get_snd_lbb(struct tcpip_api_call_data *arg)
+{
+    struct mbed_lwip_snd_lbb_call *call = (struct mbed_lwip_snd_lbb_call *)arg;
+
+    if (!call->conn->pcb.tcp) {
+        return ERR_CONN;
+    }
+
+    call->snd_lbb = call->conn->pcb.tcp->snd_lbb;
+    return ERR_OK;
+}
+
+static void mbed_lwip_nocopy_abort(void *arg)
+{
+    struct lwip_socket *s = (struct lwip_socket *)arg;
+
+    if (s->conn->pcb.tcp) {
+        tcp_abort(s->conn->pcb.tcp);
+    }
+}
+
+/* Runs fn in the stack's context. With core locking the calling thread
+ * takes the core lock and runs it directly, rather than waking tcpip_thread */
+static void mbed_lwip_core_call(tcpip_callback_fn fn, void *ctx)
+{
+#if LWIP_TCPIP_CORE_LOCKING
+    LOCK_TCPIP_CORE();
+    fn(ctx);
+    UNLOCK_TCPIP_CORE();
+#else
+    tcpip_callback(fn, ctx);
+#endif
+}
+
+/* Runs fn in the stack's context and waits for its result. With core
+ * locking the calling thread runs it under the core lock, otherwise
+ * tcpip_thread runs it while the caller waits */
+struct mbed_lwip_core_sync_call {
+    struct tcpip_api_call_data call;    // first, so the call maps back
+    err_t (*fn)(void *ctx);
+    void *ctx;
+};
+
+static err_t mbed_lwip_core_sync_run(struct tcpip_api_call_data *arg)
+{
+    struct mbed_lwip_core_sync_call *call = (struct mbed_lwip_core_sync_call *)arg;
+    return call->fn(call->ctx);
+}
+
+static err_t mbed_lwip_core_sync(err_t (*fn)(void *ctx), void *ctx)
+{
+    struct mbed_lwip_core_sync_call call;
+    call.fn = fn;
+    call.ctx = ctx;
+    return tcpip_api_call(mbed_lwip_core_sync_run, &call.call);
+}
+
 static void mbed_lwip_socket_callback(struct netconn *nc, enum netconn_evt eh, u16_t len)
 {
+    struct lwip_socket *nocopy = 0;
     sys_prot_t prot = sys_arch_protect();
 
     for (int i = 0; i < MEMP_NUM_NETCONN; i++) {
         if (lwip_arena[i].in_use
-            && lwip_arena[i].conn == nc
-            && lwip_arena[i].cb) {
-            lwip_arena[i].cb(lwip_arena[i].data);
+            && lwip_arena[i].conn == nc) {
+            if (lwip_arena[i].cb) {
+                lwip_arena[i].cb(lwip_arena[i].data);
+            }
+
+            if ((eh == NETCONN_EVT_SENDPLUS || eh == NETCONN_EVT_ERROR)
+                && lwip_arena[i].nocopy_count) {
+                nocopy = &lwip_arena[i];
+            }
         }
     }
 
     sys_arch_unprotect(prot);
+
+    if (nocopy) {
+        mbed_lwip_nocopy_check(nocopy);
+    }
 }
 
 
 /* TCP/IP and Network Interface Initialisation */
-static struct netif lwip_netif;
-static bool lwip_dhcp = false;
-static char lwip_mac_address[NSAPI_MAC_SIZE];
+/* Network interfaces, the first is the one set up by mbed_lwip_init */
+static struct mbed_lwip_netif {
+    struct netif netif;     // first, so lwIP's netif pointers map back
+    bool in_use;
+    bool connected;
+    bool dhcp;
+    bool any_addr;
+    sys_sem_t linked;
+    sys_sem_t has_addr;
+    char mac_address[NSAPI_MAC_SIZE];
+
+    /* view of the stack that keeps sockets on this interface */
+    nsapi_stack_t stack;
+} lwip_netifs[NETIF_COUNT];
+
+#if LWIP_IPV4 && LWIP_IPV4_SRC_ROUTING
+/* Static IPv4 routes, for destinations outside the connected networks */
+static struct mbed_lwip_route {
+    bool in_use;
+    u8_t netif;
+    u8_t metric;
+    ip4_addr_t dest;
+    ip4_addr_t netmask;
+} lwip_routes[ROUTE_COUNT];
+#endif
+
+static bool lwip_inited = false;
 
 #if !LWIP_IPV4 || !LWIP_IPV6
 static bool all_zeros(const uint8_t *p, int len)
@@ -252,15 +451,16 @@ void add_dns_addr(struct netif *lwip_netif)
     }
 
     // Check for existing dns server
+    bool has_dns = false;
     for (char numdns = 0; numdns < DNS_MAX_SERVERS; numdns++) {
         const ip_addr_t *dns_ip_addr = dns_getserver(numdns);
         if (!ip_addr_isany(dns_ip_addr)) {
-            return;
+            has_dns = true;
         }
     }
 
 #if LWIP_IPV6
-    if (IP_IS_V6(ip_addr)) {
+    if (!has_dns && IP_IS_V6(ip_addr)) {
         /* 2001:4860:4860::8888 google */
         ip_addr_t ipv6_dns_addr = IPADDR6_INIT(
                 PP_HTONL(0x20014860UL),
@@ -272,12 +472,22 @@ void add_dns_addr(struct netif *lwip_netif)
 #endif
 
 #if LWIP_IPV4
-    if (IP_IS_V4(ip_addr)) {
+    if (!has_dns && IP_IS_V4(ip_addr)) {
         /* 8.8.8.8 google */
         ip_addr_t ipv4_dns_addr = IPADDR4_INIT(0x08080808);
         dns_setserver(0, &ipv4_dns_addr);
     }
 #endif
+
+    // gethostbyname goes through the nsapi resolver, so hand it the
+    // servers, including those from DHCP, last first to keep their order
+    for (int numdns = DNS_MAX_SERVERS-1; numdns >= 0; numdns--) {
+        const ip_addr_t *dns_ip_addr = dns_getserver(numdns);
+        nsapi_addr_t dns_addr;
+        if (!ip_addr_isany(dns_ip_addr) && convert_lwip_addr_to_mbed(&dns_addr, dns_ip_addr)) {
+            nsapi_dns_add_server(dns_addr);
+        }
+    }
 }
 
 static sys_sem_t lwip_tcpip_inited;
@@ -286,59 +496,193 @@ static void mbed_lwip_tcpip_init_irq(void *eh)
     sys_sem_signal(&lwip_tcpip_inited);
 }
 
-static sys_sem_t lwip_netif_linked;
+/* Keep the default interface on one that can carry traffic, so unrouted
+ * traffic fails over when an interface goes down. Called with the core
+ * lock held. */
+static void mbed_lwip_update_default(void)
+{
+    if (netif_default && netif_is_up(netif_default) && netif_is_link_up(netif_default)) {
+        return;
+    }
+
+    for (int i = 0; i < NETIF_COUNT; i++) {
+        struct netif *netif = &lwip_netifs[i].netif;
+        if (lwip_netifs[i].in_use && netif_is_up(netif) && netif_is_link_up(netif)) {
+            netif_set_default(netif);
+            return;
+        }
+    }
+}
+
 static void mbed_lwip_netif_link_irq(struct netif *lwip_netif)
 {
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)lwip_netif;
+
     if (netif_is_link_up(lwip_netif)) {
-        sys_sem_signal(&lwip_netif_linked);
+        sys_sem_signal(&n->linked);
     }
+
+    mbed_lwip_update_default();
 }
 
-static sys_sem_t lwip_netif_has_addr;
 static void mbed_lwip_netif_status_irq(struct netif *lwip_netif)
 {
-    static bool any_addr = true;
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)lwip_netif;
+
+    mbed_lwip_update_default();
 
     if (netif_is_up(lwip_netif)) {
         // Indicates that has address
-        if (any_addr == true && mbed_lwip_get_ip_addr(true, lwip_netif)) {
-            sys_sem_signal(&lwip_netif_has_addr);
-            any_addr = false;
+        if (n->any_addr == true && mbed_lwip_get_ip_addr(true, lwip_netif)) {
+            sys_sem_signal(&n->has_addr);
+            n->any_addr = false;
             return;
         }
 
         // Indicates that has preferred address
         if (mbed_lwip_get_ip_addr(false, lwip_netif)) {
-            sys_sem_signal(&lwip_netif_has_addr);
+            sys_sem_signal(&n->has_addr);
         }
     } else {
-        any_addr = true;
+        n->any_addr = true;
     }
 }
 
-static void mbed_lwip_set_mac_address(void)
+static void mbed_lwip_set_mac_address(char *mac_address)
 {
 #if (MBED_MAC_ADDRESS_SUM != MBED_MAC_ADDR_INTERFACE)
-    snprintf(lwip_mac_address, NSAPI_MAC_SIZE, "%02x:%02x:%02x:%02x:%02x:%02x",
+    snprintf(mac_address, NSAPI_MAC_SIZE, "%02x:%02x:%02x:%02x:%02x:%02x",
             MBED_MAC_ADDR_0, MBED_MAC_ADDR_1, MBED_MAC_ADDR_2,
             MBED_MAC_ADDR_3, MBED_MAC_ADDR_4, MBED_MAC_ADDR_5);
 #else
     char mac[6];
     mbed_mac_address(mac);
-    snprintf(lwip_mac_address, NSAPI_MAC_SIZE, "%02x:%02x:%02x:%02x:%02x:%02x",
+    snprintf(mac_address, NSAPI_MAC_SIZE, "%02x:%02x:%02x:%02x:%02x:%02x",
             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 #endif
 }
 
+static struct mbed_lwip_netif *mbed_lwip_get_netif(int id)
+{
+    if (id < 0 || id >= NETIF_COUNT || !lwip_netifs[id].in_use) {
+        return NULL;
+    }
+
+    return &lwip_netifs[id];
+}
+
+static bool mbed_lwip_connected(void)
+{
+    for (int i = 0; i < NETIF_COUNT; i++) {
+        if (lwip_netifs[i].connected) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* The interface a stack sends through, either the one behind a
+ * per-interface view or the current default */
+static struct netif *mbed_lwip_stack_netif(nsapi_stack_t *stack)
+{
+    struct mbed_lwip_netif *n = stack ? (struct mbed_lwip_netif *)stack->stack : NULL;
+    if (n) {
+        return &n->netif;
+    }
+
+    return netif_default ? netif_default : &lwip_netifs[0].netif;
+}
+
+static nsapi_error_t mbed_lwip_core_init(void)
+{
+    if (!lwip_inited) {
+        sys_sem_new(&lwip_tcpip_inited, 0);
+
+        tcpip_init(mbed_lwip_tcpip_init_irq, NULL);
+        sys_arch_sem_wait(&lwip_tcpip_inited, 0);
+
+        lwip_inited = true;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+struct mbed_lwip_netif_add_args {
+    struct mbed_lwip_netif *n;
+    void *state;
+    netif_init_fn init;
+};
+
+static err_t mbed_lwip_netif_add(void *arg)
+{
+    struct mbed_lwip_netif_add_args *args = (struct mbed_lwip_netif_add_args *)arg;
+    struct mbed_lwip_netif *n = args->n;
+
+    if (!netif_add(&n->netif,
+#if LWIP_IPV4
+            0, 0, 0,
+#endif
+            args->state, args->init, tcpip_input)) {
+        return ERR_IF;
+    }
+
+    if (!netif_default) {
+        netif_set_default(&n->netif);
+    }
+
+    netif_set_link_callback(&n->netif, mbed_lwip_netif_link_irq);
+    netif_set_status_callback(&n->netif, mbed_lwip_netif_status_irq);
+    return ERR_OK;
+}
+
+static nsapi_error_t mbed_lwip_netif_init(int id, void *state, netif_init_fn init)
+{
+    struct mbed_lwip_netif *n = &lwip_netifs[id];
+
+    mbed_lwip_core_init();
+
+    memset(n, 0, sizeof *n);
+    n->any_addr = true;
+    sys_sem_new(&n->linked, 0);
+    sys_sem_new(&n->has_addr, 0);
+
+    // tcpip_thread is already running, netif calls run in its context
+    struct mbed_lwip_netif_add_args args = {n, state, init};
+    if (mbed_lwip_core_sync(mbed_lwip_netif_add, &args) != ERR_OK) {
+        sys_sem_free(&n->linked);
+        sys_sem_free(&n->has_addr);
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+
+    n->in_use = true;
+    return NSAPI_ERROR_OK;
+}
+
 /* LWIP interface implementation */
+const char *mbed_lwip_get_netif_mac_address(int id)
+{
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NULL;
+    }
+
+    return n->mac_address[0] ? n->mac_address : 0;
+}
+
 const char *mbed_lwip_get_mac_address(void)
 {
-    return lwip_mac_address[0] ? lwip_mac_address : 0;
+    return mbed_lwip_get_netif_mac_address(0);
 }
 
-char *mbed_lwip_get_ip_address(char *buf, nsapi_size_t buflen)
+char *mbed_lwip_get_netif_ip_address(int id, char *buf, nsapi_size_t buflen)
 {
-    const ip_addr_t *addr = mbed_lwip_get_ip_addr(true, &lwip_netif);
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NULL;
+    }
+
+    const ip_addr_t *addr = mbed_lwip_get_ip_addr(true, &n->netif);
     if (!addr) {
         return NULL;
     }
@@ -355,10 +699,20 @@ char *mbed_lwip_get_ip_address(char *buf, nsapi_size_t buflen)
     return NULL;
 }
 
-const char *mbed_lwip_get_netmask(char *buf, nsapi_size_t buflen)
+char *mbed_lwip_get_ip_address(char *buf, nsapi_size_t buflen)
+{
+    return mbed_lwip_get_netif_ip_address(0, buf, buflen);
+}
+
+char *mbed_lwip_get_netif_netmask(int id, char *buf, nsapi_size_t buflen)
 {
 #if LWIP_IPV4
-    const ip4_addr_t *addr = netif_ip4_netmask(&lwip_netif);
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NULL;
+    }
+
+    const ip4_addr_t *addr = netif_ip4_netmask(&n->netif);
     if (!ip4_addr_isany(addr)) {
         return ip4addr_ntoa_r(addr, buf, buflen);
     } else {
@@ -369,10 +723,20 @@ const char *mbed_lwip_get_netmask(char *buf, nsapi_size_t buflen)
 #endif
 }
 
-char *mbed_lwip_get_gateway(char *buf, nsapi_size_t buflen)
+char *mbed_lwip_get_netmask(char *buf, nsapi_size_t buflen)
+{
+    return mbed_lwip_get_netif_netmask(0, buf, buflen);
+}
+
+char *mbed_lwip_get_netif_gateway(int id, char *buf, nsapi_size_t buflen)
 {
 #if LWIP_IPV4
-    const ip4_addr_t *addr = netif_ip4_gw(&lwip_netif);
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NULL;
+    }
+
+    const ip4_addr_t *addr = netif_ip4_gw(&n->netif);
     if (!ip4_addr_isany(addr)) {
         return ip4addr_ntoa_r(addr, buf, buflen);
     } else {
@@ -383,33 +747,32 @@ char *mbed_lwip_get_gateway(char *buf, nsapi_size_t buflen)
 #endif
 }
 
+char *mbed_lwip_get_gateway(char *buf, nsapi_size_t buflen)
+{
+    return mbed_lwip_get_netif_gateway(0, buf, buflen);
+}
+
 nsapi_error_t mbed_lwip_init(emac_interface_t *emac)
 {
     // Check if we've already brought up lwip
-    if (!mbed_lwip_get_mac_address()) {
-        // Set up network
-        mbed_lwip_set_mac_address();
-
-        sys_sem_new(&lwip_tcpip_inited, 0);
-        sys_sem_new(&lwip_netif_linked, 0);
-        sys_sem_new(&lwip_netif_has_addr, 0);
-
-        tcpip_init(mbed_lwip_tcpip_init_irq, NULL);
-        sys_arch_sem_wait(&lwip_tcpip_inited, 0);
-
-        memset(&lwip_netif, 0, sizeof lwip_netif);
-        if (!netif_add(&lwip_netif,
-#if LWIP_IPV4
-                0, 0, 0,
-#endif
-                emac, MBED_NETIF_INIT_FN, tcpip_input)) {
-            return NSAPI_ERROR_DEVICE_ERROR;
+    if (!lwip_netifs[0].in_use) {
+#if DEVICE_EMAC && defined(LWIP_PLATFORM_POSIX)
+        // Host builds have no board Emac, use the TAP device by default
+        if (!emac) {
+            emac = posix_emac_tap(NULL);
+            if (!emac) {
+                return NSAPI_ERROR_DEVICE_ERROR;
+            }
         }
+#endif
 
-        netif_set_default(&lwip_netif);
+        // Set up network
+        nsapi_error_t err = mbed_lwip_netif_init(0, emac, MBED_NETIF_INIT_FN);
+        if (err) {
+            return err;
+        }
 
-        netif_set_link_callback(&lwip_netif, mbed_lwip_netif_link_irq);
-        netif_set_status_callback(&lwip_netif, mbed_lwip_netif_status_irq);
+        mbed_lwip_set_mac_address(lwip_netifs[0].mac_address);
 
 #if !DEVICE_EMAC
         eth_arch_enable_interrupts();
@@ -419,46 +782,119 @@ nsapi_error_t mbed_lwip_init(emac_interface_t *emac)
     return NSAPI_ERROR_OK;
 }
 
-nsapi_error_t mbed_lwip_bringup(bool dhcp, const char *ip, const char *netmask, const char *gw)
+nsapi_error_t mbed_lwip_add_netif(void *state, netif_init_fn init, int *id)
 {
-    // Check if we've already connected
-    if (lwip_connected) {
-        return NSAPI_ERROR_PARAMETER;
-    }
+    // The first interface is reserved for mbed_lwip_init
+    for (int i = 1; i < NETIF_COUNT; i++) {
+        if (!lwip_netifs[i].in_use) {
+            nsapi_error_t err = mbed_lwip_netif_init(i, state, init);
+            if (err) {
+                return err;
+            }
 
-    if(mbed_lwip_init(NULL) != NSAPI_ERROR_OK) {
-        return NSAPI_ERROR_DEVICE_ERROR;
+            struct netif *netif = &lwip_netifs[i].netif;
+            if (netif->hwaddr_len == 6) {
+                snprintf(lwip_netifs[i].mac_address, NSAPI_MAC_SIZE, "%02x:%02x:%02x:%02x:%02x:%02x",
+                        netif->hwaddr[0], netif->hwaddr[1], netif->hwaddr[2],
+                        netif->hwaddr[3], netif->hwaddr[4], netif->hwaddr[5]);
+            }
+
+            *id = i;
+            return NSAPI_ERROR_OK;
+        }
     }
 
-    // Zero out socket set
-    mbed_lwip_arena_init();
+    return NSAPI_ERROR_NO_MEMORY;
+}
 
 #if LWIP_IPV6
-    netif_create_ip6_linklocal_address(&lwip_netif, 1/*from MAC*/);
+static err_t mbed_lwip_netif_ip6_start(void *arg)
+{
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)arg;
+
+    netif_create_ip6_linklocal_address(&n->netif, 1/*from MAC*/);
 #if LWIP_IPV6_MLD
   /*
    * For hardware/netifs that implement MAC filtering.
    * All-nodes link-local is handled by default, so we must let the hardware know
    * to allow multicast packets in.
    * Should set mld_mac_filter previously. */
-  if (lwip_netif.mld_mac_filter != NULL) {
+  if (n->netif.mld_mac_filter != NULL) {
     ip6_addr_t ip6_allnodes_ll;
     ip6_addr_set_allnodes_linklocal(&ip6_allnodes_ll);
-    lwip_netif.mld_mac_filter(&lwip_netif, &ip6_allnodes_ll, MLD6_ADD_MAC_FILTER);
+    n->netif.mld_mac_filter(&n->netif, &ip6_allnodes_ll, MLD6_ADD_MAC_FILTER);
   }
 #endif /* LWIP_IPV6_MLD */
 
 #if LWIP_IPV6_AUTOCONFIG
     /* IPv6 address autoconfiguration not enabled by default */
-  lwip_netif.ip6_autoconfig_enabled = 1;
+  n->netif.ip6_autoconfig_enabled = 1;
 #endif /* LWIP_IPV6_AUTOCONFIG */
+    return ERR_OK;
+}
+#endif
+
+#if LWIP_IPV4
+struct mbed_lwip_netif_addr_args {
+    struct mbed_lwip_netif *n;
+    ip4_addr_t ip;
+    ip4_addr_t netmask;
+    ip4_addr_t gw;
+};
+
+static err_t mbed_lwip_netif_set_addr(void *arg)
+{
+    struct mbed_lwip_netif_addr_args *args = (struct mbed_lwip_netif_addr_args *)arg;
+
+    netif_set_addr(&args->n->netif, &args->ip, &args->netmask, &args->gw);
+    return ERR_OK;
+}
+#endif
+
+static err_t mbed_lwip_netif_up(void *arg)
+{
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)arg;
+
+    netif_set_up(&n->netif);
+
+#if LWIP_IPV4
+    // Connect to the network
+    if (n->dhcp) {
+        return dhcp_start(&n->netif);
+    }
+#endif
+    return ERR_OK;
+}
+
+nsapi_error_t mbed_lwip_bringup_netif(int id, bool dhcp, const char *ip, const char *netmask, const char *gw)
+{
+    if (id == 0 && mbed_lwip_init(NULL) != NSAPI_ERROR_OK) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // Check if we've already connected
+    if (n->connected) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // Zero out socket set, unless another interface is carrying sockets
+    if (!mbed_lwip_connected()) {
+        mbed_lwip_arena_init();
+    }
 
+#if LWIP_IPV6
+    mbed_lwip_core_sync(mbed_lwip_netif_ip6_start, n);
 #endif
 
     u32_t ret;
 
-    if (!netif_is_link_up(&lwip_netif)) {
-        ret = sys_arch_sem_wait(&lwip_netif_linked, 15000);
+    if (!netif_is_link_up(&n->netif)) {
+        ret = sys_arch_sem_wait(&n->linked, 15000);
 
         if (ret == SYS_ARCH_TIMEOUT) {
             return NSAPI_ERROR_NO_CONNECTION;
@@ -467,37 +903,28 @@ nsapi_error_t mbed_lwip_bringup(bool dhcp, const char *ip, const char *netmask,
 
 #if LWIP_IPV4
     if (!dhcp) {
-        ip4_addr_t ip_addr;
-        ip4_addr_t netmask_addr;
-        ip4_addr_t gw_addr;
+        struct mbed_lwip_netif_addr_args args;
+        args.n = n;
 
-        if (!inet_aton(ip, &ip_addr) ||
-            !inet_aton(netmask, &netmask_addr) ||
-            !inet_aton(gw, &gw_addr)) {
+        if (!inet_aton(ip, &args.ip) ||
+            !inet_aton(netmask, &args.netmask) ||
+            !inet_aton(gw, &args.gw)) {
             return NSAPI_ERROR_PARAMETER;
         }
 
-        netif_set_addr(&lwip_netif, &ip_addr, &netmask_addr, &gw_addr);
+        mbed_lwip_core_sync(mbed_lwip_netif_set_addr, &args);
     }
-#endif
-
-    netif_set_up(&lwip_netif);
 
-#if LWIP_IPV4
-    // Connect to the network
-    lwip_dhcp = dhcp;
+    n->dhcp = dhcp;
+#endif
 
-    if (lwip_dhcp) {
-        err_t err = dhcp_start(&lwip_netif);
-        if (err) {
-            return NSAPI_ERROR_DHCP_FAILURE;
-        }
+    if (mbed_lwip_core_sync(mbed_lwip_netif_up, n) != ERR_OK) {
+        return NSAPI_ERROR_DHCP_FAILURE;
     }
-#endif
 
     // If doesn't have address
-    if (!mbed_lwip_get_ip_addr(true, &lwip_netif)) {
-        ret = sys_arch_sem_wait(&lwip_netif_has_addr, 15000);
+    if (!mbed_lwip_get_ip_addr(true, &n->netif)) {
+        ret = sys_arch_sem_wait(&n->has_addr, 15000);
         if (ret == SYS_ARCH_TIMEOUT) {
             return NSAPI_ERROR_DHCP_FAILURE;
         }
@@ -506,17 +933,22 @@ nsapi_error_t mbed_lwip_bringup(bool dhcp, const char *ip, const char *netmask,
 #if ADDR_TIMEOUT
     // If address is not for preferred stack waits a while to see
     // if preferred stack address is acquired
-    if (!mbed_lwip_get_ip_addr(false, &lwip_netif)) {
-        ret = sys_arch_sem_wait(&lwip_netif_has_addr, ADDR_TIMEOUT * 1000);
+    if (!mbed_lwip_get_ip_addr(false, &n->netif)) {
+        ret = sys_arch_sem_wait(&n->has_addr, ADDR_TIMEOUT * 1000);
     }
 #endif
 
-    add_dns_addr(&lwip_netif);
+    add_dns_addr(&n->netif);
 
-    lwip_connected = true;
+    n->connected = true;
     return 0;
 }
 
+nsapi_error_t mbed_lwip_bringup(bool dhcp, const char *ip, const char *netmask, const char *gw)
+{
+    return mbed_lwip_bringup_netif(0, dhcp, ip, netmask, gw);
+}
+
 #if LWIP_IPV6
 void mbed_lwip_clear_ipv6_addresses(struct netif *lwip_netif)
 {
@@ -526,39 +958,198 @@ void mbed_lwip_clear_ipv6_addresses(struct netif *lwip_netif)
 }
 #endif
 
-nsapi_error_t mbed_lwip_bringdown(void)
+static err_t mbed_lwip_netif_down(void *arg)
 {
-    // Check if we've connected
-    if (!lwip_connected) {
-        return NSAPI_ERROR_PARAMETER;
-    }
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)arg;
 
 #if LWIP_IPV4
     // Disconnect from the network
-    if (lwip_dhcp) {
-        dhcp_release(&lwip_netif);
-        dhcp_stop(&lwip_netif);
-        lwip_dhcp = false;
+    if (n->dhcp) {
+        dhcp_release(&n->netif);
+        dhcp_stop(&n->netif);
+        n->dhcp = false;
     }
 #endif
 
-    netif_set_down(&lwip_netif);
+    netif_set_down(&n->netif);
 
 #if LWIP_IPV6
-    mbed_lwip_clear_ipv6_addresses(&lwip_netif);
+    mbed_lwip_clear_ipv6_addresses(&n->netif);
 #endif
+    return ERR_OK;
+}
+
+nsapi_error_t mbed_lwip_bringdown_netif(int id)
+{
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+
+    // Check if we've connected
+    if (!n || !n->connected) {
+        return NSAPI_ERROR_PARAMETER;
+    }
 
-    sys_sem_free(&lwip_netif_has_addr);
-    sys_sem_new(&lwip_netif_has_addr, 0);
-    lwip_connected = false;
+    mbed_lwip_core_sync(mbed_lwip_netif_down, n);
+
+    sys_sem_free(&n->has_addr);
+    sys_sem_new(&n->has_addr, 0);
+    n->connected = false;
     return 0;
 }
 
-/* LWIP error remapping */
-static nsapi_error_t mbed_lwip_err_remap(err_t err) {
-    switch (err) {
-        case ERR_OK:
-        case ERR_CLSD:
+nsapi_error_t mbed_lwip_bringdown(void)
+{
+    return mbed_lwip_bringdown_netif(0);
+}
+
+#if LWIP_IPV4 && LWIP_IPV4_SRC_ROUTING
+/* Routing hook, installed as LWIP_HOOK_IP4_ROUTE_SRC. Called in the
+ * stack's context, as are the route table updates. */
+struct netif *mbed_lwip_route_hook(const ip4_addr_t *dest, const ip4_addr_t *src)
+{
+    // Sockets on a per-interface stack are bound to its address, keep
+    // their traffic on that interface
+    if (src) {
+        if (ip4_addr_isany(src)) {
+            return NULL;
+        }
+
+        for (int i = 0; i < NETIF_COUNT; i++) {
+            struct netif *netif = &lwip_netifs[i].netif;
+            if (lwip_netifs[i].in_use && netif_is_up(netif) &&
+                ip4_addr_cmp(src, netif_ip4_addr(netif))) {
+                return netif;
+            }
+        }
+
+        return NULL;
+    }
+
+    // No directly connected network matched, pick the longest matching
+    // route with the lowest metric on an interface that is up
+    struct mbed_lwip_route *best = NULL;
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        struct mbed_lwip_route *r = &lwip_routes[i];
+        if (!r->in_use || !ip4_addr_netcmp(dest, &r->dest, &r->netmask)) {
+            continue;
+        }
+
+        struct netif *netif = &lwip_netifs[r->netif].netif;
+        if (!netif_is_up(netif) || !netif_is_link_up(netif) ||
+            ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+            continue;
+        }
+
+        if (!best ||
+            lwip_ntohl(ip4_addr_get_u32(&r->netmask)) > lwip_ntohl(ip4_addr_get_u32(&best->netmask)) ||
+            (ip4_addr_cmp(&r->netmask, &best->netmask) && r->metric < best->metric)) {
+            best = r;
+        }
+    }
+
+    return best ? &lwip_netifs[best->netif].netif : NULL;
+}
+
+struct mbed_lwip_route_args {
+    ip4_addr_t dest;
+    ip4_addr_t netmask;
+    int id;
+    uint8_t metric;
+    nsapi_error_t err;
+};
+
+static err_t mbed_lwip_route_add(void *arg)
+{
+    struct mbed_lwip_route_args *args = (struct mbed_lwip_route_args *)arg;
+
+    args->err = NSAPI_ERROR_NO_MEMORY;
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        struct mbed_lwip_route *r = &lwip_routes[i];
+        if (!r->in_use) {
+            ip4_addr_copy(r->dest, args->dest);
+            ip4_addr_copy(r->netmask, args->netmask);
+            r->netif = (u8_t)args->id;
+            r->metric = args->metric;
+            r->in_use = true;
+            args->err = NSAPI_ERROR_OK;
+            break;
+        }
+    }
+
+    return ERR_OK;
+}
+
+static err_t mbed_lwip_route_remove(void *arg)
+{
+    struct mbed_lwip_route_args *args = (struct mbed_lwip_route_args *)arg;
+
+    args->err = NSAPI_ERROR_PARAMETER;
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        struct mbed_lwip_route *r = &lwip_routes[i];
+        if (r->in_use && r->netif == args->id &&
+            ip4_addr_cmp(&r->dest, &args->dest) &&
+            ip4_addr_cmp(&r->netmask, &args->netmask)) {
+            r->in_use = false;
+            args->err = NSAPI_ERROR_OK;
+        }
+    }
+
+    return ERR_OK;
+}
+#endif
+
+nsapi_error_t mbed_lwip_add_route(const char *dest, const char *netmask, int id, uint8_t metric)
+{
+#if LWIP_IPV4 && LWIP_IPV4_SRC_ROUTING
+    struct mbed_lwip_route_args args;
+
+    if (!mbed_lwip_get_netif(id) ||
+        !inet_aton(dest, &args.dest) ||
+        !inet_aton(netmask, &args.netmask)) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    ip4_addr_set_u32(&args.dest, ip4_addr_get_u32(&args.dest) & ip4_addr_get_u32(&args.netmask));
+    args.id = id;
+    args.metric = metric;
+
+    if (mbed_lwip_core_sync(mbed_lwip_route_add, &args) != ERR_OK) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    return args.err;
+#else
+    return NSAPI_ERROR_UNSUPPORTED;
+#endif
+}
+
+nsapi_error_t mbed_lwip_remove_route(const char *dest, const char *netmask, int id)
+{
+#if LWIP_IPV4 && LWIP_IPV4_SRC_ROUTING
+    struct mbed_lwip_route_args args;
+
+    if (!inet_aton(dest, &args.dest) ||
+        !inet_aton(netmask, &args.netmask)) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    ip4_addr_set_u32(&args.dest, ip4_addr_get_u32(&args.dest) & ip4_addr_get_u32(&args.netmask));
+    args.id = id;
+
+    if (mbed_lwip_core_sync(mbed_lwip_route_remove, &args) != ERR_OK) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    return args.err;
+#else
+    return NSAPI_ERROR_UNSUPPORTED;
+#endif
+}
+
+/* LWIP error remapping */
+static nsapi_error_t mbed_lwip_err_remap(err_t err) {
+    switch (err) {
+        case ERR_OK:
+        case ERR_CLSD:
             return 0;
         case ERR_MEM:
             return NSAPI_ERROR_NO_MEMORY;
@@ -582,47 +1173,6 @@ static nsapi_error_t mbed_lwip_err_remap(err_t err) {
 }
 
 /* LWIP network stack implementation */
-static nsapi_error_t mbed_lwip_gethostbyname(nsapi_stack_t *stack, const char *host, nsapi_addr_t *addr, nsapi_version_t version)
-{
-    ip_addr_t lwip_addr;
-
-#if LWIP_IPV4 && LWIP_IPV6
-    u8_t addr_type;
-    if (version == NSAPI_UNSPEC) {
-        const ip_addr_t *ip_addr;
-        ip_addr = mbed_lwip_get_ip_addr(true, &lwip_netif);
-        if (IP_IS_V6(ip_addr)) {
-            addr_type = NETCONN_DNS_IPV6;
-        } else {
-            addr_type = NETCONN_DNS_IPV4;
-        }
-    } else if (version == NSAPI_IPv4) {
-        addr_type = NETCONN_DNS_IPV4;
-    } else if (version == NSAPI_IPv6) {
-        addr_type = NETCONN_DNS_IPV6;
-    }
-    err_t err = netconn_gethostbyname_addrtype(host, &lwip_addr, addr_type);
-#elif LWIP_IPV4
-    if (version != NSAPI_IPv4 && version != NSAPI_UNSPEC) {
-        return NSAPI_ERROR_DNS_FAILURE;
-    }
-    err_t err = netconn_gethostbyname(host, &lwip_addr);
-#elif LWIP_IPV6
-    if (version != NSAPI_IPv6 && version != NSAPI_UNSPEC) {
-        return NSAPI_ERROR_DNS_FAILURE;
-    }
-    err_t err = netconn_gethostbyname(host, &lwip_addr);
-#endif
-
-    if (err != ERR_OK) {
-        return NSAPI_ERROR_DNS_FAILURE;
-    }
-
-    convert_lwip_addr_to_mbed(addr, &lwip_addr);
-
-    return 0;
-}
-
 static nsapi_error_t mbed_lwip_add_dns_server(nsapi_stack_t *stack, nsapi_addr_t addr)
 {
     // Shift all dns servers down to give precedence to new server
@@ -636,13 +1186,15 @@ static nsapi_error_t mbed_lwip_add_dns_server(nsapi_stack_t *stack, nsapi_addr_t
     }
 
     dns_setserver(0, &ip_addr);
-    return 0;
+    return nsapi_dns_add_server(addr);
 }
 
 static nsapi_error_t mbed_lwip_socket_open(nsapi_stack_t *stack, nsapi_socket_t *handle, nsapi_protocol_t proto)
 {
+    struct mbed_lwip_netif *n = (struct mbed_lwip_netif *)stack->stack;
+
     // check if network is connected
-    if (!lwip_connected) {
+    if (n ? !n->connected : !mbed_lwip_connected()) {
         return NSAPI_ERROR_NO_CONNECTION;
     }
 
@@ -656,7 +1208,7 @@ static nsapi_error_t mbed_lwip_socket_open(nsapi_stack_t *stack, nsapi_socket_t
 
 #if LWIP_IPV6 && LWIP_IPV4
     const ip_addr_t *ip_addr;
-    ip_addr = mbed_lwip_get_ip_addr(true, &lwip_netif);
+    ip_addr = mbed_lwip_get_ip_addr(true, mbed_lwip_stack_netif(stack));
 
     if (IP_IS_V6(ip_addr)) {
         // Enable IPv6 (or dual-stack). LWIP dual-stack support is
@@ -678,14 +1230,71 @@ static nsapi_error_t mbed_lwip_socket_open(nsapi_stack_t *stack, nsapi_socket_t
     }
 
     netconn_set_recvtimeout(s->conn, 1);
+    s->netif = n;
     *(struct lwip_socket **)handle = s;
     return 0;
 }
 
+/* Bind a socket opened on a per-interface stack to the interface's
+ * address before it first sends, the routing hook then keeps its
+ * traffic on that interface */
+static err_t mbed_lwip_socket_pin(struct lwip_socket *s)
+{
+    if (!s->netif) {
+        return ERR_OK;
+    }
+
+    // an explicit bind has already used the interface address
+    if ((s->conn->type == NETCONN_TCP && s->conn->pcb.tcp->local_port != 0) ||
+        (s->conn->type == NETCONN_UDP && s->conn->pcb.udp->local_port != 0)) {
+        return ERR_OK;
+    }
+
+    const ip_addr_t *ip_addr = mbed_lwip_get_ip_addr(true, &s->netif->netif);
+    if (!ip_addr) {
+        return ERR_CONN;
+    }
+
+    return netconn_bind(s->conn, ip_addr, 0);
+}
+
 static nsapi_error_t mbed_lwip_socket_close(nsapi_stack_t *stack, nsapi_socket_t handle)
 {
     struct lwip_socket *s = (struct lwip_socket *)handle;
 
+    // lwIP keeps referencing zero-copy data after the netconn is deleted,
+    // so wait for it to be acknowledged and reset the connection otherwise.
+    // A socket set to linger waits for its linger time instead, zero
+    // meaning reset straight away.
+    if (s->nocopy_count) {
+        u32_t timeout = (s->conn->linger >= 0) ? (u32_t)s->conn->linger * 1000 : NOCOPY_CLOSE_TIMEOUT;
+
+        if (timeout && sys_sem_new(&s->nocopy_done, 0) == ERR_OK) {
+            sys_prot_t prot = sys_arch_protect();
+            s->nocopy_waiting = true;
+            bool pending = s->nocopy_count != 0;
+            sys_arch_unprotect(prot);
+
+            if (pending) {
+                sys_arch_sem_wait(&s->nocopy_done, timeout);
+            }
+
+            prot = sys_arch_protect();
+            s->nocopy_waiting = false;
+            sys_arch_unprotect(prot);
+            sys_sem_free(&s->nocopy_done);
+        }
+
+        if (s->nocopy_count) {
+            mbed_lwip_core_call(mbed_lwip_nocopy_abort, s);
+        }
+    }
+
+    // lwIP can only linger on a blocking netconn
+    if (s->conn->linger > 0) {
+        netconn_set_nonblocking(s->conn, false);
+    }
+
     err_t err = netconn_delete(s->conn);
     mbed_lwip_arena_dealloc(s);
     return mbed_lwip_err_remap(err);
@@ -705,6 +1314,14 @@ static nsapi_error_t mbed_lwip_socket_bind(nsapi_stack_t *stack, nsapi_socket_t
         return NSAPI_ERROR_PARAMETER;
     }
 
+    // sockets on a per-interface stack only listen on that interface
+    if (s->netif && ip_addr_isany(&ip_addr)) {
+        const ip_addr_t *netif_addr = mbed_lwip_get_ip_addr(true, &s->netif->netif);
+        if (netif_addr) {
+            ip_addr_copy(ip_addr, *netif_addr);
+        }
+    }
+
     err_t err = netconn_bind(s->conn, &ip_addr, port);
     return mbed_lwip_err_remap(err);
 }
@@ -726,13 +1343,38 @@ static nsapi_error_t mbed_lwip_socket_connect(nsapi_stack_t *stack, nsapi_socket
         return NSAPI_ERROR_PARAMETER;
     }
 
+    err_t err = mbed_lwip_socket_pin(s);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
     netconn_set_nonblocking(s->conn, false);
-    err_t err = netconn_connect(s->conn, &ip_addr, port);
+    err = netconn_connect(s->conn, &ip_addr, port);
     netconn_set_nonblocking(s->conn, true);
 
     return mbed_lwip_err_remap(err);
 }
 
+/* Carries the options of a listening socket over to an accepted one */
+static err_t mbed_lwip_accept_options(void *arg)
+{
+    struct lwip_socket *s = ((struct lwip_socket **)arg)[0];
+    struct lwip_socket *ns = ((struct lwip_socket **)arg)[1];
+
+    if (ns->conn->pcb.tcp) {
+        if (s->nodelay) {
+            tcp_nagle_disable(ns->conn->pcb.tcp);
+            ns->nodelay = true;
+        }
+
+        if (s->sndbuf && mbed_lwip_tcp_resize_sndbuf(ns->conn->pcb.tcp, TCP_SND_BUF, s->sndbuf)) {
+            ns->sndbuf = s->sndbuf;
+        }
+    }
+
+    return ERR_OK;
+}
+
 static nsapi_error_t mbed_lwip_socket_accept(nsapi_stack_t *stack, nsapi_socket_t server, nsapi_socket_t *handle, nsapi_addr_t *addr, uint16_t *port)
 {
     struct lwip_socket *s = (struct lwip_socket *)server;
@@ -748,8 +1390,16 @@ static nsapi_error_t mbed_lwip_socket_accept(nsapi_stack_t *stack, nsapi_socket_
     }
 
     netconn_set_recvtimeout(ns->conn, 1);
+    ns->netif = s->netif;
     *(struct lwip_socket **)handle = ns;
 
+    // options set on the listening socket carry over
+    ns->conn->linger = s->conn->linger;
+    if (s->nodelay || s->sndbuf) {
+        struct lwip_socket *pair[2] = {s, ns};
+        mbed_lwip_core_sync(mbed_lwip_accept_options, pair);
+    }
+
     ip_addr_t peer_addr;
     (void) netconn_peer(ns->conn, &peer_addr, port);
     convert_lwip_addr_to_mbed(addr, &peer_addr);
@@ -770,6 +1420,51 @@ static nsapi_size_or_error_t mbed_lwip_socket_send(nsapi_stack_t *stack, nsapi_s
     return (nsapi_size_or_error_t)bytes_written;
 }
 
+static nsapi_size_or_error_t mbed_lwip_socket_send_nocopy(nsapi_stack_t *stack, nsapi_socket_t handle, const void *data, nsapi_size_t size, void (*callback)(void *), void *context)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    size_t bytes_written = 0;
+
+    if (s->conn->type != NETCONN_TCP) {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    if (s->nocopy_count == TCP_NOCOPY_MAX) {
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+
+    // only this socket appends data, so snd_lbb is stable until the write,
+    // but the pcb itself belongs to the stack and may go away on a reset
+    struct mbed_lwip_snd_lbb_call call;
+    call.conn = s->conn;
+    if (tcpip_api_call(mbed_lwip_get_snd_lbb, &call.call) != ERR_OK) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    u32_t start = call.snd_lbb;
+    err_t err = netconn_write_partly(s->conn, data, size, NETCONN_NOCOPY, &bytes_written);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    if (bytes_written == 0) {
+        return 0;
+    }
+
+    sys_prot_t prot = sys_arch_protect();
+    struct lwip_nocopy *n = &s->nocopy[(s->nocopy_head + s->nocopy_count) % TCP_NOCOPY_MAX];
+    n->end = start + bytes_written;
+    n->cb = callback;
+    n->context = context;
+    s->nocopy_count++;
+    sys_arch_unprotect(prot);
+
+    // the data may already have been acknowledged before it was recorded
+    mbed_lwip_core_call(mbed_lwip_nocopy_poll, s);
+
+    return (nsapi_size_or_error_t)bytes_written;
+}
+
 static nsapi_size_or_error_t mbed_lwip_socket_recv(nsapi_stack_t *stack, nsapi_socket_t handle, void *data, nsapi_size_t size)
 {
     struct lwip_socket *s = (struct lwip_socket *)handle;
@@ -803,8 +1498,13 @@ static nsapi_size_or_error_t mbed_lwip_socket_sendto(nsapi_stack_t *stack, nsapi
         return NSAPI_ERROR_PARAMETER;
     }
 
+    err_t err = mbed_lwip_socket_pin(s);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
     struct netbuf *buf = netbuf_new();
-    err_t err = netbuf_ref(buf, data, (u16_t)size);
+    err = netbuf_ref(buf, data, (u16_t)size);
     if (err != ERR_OK) {
         netbuf_free(buf);
         return mbed_lwip_err_remap(err);
@@ -838,46 +1538,569 @@ static nsapi_size_or_error_t mbed_lwip_socket_recvfrom(nsapi_stack_t *stack, nsa
     return recv;
 }
 
+static nsapi_size_or_error_t mbed_lwip_socket_sendmsg(nsapi_stack_t *stack, nsapi_socket_t handle, const nsapi_addr_t *addr, uint16_t port, const nsapi_iovec_t *iov, unsigned iovcnt)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    nsapi_size_t size = 0;
+
+    if (s->conn->type == NETCONN_TCP) {
+        // queue the buffers in turn, only the last one pushes the data
+        for (unsigned i = 0; i < iovcnt; i++) {
+            size_t bytes_written = 0;
+            u8_t flags = NETCONN_COPY | ((i + 1 < iovcnt) ? NETCONN_MORE : 0);
+
+            err_t err = netconn_write_partly(s->conn, iov[i].iov_base, iov[i].iov_len, flags, &bytes_written);
+            if (err != ERR_OK) {
+                return size ? (nsapi_size_or_error_t)size : mbed_lwip_err_remap(err);
+            }
+
+            size += bytes_written;
+            if (bytes_written < iov[i].iov_len) {
+                break;
+            }
+        }
+
+        return (nsapi_size_or_error_t)size;
+    }
+
+    ip_addr_t ip_addr;
+    if (!addr || !convert_mbed_addr_to_lwip(&ip_addr, addr)) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    err_t pin_err = mbed_lwip_socket_pin(s);
+    if (pin_err != ERR_OK) {
+        return mbed_lwip_err_remap(pin_err);
+    }
+
+    struct netbuf *buf = netbuf_new();
+    if (!buf) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    // reference each buffer from its own pbuf, the chain forms the datagram
+    for (unsigned i = 0; i < iovcnt; i++) {
+        if (!iov[i].iov_len) {
+            continue;
+        }
+
+        if (size + iov[i].iov_len > 0xffff) {
+            netbuf_delete(buf);
+            return NSAPI_ERROR_PARAMETER;
+        }
+
+        struct pbuf *q = pbuf_alloc(PBUF_TRANSPORT, (u16_t)iov[i].iov_len, PBUF_REF);
+        if (!q) {
+            netbuf_delete(buf);
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+        q->payload = iov[i].iov_base;
+
+        if (buf->p) {
+            pbuf_cat(buf->p, q);
+        } else {
+            buf->p = q;
+            buf->ptr = q;
+        }
+        size += iov[i].iov_len;
+    }
+
+    if (!buf->p) {
+        err_t err = netbuf_ref(buf, 0, 0);
+        if (err != ERR_OK) {
+            netbuf_delete(buf);
+            return mbed_lwip_err_remap(err);
+        }
+    }
+
+    err_t err = netconn_sendto(s->conn, buf, &ip_addr, port);
+    netbuf_delete(buf);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    return (nsapi_size_or_error_t)size;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recvmsg(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_addr_t *addr, uint16_t *port, const nsapi_iovec_t *iov, unsigned iovcnt)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    nsapi_size_t size = 0;
+
+    if (s->conn->type == NETCONN_TCP) {
+        if (!s->buf) {
+            err_t err = netconn_recv(s->conn, &s->buf);
+            s->offset = 0;
+
+            if (err != ERR_OK) {
+                return mbed_lwip_err_remap(err);
+            }
+        }
+
+        // scatter the current netbuf
+        for (unsigned i = 0; i < iovcnt && s->buf; i++) {
+            u16_t recv = netbuf_copy_partial(s->buf, iov[i].iov_base, (u16_t)iov[i].iov_len, s->offset);
+            s->offset += recv;
+            size += recv;
+
+            if (s->offset >= netbuf_len(s->buf)) {
+                netbuf_delete(s->buf);
+                s->buf = 0;
+            }
+        }
+
+        return (nsapi_size_or_error_t)size;
+    }
+
+    struct netbuf *buf;
+    err_t err = netconn_recv(s->conn, &buf);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    if (addr) {
+        convert_lwip_addr_to_mbed(addr, netbuf_fromaddr(buf));
+        *port = netbuf_fromport(buf);
+    }
+
+    for (unsigned i = 0; i < iovcnt; i++) {
+        u16_t recv = netbuf_copy_partial(buf, iov[i].iov_base, (u16_t)iov[i].iov_len, (u16_t)size);
+        size += recv;
+
+        if (recv < iov[i].iov_len) {
+            break;
+        }
+    }
+
+    netbuf_delete(buf);
+    return (nsapi_size_or_error_t)size;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_sendto_many(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_datagram_t *msgs, unsigned count)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+
+    err_t pin_err = mbed_lwip_socket_pin(s);
+    if (pin_err != ERR_OK) {
+        return mbed_lwip_err_remap(pin_err);
+    }
+
+    // one netbuf is reused to reference each datagram in turn
+    struct netbuf *buf = netbuf_new();
+    if (!buf) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    unsigned sent;
+    for (sent = 0; sent < count; sent++) {
+        ip_addr_t ip_addr;
+        if (!convert_mbed_addr_to_lwip(&ip_addr, &msgs[sent].addr)) {
+            netbuf_delete(buf);
+            return sent ? (nsapi_size_or_error_t)sent : NSAPI_ERROR_PARAMETER;
+        }
+
+        err_t err = netbuf_ref(buf, msgs[sent].data, (u16_t)msgs[sent].size);
+        if (err == ERR_OK) {
+            err = netconn_sendto(s->conn, buf, &ip_addr, msgs[sent].port);
+        }
+
+        if (err != ERR_OK) {
+            netbuf_delete(buf);
+            return sent ? (nsapi_size_or_error_t)sent : mbed_lwip_err_remap(err);
+        }
+    }
+
+    netbuf_delete(buf);
+    return (nsapi_size_or_error_t)sent;
+}
+
+/* Takes the next datagram queued on a UDP netconn without waiting for the
+ * receive timeout, with the same accounting as netconn_recv */
+static struct netbuf *mbed_lwip_udp_tryrecv(struct netconn *conn)
+{
+    void *buf;
+    if (!sys_mbox_valid(&conn->recvmbox)
+        || sys_arch_mbox_tryfetch(&conn->recvmbox, &buf) == SYS_MBOX_EMPTY) {
+        return NULL;
+    }
+
+    u16_t len = netbuf_len((struct netbuf *)buf);
+#if LWIP_SO_RCVBUF
+    SYS_ARCH_DEC(conn->recv_avail, len);
+#endif
+    if (conn->callback) {
+        conn->callback(conn, NETCONN_EVT_RCVMINUS, len);
+    }
+
+    return (struct netbuf *)buf;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recvfrom_many(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_datagram_t *msgs, unsigned count)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+
+    if (ERR_IS_FATAL(s->conn->last_err)) {
+        return mbed_lwip_err_remap(s->conn->last_err);
+    }
+
+    // drain the mailbox directly, netconn_recv would wait out the receive
+    // timeout once it runs empty
+    unsigned received;
+    for (received = 0; received < count; received++) {
+        struct netbuf *buf = mbed_lwip_udp_tryrecv(s->conn);
+        if (!buf) {
+            break;
+        }
+
+        convert_lwip_addr_to_mbed(&msgs[received].addr, netbuf_fromaddr(buf));
+        msgs[received].port = netbuf_fromport(buf);
+        msgs[received].length = netbuf_copy(buf, msgs[received].data, (u16_t)msgs[received].size);
+        netbuf_delete(buf);
+    }
+
+    return received ? (nsapi_size_or_error_t)received : NSAPI_ERROR_WOULD_BLOCK;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recv_chain(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_addr_t *addr, uint16_t *port, nsapi_chain_t *chain)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    struct netbuf *buf;
+    u16_t offset;
+
+    if (s->conn->type == NETCONN_TCP) {
+        // the chain covers the unread part of the current netbuf
+        if (!s->buf) {
+            err_t err = netconn_recv(s->conn, &s->buf);
+            s->offset = 0;
+
+            if (err != ERR_OK) {
+                return mbed_lwip_err_remap(err);
+            }
+        }
+
+        buf = s->buf;
+        offset = s->offset;
+    } else {
+        err_t err = netconn_recv(s->conn, &buf);
+        if (err != ERR_OK) {
+            return mbed_lwip_err_remap(err);
+        }
+
+        if (addr) {
+            convert_lwip_addr_to_mbed(addr, netbuf_fromaddr(buf));
+            *port = netbuf_fromport(buf);
+        }
+
+        offset = 0;
+    }
+
+    chain->count = 0;
+    chain->size = 0;
+    chain->token = buf;
+
+    for (struct pbuf *q = buf->p; q && chain->count < NSAPI_CHAIN_SEGMENTS; q = q->next) {
+        if (offset >= q->len) {
+            offset -= q->len;
+            continue;
+        }
+
+        chain->segment[chain->count].data = (const u8_t *)q->payload + offset;
+        chain->segment[chain->count].size = q->len - offset;
+        chain->size += q->len - offset;
+        chain->count++;
+        offset = 0;
+    }
+
+    return chain->size;
+}
+
+static void mbed_lwip_socket_recv_release(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_chain_t *chain)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    struct netbuf *buf = (struct netbuf *)chain->token;
+
+    if (!buf) {
+        return;
+    }
+
+    if (s->conn->type == NETCONN_TCP && buf == s->buf) {
+        s->offset += chain->size;
+
+        if (s->offset >= netbuf_len(s->buf)) {
+            netbuf_delete(s->buf);
+            s->buf = 0;
+        }
+    } else {
+        netbuf_delete(buf);
+    }
+
+    chain->token = 0;
+    chain->count = 0;
+    chain->size = 0;
+}
+
+struct mbed_lwip_sockopt_args {
+    struct lwip_socket *s;
+    int optname;
+    int value;
+    nsapi_error_t err;
+};
+
+/* Applies a socket option to the pcb, which belongs to the stack */
+static err_t mbed_lwip_setsockopt_pcb(void *arg)
+{
+    struct mbed_lwip_sockopt_args *args = (struct mbed_lwip_sockopt_args *)arg;
+    struct lwip_socket *s = args->s;
+
+    args->err = 0;
+    switch (args->optname) {
+        case NSAPI_KEEPALIVE:
+            s->conn->pcb.tcp->so_options |= SOF_KEEPALIVE;
+            break;
+
+        case NSAPI_KEEPIDLE:
+            s->conn->pcb.tcp->keep_idle = args->value;
+            break;
+
+        case NSAPI_KEEPINTVL:
+            s->conn->pcb.tcp->keep_intvl = args->value;
+            break;
+
+        case NSAPI_REUSEADDR:
+            if (args->value) {
+                s->conn->pcb.tcp->so_options |= SOF_REUSEADDR;
+            } else {
+                s->conn->pcb.tcp->so_options &= ~SOF_REUSEADDR;
+            }
+            break;
+
+        case NSAPI_TCP_NODELAY:
+            // a listening pcb has no flags, it is applied on accept
+            s->nodelay = args->value != 0;
+            if (s->conn->pcb.tcp && s->conn->pcb.tcp->state != LISTEN) {
+                if (s->nodelay) {
+                    tcp_nagle_disable(s->conn->pcb.tcp);
+                } else {
+                    tcp_nagle_enable(s->conn->pcb.tcp);
+                }
+            }
+            break;
+
+        case NSAPI_SNDBUF: {
+            tcpwnd_size_t sndbuf = (tcpwnd_size_t)args->value;
+            tcpwnd_size_t current = s->sndbuf ? s->sndbuf : TCP_SND_BUF;
+
+            if (s->conn->pcb.tcp && s->conn->pcb.tcp->state != LISTEN &&
+                !mbed_lwip_tcp_resize_sndbuf(s->conn->pcb.tcp, current, sndbuf)) {
+                // too much data queued, retry once it is acknowledged
+                args->err = NSAPI_ERROR_WOULD_BLOCK;
+            } else {
+                s->sndbuf = (sndbuf == TCP_SND_BUF) ? 0 : sndbuf;
+            }
+            break;
+        }
+    }
+
+    return ERR_OK;
+}
+
+static nsapi_error_t mbed_lwip_setsockopt_core(struct lwip_socket *s, int optname, int value)
+{
+    struct mbed_lwip_sockopt_args args = {s, optname, value, 0};
+
+    if (mbed_lwip_core_sync(mbed_lwip_setsockopt_pcb, &args) != ERR_OK) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    return args.err;
+}
+
 static nsapi_error_t mbed_lwip_setsockopt(nsapi_stack_t *stack, nsapi_socket_t handle, int level, int optname, const void *optval, unsigned optlen)
 {
     struct lwip_socket *s = (struct lwip_socket *)handle;
 
     switch (optname) {
         case NSAPI_KEEPALIVE:
+        case NSAPI_KEEPIDLE:
+        case NSAPI_KEEPINTVL:
+        case NSAPI_TCP_NODELAY:
             if (optlen != sizeof(int) || s->conn->type != NETCONN_TCP) {
                 return NSAPI_ERROR_UNSUPPORTED;
             }
 
-            s->conn->pcb.tcp->so_options |= SOF_KEEPALIVE;
-            return 0;
+            // the pcb belongs to the stack, change it in the stack's context
+            return mbed_lwip_setsockopt_core(s, optname, *(int *)optval);
 
-        case NSAPI_KEEPIDLE:
+        case NSAPI_REUSEADDR:
+            if (optlen != sizeof(int)) {
+                return NSAPI_ERROR_UNSUPPORTED;
+            }
+
+            return mbed_lwip_setsockopt_core(s, optname, *(int *)optval);
+
+        case NSAPI_SNDBUF: {
             if (optlen != sizeof(int) || s->conn->type != NETCONN_TCP) {
                 return NSAPI_ERROR_UNSUPPORTED;
             }
 
-            s->conn->pcb.tcp->keep_idle = *(int*)optval;
+            // lwIP only signals writable space above TCP_SNDLOWAT and
+            // sizes its segment queue for TCP_SND_BUF, so stay between them
+            int size = *(int *)optval;
+            tcpwnd_size_t sndbuf = (size > TCP_SND_BUF) ? TCP_SND_BUF :
+                                   (size <= TCP_SNDLOWAT) ? TCP_SNDLOWAT + 1 : (tcpwnd_size_t)size;
+
+            return mbed_lwip_setsockopt_core(s, optname, sndbuf);
+        }
+
+        case NSAPI_RCVBUF:
+            // lwIP uses one receive window for all TCP connections
+            if (optlen != sizeof(int) || s->conn->type != NETCONN_UDP || *(int *)optval <= 0) {
+                return NSAPI_ERROR_UNSUPPORTED;
+            }
+
+            netconn_set_recvbufsize(s->conn, *(int *)optval);
             return 0;
 
-        case NSAPI_KEEPINTVL:
-            if (optlen != sizeof(int) || s->conn->type != NETCONN_TCP) {
+        case NSAPI_LINGER: {
+            if (optlen != sizeof(nsapi_linger_t) || s->conn->type != NETCONN_TCP) {
                 return NSAPI_ERROR_UNSUPPORTED;
             }
 
-            s->conn->pcb.tcp->keep_intvl = *(int*)optval;
+            const nsapi_linger_t *linger = (const nsapi_linger_t *)optval;
+            if (linger->l_onoff && (linger->l_linger < 0 || linger->l_linger > 0x7fff)) {
+                return NSAPI_ERROR_PARAMETER;
+            }
+
+            s->conn->linger = linger->l_onoff ? (s16_t)linger->l_linger : -1;
             return 0;
+        }
 
-        case NSAPI_REUSEADDR:
-            if (optlen != sizeof(int)) {
+        default:
+            return NSAPI_ERROR_UNSUPPORTED;
+    }
+}
+
+static nsapi_error_t mbed_lwip_getsockopt(nsapi_stack_t *stack, nsapi_socket_t handle, int level, int optname, void *optval, unsigned *optlen)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+
+    switch (optname) {
+        case NSAPI_TCP_NODELAY:
+            if (*optlen < sizeof(int) || s->conn->type != NETCONN_TCP) {
                 return NSAPI_ERROR_UNSUPPORTED;
             }
 
-            if (*(int *)optval) {
-                s->conn->pcb.tcp->so_options |= SOF_REUSEADDR;
-            } else {
-                s->conn->pcb.tcp->so_options &= ~SOF_REUSEADDR;
+            *(int *)optval = s->nodelay;
+            *optlen = sizeof(int);
+            return 0;
+
+        case NSAPI_SNDBUF:
+            if (*optlen < sizeof(int) || s->conn->type != NETCONN_TCP) {
+                return NSAPI_ERROR_UNSUPPORTED;
+            }
+
+            *(int *)optval = s->sndbuf ? s->sndbuf : TCP_SND_BUF;
+            *optlen = sizeof(int);
+            return 0;
+
+        case NSAPI_RCVBUF:
+            if (*optlen < sizeof(int)) {
+                return NSAPI_ERROR_UNSUPPORTED;
+            }
+
+            *(int *)optval = (s->conn->type == NETCONN_TCP) ? TCP_WND : netconn_get_recvbufsize(s->conn);
+            *optlen = sizeof(int);
+            return 0;
+
+        case NSAPI_LINGER: {
+            if (*optlen < sizeof(nsapi_linger_t) || s->conn->type != NETCONN_TCP) {
+                return NSAPI_ERROR_UNSUPPORTED;
+            }
+
+            nsapi_linger_t *linger = (nsapi_linger_t *)optval;
+            linger->l_onoff = s->conn->linger >= 0;
+            linger->l_linger = (s->conn->linger >= 0) ? s->conn->linger : 0;
+            *optlen = sizeof(nsapi_linger_t);
+            return 0;
+        }
+
+        default:
+            return NSAPI_ERROR_UNSUPPORTED;
+    }
+}
+
+#if LWIP_STATS
+static void mbed_lwip_add_proto_stats(nsapi_stack_proto_stats_t *stats, const struct stats_proto *proto)
+{
+    stats->xmit += proto->xmit;
+    stats->recv += proto->recv;
+    stats->drop += proto->drop;
+    stats->err += proto->chkerr + proto->lenerr + proto->memerr +
+            proto->rterr + proto->proterr + proto->opterr + proto->err;
+}
+
+static void mbed_lwip_copy_pool_stats(nsapi_stack_pool_stats_t *stats, const struct stats_mem *mem)
+{
+    stats->avail = mem->avail;
+    stats->used = mem->used;
+    stats->max = mem->max;
+    stats->err = mem->err;
+}
+#endif
+
+static nsapi_error_t mbed_lwip_getstackopt(nsapi_stack_t *stack, int level, int optname, void *optval, unsigned *optlen)
+{
+    if (level != NSAPI_STACK) {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    switch (optname) {
+#if LWIP_STATS
+        case NSAPI_STACK_STATS: {
+            if (*optlen < sizeof(nsapi_stack_stats_t)) {
+                return NSAPI_ERROR_UNSUPPORTED;
             }
+
+            // Counters are read without stopping the stack, each one is
+            // consistent but the set may straddle a packet
+            nsapi_stack_stats_t *stats = (nsapi_stack_stats_t *)optval;
+            memset(stats, 0, sizeof(nsapi_stack_stats_t));
+#if LINK_STATS
+            mbed_lwip_add_proto_stats(&stats->link, &lwip_stats.link);
+#endif
+#if IP_STATS
+            mbed_lwip_add_proto_stats(&stats->ip, &lwip_stats.ip);
+#endif
+#if IP6_STATS
+            mbed_lwip_add_proto_stats(&stats->ip, &lwip_stats.ip6);
+#endif
+#if UDP_STATS
+            mbed_lwip_add_proto_stats(&stats->udp, &lwip_stats.udp);
+#endif
+#if TCP_STATS
+            mbed_lwip_add_proto_stats(&stats->tcp, &lwip_stats.tcp);
+#endif
+#if MIB2_STATS
+            stats->tcp_retransmit = lwip_stats.mib2.tcpretranssegs;
+#endif
+#if MEM_STATS
+            mbed_lwip_copy_pool_stats(&stats->heap, &lwip_stats.mem);
+#endif
+#if MEMP_STATS
+            mbed_lwip_copy_pool_stats(&stats->pbuf_pool, lwip_stats.memp[MEMP_PBUF_POOL]);
+            mbed_lwip_copy_pool_stats(&stats->pbuf, lwip_stats.memp[MEMP_PBUF]);
+#if LWIP_TCP
+            mbed_lwip_copy_pool_stats(&stats->tcp_seg, lwip_stats.memp[MEMP_TCP_SEG]);
+#endif
+#endif
+            // Every mailbox implementation counts refused posts
+            sys_mbox_stats_t mbox_stats;
+            sys_arch_mbox_stats(&mbox_stats);
+            stats->mbox_full = mbox_stats.post_full;
+            *optlen = sizeof(nsapi_stack_stats_t);
             return 0;
+        }
+#endif
 
         default:
             return NSAPI_ERROR_UNSUPPORTED;
@@ -892,10 +2115,23 @@ static void mbed_lwip_socket_attach(nsapi_stack_t *stack, nsapi_socket_t handle,
     s->data = data;
 }
 
+static nsapi_addr_t mbed_lwip_get_stack_ip_address(nsapi_stack_t *stack)
+{
+    nsapi_addr_t addr = {NSAPI_UNSPEC};
+
+    const ip_addr_t *ip_addr = mbed_lwip_get_ip_addr(true, mbed_lwip_stack_netif(stack));
+    if (ip_addr) {
+        convert_lwip_addr_to_mbed(&addr, ip_addr);
+    }
+
+    return addr;
+}
+
 /* LWIP network stack */
 const nsapi_stack_api_t lwip_stack_api = {
-    .gethostbyname      = mbed_lwip_gethostbyname,
+    .get_ip_address     = mbed_lwip_get_stack_ip_address,
     .add_dns_server     = mbed_lwip_add_dns_server,
+    .getstackopt        = mbed_lwip_getstackopt,
     .socket_open        = mbed_lwip_socket_open,
     .socket_close       = mbed_lwip_socket_close,
     .socket_bind        = mbed_lwip_socket_bind,
@@ -907,9 +2143,29 @@ const nsapi_stack_api_t lwip_stack_api = {
     .socket_sendto      = mbed_lwip_socket_sendto,
     .socket_recvfrom    = mbed_lwip_socket_recvfrom,
     .setsockopt         = mbed_lwip_setsockopt,
+    .getsockopt         = mbed_lwip_getsockopt,
     .socket_attach      = mbed_lwip_socket_attach,
+    .socket_send_nocopy = mbed_lwip_socket_send_nocopy,
+    .socket_recv_chain  = mbed_lwip_socket_recv_chain,
+    .socket_recv_release = mbed_lwip_socket_recv_release,
+    .socket_sendmsg     = mbed_lwip_socket_sendmsg,
+    .socket_recvmsg     = mbed_lwip_socket_recvmsg,
+    .socket_sendto_many = mbed_lwip_socket_sendto_many,
+    .socket_recvfrom_many = mbed_lwip_socket_recvfrom_many,
 };
 
 nsapi_stack_t lwip_stack = {
     .stack_api = &lwip_stack_api,
 };
+
+nsapi_stack_t *mbed_lwip_get_netif_stack(int id)
+{
+    struct mbed_lwip_netif *n = mbed_lwip_get_netif(id);
+    if (!n) {
+        return NULL;
+    }
+
+    n->stack.stack_api = &lwip_stack_api;
+    n->stack.stack = n;
+    return &n->stack;
+}
@@ -19,6 +19,7 @@
 
 #include "nsapi.h"
 #include "emac_api.h"
+#include "lwip/netif.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,7 +35,28 @@ char *mbed_lwip_get_ip_address(char *buf, int buflen);
 char *mbed_lwip_get_netmask(char *buf, int buflen);
 char *mbed_lwip_get_gateway(char *buf, int buflen);
 
+// Additional network interfaces, identified by the id from mbed_lwip_add_netif.
+// The interface set up by mbed_lwip_init has id 0 and the functions above
+// act on it.
+nsapi_error_t mbed_lwip_add_netif(void *state, netif_init_fn init, int *id);
+nsapi_error_t mbed_lwip_bringup_netif(int id, bool dhcp, const char *ip, const char *netmask, const char *gw);
+nsapi_error_t mbed_lwip_bringdown_netif(int id);
+
+const char *mbed_lwip_get_netif_mac_address(int id);
+char *mbed_lwip_get_netif_ip_address(int id, char *buf, int buflen);
+char *mbed_lwip_get_netif_netmask(int id, char *buf, int buflen);
+char *mbed_lwip_get_netif_gateway(int id, char *buf, int buflen);
+
+// Static IPv4 routes for destinations outside the connected networks. The
+// longest matching route on an interface that is up wins, then the lowest
+// metric, so a second route with a higher metric acts as a failover.
+nsapi_error_t mbed_lwip_add_route(const char *dest, const char *netmask, int id, uint8_t metric);
+nsapi_error_t mbed_lwip_remove_route(const char *dest, const char *netmask, int id);
+
+// The stack routes sockets across all interfaces, while the view from
+// mbed_lwip_get_netif_stack keeps its sockets on a single interface
 extern nsapi_stack_t lwip_stack;
+nsapi_stack_t *mbed_lwip_get_netif_stack(int id);
 
 
 #ifdef __cplusplus
@@ -19,7 +19,13 @@
 #ifndef LWIPOPTS_H
 #define LWIPOPTS_H
 
+#if defined(LWIP_PLATFORM_POSIX)
+// Host builds run over a TAP device or socket pair, see posix_emac.h
+#define LWIP_TRANSPORT_ETHERNET     1
+#define MEM_SIZE                    (32 * 1024)
+#else
 #include "lwipopts_conf.h"
+#endif
 
 // Workaround for Linux timeval
 #if defined (TOOLCHAIN_GCC)
@@ -68,17 +74,48 @@
 //#define LWIP_DEBUG
 
 #if NO_SYS == 0
+#if !defined(LWIP_PLATFORM_POSIX)
 #include "cmsis_os.h"
+#endif
 
 #define SYS_LIGHTWEIGHT_PROT        1
 
+// Application threads run netconn calls themselves under the core mutex
+// instead of handing each one to tcpip_thread
+#ifdef MBED_CONF_LWIP_TCPIP_CORE_LOCKING
+#define LWIP_TCPIP_CORE_LOCKING     MBED_CONF_LWIP_TCPIP_CORE_LOCKING
+#endif
+
 #define LWIP_RAW                    0
 
+#if MBED_CONF_LWIP_THROUGHPUT_PROFILE
+// Deep enough to hold a receive window worth of frames between the
+// driver, tcpip_thread and the sockets
+#define TCPIP_MBOX_SIZE             16
+#define DEFAULT_TCP_RECVMBOX_SIZE   16
+#define DEFAULT_UDP_RECVMBOX_SIZE   16
+#else
 #define TCPIP_MBOX_SIZE             8
 #define DEFAULT_TCP_RECVMBOX_SIZE   8
 #define DEFAULT_UDP_RECVMBOX_SIZE   8
+#endif
 #define DEFAULT_RAW_RECVMBOX_SIZE   8
+
+// Connections a listening socket holds before accept, further ones are reset
+#ifdef MBED_CONF_LWIP_ACCEPT_QUEUE_SIZE
+#define DEFAULT_ACCEPTMBOX_SIZE     MBED_CONF_LWIP_ACCEPT_QUEUE_SIZE
+#else
 #define DEFAULT_ACCEPTMBOX_SIZE     8
+#endif
+
+// All mailboxes share one capacity, a power of two fitting the largest
+#if DEFAULT_ACCEPTMBOX_SIZE > 32
+#define MB_SIZE                     64
+#elif DEFAULT_ACCEPTMBOX_SIZE > 16
+#define MB_SIZE                     32
+#elif DEFAULT_ACCEPTMBOX_SIZE > 8 || MBED_CONF_LWIP_THROUGHPUT_PROFILE
+#define MB_SIZE                     16
+#endif
 
 #ifdef LWIP_DEBUG
 #define TCPIP_THREAD_STACKSIZE      1200*2
@@ -86,7 +123,11 @@
 #define TCPIP_THREAD_STACKSIZE      1200
 #endif
 
+#if defined(LWIP_PLATFORM_POSIX)
+#define TCPIP_THREAD_PRIO           0
+#else
 #define TCPIP_THREAD_PRIO           (osPriorityNormal)
+#endif
 
 #ifdef LWIP_DEBUG
 #define DEFAULT_THREAD_STACKSIZE    512*2
@@ -105,12 +146,62 @@
 
 #define LWIP_RAM_HEAP_POINTER       lwip_ram_heap
 
+#if MBED_CONF_LWIP_THROUGHPUT_PROFILE && LWIP_TRANSPORT_ETHERNET
+// Throughput profile, buffers are scaled to the target's heap so that a
+// window of full sized segments is in flight in each direction
+
+// Full sized Ethernet segments.
+#if LWIP_IPV6
+#define TCP_MSS                     1440
+#else
+#define TCP_MSS                     1460
+#endif
+
+// Number of pool pbufs, one per received frame.
+// Each requires around 1.5 kbytes of RAM, in all about 0.75 * MEM_SIZE.
+#ifndef PBUF_POOL_SIZE
+#define PBUF_POOL_SIZE              (((MEM_SIZE) / 2048 < 8)  ? 8  : \
+                                     ((MEM_SIZE) / 2048 > 64) ? 64 : \
+                                     ((MEM_SIZE) / 2048))
+#endif
+
+// The window and out-of-order queue below are sized from the pool, a
+// target overriding it has to stay in the same range. lwip_init.c checks
+// the window and send buffer against the pool and MSS.
+#if PBUF_POOL_SIZE < 8 || PBUF_POOL_SIZE > 64
+#error "The throughput profile needs PBUF_POOL_SIZE between 8 and 64"
+#endif
+
+// Receive window fits in the pool, leaving two buffers for other traffic.
+// Windows that outgrow 16 bits are advertised with window scaling.
+#define TCP_WND                     ((PBUF_POOL_SIZE - 2) * TCP_MSS)
+#if TCP_WND > 0xffff
+#define LWIP_WND_SCALE              1
+#define TCP_RCV_SCALE               2
+#endif
+
+// Unacknowledged send data lives in the heap, allow half of it per socket
+// within the range lwIP's send low water marks can handle.
+#define TCP_SND_BUF                 (((MEM_SIZE) / 2 < 2 * TCP_MSS)  ? 2 * TCP_MSS  : \
+                                     ((MEM_SIZE) / 2 > 16 * TCP_MSS) ? 16 * TCP_MSS : \
+                                     ((MEM_SIZE) / 2))
+#define MEMP_NUM_TCP_SEG            (TCP_SND_QUEUELEN + PBUF_POOL_SIZE)
+
+// Keep segments received after a loss so a single retransmission
+// recovers the window, without letting them take the whole pool
+#define TCP_QUEUE_OOSEQ             1
+#define TCP_OOSEQ_MAX_PBUFS         (PBUF_POOL_SIZE / 2)
+
+#else
 // Number of pool pbufs.
 // Each requires 684 bytes of RAM.
 #ifndef PBUF_POOL_SIZE
 #define PBUF_POOL_SIZE              5
 #endif
 
+#define TCP_QUEUE_OOSEQ             0
+#endif
+
 // One tcp_pcb_listen is needed for each TCPServer.
 // Each requires 72 bytes of RAM.
 #ifdef MBED_CONF_LWIP_TCP_SERVER_MAX
@@ -154,7 +245,6 @@
 #define MEMP_NUM_NETCONN            4
 #endif
 
-#define TCP_QUEUE_OOSEQ             0
 #define TCP_OVERSIZE                0
 
 #define LWIP_DHCP                   LWIP_IPV4
@@ -171,11 +261,17 @@
 #define LWIP_COMPAT_SOCKETS         0
 #define LWIP_POSIX_SOCKETS_IO_NAMES 0
 #define LWIP_SO_RCVTIMEO            1
+#define LWIP_SO_RCVBUF              1
+#define RECV_BUFSIZE_DEFAULT        0x7fffffff
+#define LWIP_SO_LINGER              1
 #define LWIP_TCP_KEEPALIVE          1
 
 // Fragmentation on, as per IPv4 default
 #define LWIP_IPV6_FRAG              LWIP_IPV6
 
+// Custom pbufs carry the receive ring buffers of emac_stack_mem
+#define LWIP_SUPPORT_CUSTOM_PBUF    1
+
 // Queuing "disabled", as per IPv4 default (so actually queues 1)
 #define LWIP_ND6_QUEUEING           0
 
@@ -221,6 +317,28 @@
 #define MEMP_SANITY_CHECK           1
 #else
 #define LWIP_NOASSERT               1
+#endif
+
+// Debug builds keep all of lwIP's statistics, as do host builds so
+// benchmarks can report memory usage
+#if defined(LWIP_DEBUG) || defined(LWIP_PLATFORM_POSIX) || MBED_CONF_LWIP_STATS_ENABLED
+#define LWIP_STATS                  1
+#if MBED_CONF_LWIP_STATS_ENABLED
+#define LWIP_STATS_LARGE            1
+#define MIB2_STATS                  1
+#endif
+#if !defined(LWIP_DEBUG) && !defined(LWIP_PLATFORM_POSIX)
+// Only keep the counters reported through NSAPI_STACK_STATS
+#define ETHARP_STATS                0
+#define IPFRAG_STATS                0
+#define ICMP_STATS                  0
+#define IGMP_STATS                  0
+#define ICMP6_STATS                 0
+#define IP6_FRAG_STATS              0
+#define MLD6_STATS                  0
+#define ND6_STATS                   0
+#endif
+#else
 #define LWIP_STATS                  0
 #endif
 
@@ -265,4 +383,19 @@
 #error A transport mechanism (Ethernet or PPP) must be defined
 #endif
 
+// With several interfaces, lwip_stack.c routes through its own table
+#if MBED_CONF_LWIP_NETIF_MAX > 1
+#ifdef __cplusplus
+extern "C" {
+#endif
+struct netif;
+struct ip4_addr;
+struct netif *mbed_lwip_route_hook(const struct ip4_addr *dest, const struct ip4_addr *src);
+#ifdef __cplusplus
+}
+#endif
+
+#define LWIP_HOOK_IP4_ROUTE_SRC(dest, src) mbed_lwip_route_hook(dest, src)
+#endif
+
 #endif /* LWIPOPTS_H_ */
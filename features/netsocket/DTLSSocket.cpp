@@ -0,0 +1,992 @@
+/* DTLSSocket
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DTLSSocket.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_X509_CRT_PARSE_C) && \
+    defined(MBEDTLS_CTR_DRBG_C) && defined(MBEDTLS_ENTROPY_C) && \
+    defined(MBEDTLS_SSL_PROTO_DTLS) && defined(MBEDTLS_SSL_SRV_C) && \
+    defined(MBEDTLS_SSL_COOKIE_C) && defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY)
+
+#include "mbedtls/ssl_internal.h"
+#include <string.h>
+
+static const char dtls_drbg_personalization[] = "mbed DTLSSocket";
+
+/* Lifetime of the session tickets issued by a server, in seconds */
+#define DTLS_TICKET_LIFETIME 86400
+
+/* Sizes of the DTLS record and handshake headers */
+#define DTLS_RECORD_HEADER 13
+#define DTLS_HANDSHAKE_HEADER 12
+
+
+DTLSSocket::DTLSSocket(unsigned capacity)
+{
+    init(capacity);
+}
+
+void DTLSSocket::init(unsigned capacity)
+{
+    _peers = new peer[capacity];
+    _capacity = capacity;
+    for (unsigned i = 0; i < _capacity; i++) {
+        _peers[i].next = 0;
+        _peers[i].socket = this;
+        _peers[i].id_len = 0;
+        _peers[i].state = PEER_FREE;
+        _peers[i].in = 0;
+        _peers[i].in_len = 0;
+        _peers[i].fin_ms = 0;
+        mbedtls_ssl_init(&_peers[i].ssl);
+    }
+
+    // At least as many buckets as peers keeps the chains short
+    unsigned buckets = 1;
+    while (buckets < capacity) {
+        buckets <<= 1;
+    }
+    _buckets = new peer *[buckets];
+    _bucket_mask = buckets - 1;
+    memset(_buckets, 0, buckets * sizeof(peer *));
+
+    _clock = 0;
+    _current = 0;
+    _pending = 0;
+    _role = ROLE_NONE;
+    _conf_ready = false;
+    _bio_error = NSAPI_ERROR_OK;
+    _handshake_error = NSAPI_ERROR_OK;
+    _hostname = 0;
+    _cache = TLSSessionCache::get_default();
+    memset(&_stats, 0, sizeof(_stats));
+    _buffer = new unsigned char[MBED_CONF_NSAPI_DTLS_DATAGRAM_SIZE];
+
+    mbedtls_ssl_config_init(&_conf);
+    mbedtls_entropy_init(&_entropy);
+    mbedtls_ctr_drbg_init(&_drbg);
+    mbedtls_x509_crt_init(&_ca);
+    mbedtls_x509_crt_init(&_own_cert);
+    mbedtls_pk_init(&_own_key);
+    mbedtls_ssl_cookie_init(&_cookie);
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_init(&_session_cache);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_init(&_ticket);
+#endif
+
+    _udp.attach(mbed::callback(this, &DTLSSocket::event));
+}
+
+DTLSSocket::~DTLSSocket()
+{
+    close();
+
+    for (unsigned i = 0; i < _capacity; i++) {
+        mbedtls_ssl_free(&_peers[i].ssl);
+    }
+    delete[] _peers;
+    delete[] _buckets;
+    delete[] _buffer;
+    delete[] _hostname;
+
+    mbedtls_ssl_config_free(&_conf);
+    mbedtls_ctr_drbg_free(&_drbg);
+    mbedtls_entropy_free(&_entropy);
+    mbedtls_x509_crt_free(&_ca);
+    mbedtls_x509_crt_free(&_own_cert);
+    mbedtls_pk_free(&_own_key);
+    mbedtls_ssl_cookie_free(&_cookie);
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_free(&_session_cache);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_free(&_ticket);
+#endif
+}
+
+nsapi_protocol_t DTLSSocket::get_proto()
+{
+    return NSAPI_UDP;
+}
+
+void DTLSSocket::event()
+{
+    // The stack signals the UDP socket, which passes it on
+    if (_callback) {
+        _callback();
+    }
+}
+
+nsapi_error_t DTLSSocket::open(NetworkStack *stack)
+{
+    return _udp.open(stack);
+}
+
+nsapi_error_t DTLSSocket::bind(uint16_t port)
+{
+    return _udp.bind(port);
+}
+
+nsapi_error_t DTLSSocket::bind(const char *address, uint16_t port)
+{
+    return _udp.bind(address, port);
+}
+
+nsapi_error_t DTLSSocket::bind(const SocketAddress &address)
+{
+    return _udp.bind(address);
+}
+
+nsapi_error_t DTLSSocket::setsockopt(int level, int optname, const void *optval, unsigned optlen)
+{
+    return _udp.setsockopt(level, optname, optval, optlen);
+}
+
+nsapi_error_t DTLSSocket::getsockopt(int level, int optname, void *optval, unsigned *optlen)
+{
+    return _udp.getsockopt(level, optname, optval, optlen);
+}
+
+nsapi_error_t DTLSSocket::set_root_ca_cert(const void *cert, size_t len)
+{
+    if (_conf_ready) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // Certificates that cannot be parsed are skipped, as long as some can
+    mbedtls_x509_crt_free(&_ca);
+    mbedtls_x509_crt_init(&_ca);
+    if (mbedtls_x509_crt_parse(&_ca, (const unsigned char *)cert, len) < 0 || !_ca.version) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t DTLSSocket::set_root_ca_cert(const char *cert)
+{
+    return set_root_ca_cert(cert, strlen(cert) + 1);
+}
+
+nsapi_error_t DTLSSocket::set_own_cert_key(const void *cert, size_t cert_len,
+        const void *key, size_t key_len)
+{
+    if (_conf_ready) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    mbedtls_x509_crt_free(&_own_cert);
+    mbedtls_x509_crt_init(&_own_cert);
+    mbedtls_pk_free(&_own_key);
+    mbedtls_pk_init(&_own_key);
+    if (mbedtls_x509_crt_parse(&_own_cert, (const unsigned char *)cert, cert_len) != 0 ||
+        mbedtls_pk_parse_key(&_own_key, (const unsigned char *)key, key_len, NULL, 0) != 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t DTLSSocket::set_hostname(const char *hostname)
+{
+    // Each connection sets the name on a fresh context, so it can
+    // change at any time
+    delete[] _hostname;
+    _hostname = 0;
+    if (hostname) {
+        _hostname = new char[strlen(hostname) + 1];
+        strcpy(_hostname, hostname);
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+void DTLSSocket::set_session_cache(TLSSessionCache *cache)
+{
+    _cache = cache;
+}
+
+void DTLSSocket::get_stats(nsapi_dtls_stats_t *stats) const
+{
+    *stats = _stats;
+}
+
+nsapi_error_t DTLSSocket::dtls_error(int ret)
+{
+    if (_bio_error) {
+        nsapi_error_t err = _bio_error;
+        _bio_error = NSAPI_ERROR_OK;
+        return err;
+    }
+
+    switch (ret) {
+        case MBEDTLS_ERR_SSL_WANT_READ:
+        case MBEDTLS_ERR_SSL_WANT_WRITE:
+            return NSAPI_ERROR_WOULD_BLOCK;
+        case MBEDTLS_ERR_X509_CERT_VERIFY_FAILED:
+            return NSAPI_ERROR_AUTH_FAILURE;
+        case MBEDTLS_ERR_SSL_ALLOC_FAILED:
+            return NSAPI_ERROR_NO_MEMORY;
+        case MBEDTLS_ERR_SSL_BAD_INPUT_DATA:
+            return NSAPI_ERROR_PARAMETER;
+        case MBEDTLS_ERR_SSL_TIMEOUT:
+        case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
+            return NSAPI_ERROR_NO_CONNECTION;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+nsapi_error_t DTLSSocket::setup(socket_role role)
+{
+    if (_conf_ready) {
+        return role == _role ? NSAPI_ERROR_OK : NSAPI_ERROR_PARAMETER;
+    }
+
+    // A server cannot do without a certificate
+    if (role == ROLE_SERVER && !_own_cert.version) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    int ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy,
+            (const unsigned char *)dtls_drbg_personalization,
+            sizeof(dtls_drbg_personalization));
+    if (ret != 0) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&_conf,
+            role == ROLE_SERVER ? MBEDTLS_SSL_IS_SERVER : MBEDTLS_SSL_IS_CLIENT,
+            MBEDTLS_SSL_TRANSPORT_DATAGRAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0) {
+        return dtls_error(ret);
+    }
+
+    mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+    mbedtls_ssl_conf_verify(&_conf, &DTLSSocket::ssl_verify, this);
+    if (_ca.version || role == ROLE_CLIENT) {
+        mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&_conf, &_ca, NULL);
+    }
+    if (_own_cert.version) {
+        ret = mbedtls_ssl_conf_own_cert(&_conf, &_own_cert, &_own_key);
+        if (ret != 0) {
+            return dtls_error(ret);
+        }
+    }
+
+    if (role == ROLE_SERVER) {
+        // The same cookies are checked before a peer is created and by
+        // mbed TLS when the peer handles the ClientHello
+        ret = mbedtls_ssl_cookie_setup(&_cookie, mbedtls_ctr_drbg_random, &_drbg);
+        if (ret != 0) {
+            return dtls_error(ret);
+        }
+        mbedtls_ssl_conf_dtls_cookies(&_conf, mbedtls_ssl_cookie_write,
+                mbedtls_ssl_cookie_check, &_cookie);
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+        mbedtls_ssl_cache_set_max_entries(&_session_cache,
+                MBED_CONF_NSAPI_DTLS_SESSION_CACHE_SIZE);
+        mbedtls_ssl_conf_session_cache(&_conf, &_session_cache,
+                mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+        ret = mbedtls_ssl_ticket_setup(&_ticket, mbedtls_ctr_drbg_random, &_drbg,
+                MBEDTLS_CIPHER_AES_128_GCM, DTLS_TICKET_LIFETIME);
+        if (ret != 0) {
+            return dtls_error(ret);
+        }
+        mbedtls_ssl_conf_session_tickets_cb(&_conf,
+                mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse, &_ticket);
+#endif
+    } else {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+    }
+
+    _role = role;
+    _conf_ready = true;
+    return NSAPI_ERROR_OK;
+}
+
+unsigned DTLSSocket::make_id(const SocketAddress &address, unsigned char *id)
+{
+    unsigned len = address.get_ip_version() == NSAPI_IPv6 ? NSAPI_IPv6_BYTES : NSAPI_IPv4_BYTES;
+    memcpy(id, address.get_ip_bytes(), len);
+    id[len++] = (unsigned char)(address.get_port() >> 8);
+    id[len++] = (unsigned char)address.get_port();
+    return len;
+}
+
+unsigned DTLSSocket::bucket(const unsigned char *id, unsigned id_len) const
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (unsigned i = 0; i < id_len; i++) {
+        hash = (hash ^ id[i]) * 16777619u;
+    }
+
+    return (hash ^ (hash >> 16)) & _bucket_mask;
+}
+
+DTLSSocket::peer *DTLSSocket::find(const unsigned char *id, unsigned id_len)
+{
+    for (peer *p = _buckets[bucket(id, id_len)]; p; p = p->next) {
+        if (p->id_len == id_len && memcmp(p->id, id, id_len) == 0) {
+            return p;
+        }
+    }
+
+    return 0;
+}
+
+DTLSSocket::peer *DTLSSocket::find(const SocketAddress &address)
+{
+    unsigned char id[MAX_ID];
+    unsigned id_len = make_id(address, id);
+    return find(id, id_len);
+}
+
+DTLSSocket::peer *DTLSSocket::add(const SocketAddress &address,
+        const unsigned char *id, unsigned id_len)
+{
+    // Take a free slot, otherwise the least recently active peer
+    peer *p = 0;
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_peers[i].state == PEER_FREE) {
+            p = &_peers[i];
+            break;
+        } else if (!p || _peers[i].last_active < p->last_active) {
+            p = &_peers[i];
+        }
+    }
+
+    if (!p) {
+        return 0;
+    }
+
+    if (p->state != PEER_FREE) {
+        _stats.evicted++;
+        release(p, true);
+    }
+
+    // The context only holds its buffers while the slot is in use
+    if (mbedtls_ssl_setup(&p->ssl, &_conf) != 0) {
+        mbedtls_ssl_free(&p->ssl);
+        mbedtls_ssl_init(&p->ssl);
+        return 0;
+    }
+
+    mbedtls_ssl_set_bio(&p->ssl, p, &DTLSSocket::ssl_send, &DTLSSocket::ssl_recv, NULL);
+    mbedtls_ssl_set_timer_cb(&p->ssl, p, &DTLSSocket::ssl_set_timer, &DTLSSocket::ssl_get_timer);
+    if (_role == ROLE_SERVER &&
+        mbedtls_ssl_set_client_transport_id(&p->ssl, id, id_len) != 0) {
+        mbedtls_ssl_free(&p->ssl);
+        mbedtls_ssl_init(&p->ssl);
+        return 0;
+    }
+
+    p->address = address;
+    memcpy(p->id, id, id_len);
+    p->id_len = id_len;
+    p->state = PEER_HANDSHAKE;
+    p->resumed = false;
+    p->session_offered = false;
+    p->last_active = ++_clock;
+    p->in = 0;
+    p->in_len = 0;
+    p->fin_ms = 0;
+
+    peer **head = &_buckets[bucket(id, id_len)];
+    p->next = *head;
+    *head = p;
+
+    _stats.peers++;
+    return p;
+}
+
+void DTLSSocket::release(peer *p, bool notify)
+{
+    if (notify && p->state == PEER_ESTABLISHED) {
+        // Best effort, the peer is released whether or not it is sent
+        _current = p;
+        mbedtls_ssl_close_notify(&p->ssl);
+        _bio_error = NSAPI_ERROR_OK;
+    }
+
+    for (peer **link = &_buckets[bucket(p->id, p->id_len)]; *link; link = &(*link)->next) {
+        if (*link == p) {
+            *link = p->next;
+            break;
+        }
+    }
+
+    // Frees the buffers, the session has been passed to the cache
+    mbedtls_ssl_free(&p->ssl);
+    mbedtls_ssl_init(&p->ssl);
+    p->timer.stop();
+    p->next = 0;
+    p->id_len = 0;
+    p->state = PEER_FREE;
+    p->in = 0;
+    p->fin_ms = 0;
+
+    if (_pending == p) {
+        _pending = 0;
+    }
+    if (_current == p) {
+        _current = 0;
+    }
+    _stats.peers--;
+}
+
+int DTLSSocket::ssl_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    peer *p = static_cast<peer *>(ctx);
+    DTLSSocket *socket = p->socket;
+    nsapi_size_or_error_t ret = socket->_udp.sendto(p->address, buf, len);
+    if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    } else if (ret < 0) {
+        // Keep the socket error so it can be returned instead of the
+        // generic one mbed TLS passes up
+        socket->_bio_error = ret;
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    return ret;
+}
+
+int DTLSSocket::ssl_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    // Datagrams are received by the socket and handed to the peer they
+    // are from, mbed TLS only sees them one at a time
+    peer *p = static_cast<peer *>(ctx);
+    if (!p->in) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    size_t size = p->in_len < len ? p->in_len : len;
+    memcpy(buf, p->in, size);
+    p->in = 0;
+    return size;
+}
+
+void DTLSSocket::ssl_set_timer(void *ctx, uint32_t int_ms, uint32_t fin_ms)
+{
+    peer *p = static_cast<peer *>(ctx);
+    p->int_ms = int_ms;
+    p->fin_ms = fin_ms;
+    p->timer.reset();
+    if (fin_ms) {
+        p->timer.start();
+    } else {
+        p->timer.stop();
+    }
+}
+
+int DTLSSocket::ssl_get_timer(void *ctx)
+{
+    peer *p = static_cast<peer *>(ctx);
+    if (!p->fin_ms) {
+        return -1;
+    }
+
+    uint32_t elapsed = p->timer.read_ms();
+    if (elapsed >= p->fin_ms) {
+        return 2;
+    } else if (elapsed >= p->int_ms) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int DTLSSocket::ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags)
+{
+    // mbed TLS only checks the name of the server certificate when one
+    // is set, without one any certificate from the CA would do
+    DTLSSocket *socket = static_cast<DTLSSocket *>(ctx);
+    if (socket->_role == ROLE_CLIENT && depth == 0 && !socket->_hostname) {
+        *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
+    }
+    return 0;
+}
+
+DTLSSocket::peer *DTLSSocket::hello(const SocketAddress &address,
+        const unsigned char *buf, size_t len)
+{
+    // Only an unfragmented ClientHello in epoch 0 can start a session
+    if (len < DTLS_RECORD_HEADER + DTLS_HANDSHAKE_HEADER ||
+        buf[0] != MBEDTLS_SSL_MSG_HANDSHAKE || buf[3] != 0 || buf[4] != 0) {
+        _stats.dropped++;
+        return 0;
+    }
+
+    // The record must hold the handshake header, and the ClientHello
+    // must fit in the record
+    size_t record_len = buf[11] << 8 | buf[12];
+    if (record_len < DTLS_HANDSHAKE_HEADER ||
+        record_len > len - DTLS_RECORD_HEADER) {
+        _stats.dropped++;
+        return 0;
+    }
+
+    const unsigned char *msg = buf + DTLS_RECORD_HEADER;
+    size_t msg_len = msg[1] << 16 | msg[2] << 8 | msg[3];
+    size_t frag_offset = msg[6] << 16 | msg[7] << 8 | msg[8];
+    size_t frag_len = msg[9] << 16 | msg[10] << 8 | msg[11];
+    if (msg[0] != MBEDTLS_SSL_HS_CLIENT_HELLO ||
+        frag_offset != 0 || frag_len != msg_len ||
+        msg_len > record_len - DTLS_HANDSHAKE_HEADER) {
+        _stats.dropped++;
+        return 0;
+    }
+
+    // client_version, random, session_id, cookie
+    const unsigned char *body = msg + DTLS_HANDSHAKE_HEADER;
+    size_t pos = 2 + 32;
+    if (pos + 1 > msg_len || body[pos] > 32) {
+        _stats.dropped++;
+        return 0;
+    }
+    pos += 1 + body[pos];
+    if (pos + 1 > msg_len || pos + 1 + body[pos] > msg_len) {
+        _stats.dropped++;
+        return 0;
+    }
+    const unsigned char *cookie = &body[pos + 1];
+    size_t cookie_len = body[pos];
+
+    unsigned char id[MAX_ID];
+    unsigned id_len = make_id(address, id);
+
+    // Without a valid cookie the client is sent one, and forgotten
+    if (cookie_len == 0 ||
+        mbedtls_ssl_cookie_check(&_cookie, cookie, cookie_len, id, id_len) != 0) {
+        uint16_t msg_seq = msg[4] << 8 | msg[5];
+        if (send_hello_verify(address, id, id_len, buf, msg_seq)) {
+            _stats.hello_verify++;
+        }
+        return 0;
+    }
+
+    peer *p = add(address, id, id_len);
+    if (!p) {
+        _stats.dropped++;
+    }
+    return p;
+}
+
+bool DTLSSocket::send_hello_verify(const SocketAddress &address,
+        const unsigned char *id, unsigned id_len,
+        const unsigned char *buf, uint16_t msg_seq)
+{
+    unsigned char out[DTLS_RECORD_HEADER + DTLS_HANDSHAKE_HEADER + 3 + 255];
+    unsigned char *msg = out + DTLS_RECORD_HEADER;
+    unsigned char *body = msg + DTLS_HANDSHAKE_HEADER;
+
+    // The cookie follows the server_version and its length byte
+    unsigned char *cookie = body + 3;
+    unsigned char *end = cookie;
+    if (mbedtls_ssl_cookie_write(&_cookie, &end, out + sizeof(out), id, id_len) != 0) {
+        return false;
+    }
+    size_t cookie_len = end - cookie;
+    size_t body_len = 3 + cookie_len;
+    size_t record_len = DTLS_HANDSHAKE_HEADER + body_len;
+
+    // Record in epoch 0, answering with the sequence number of the
+    // ClientHello as recommended by RFC 6347 section 4.2.1
+    out[0] = MBEDTLS_SSL_MSG_HANDSHAKE;
+    out[1] = 0xfe;
+    out[2] = 0xff;
+    memcpy(&out[3], &buf[3], 8);
+    out[11] = (unsigned char)(record_len >> 8);
+    out[12] = (unsigned char)record_len;
+
+    // Unfragmented HelloVerifyRequest reusing the message_seq of the
+    // ClientHello, RFC 6347 section 4.2.2
+    msg[0] = MBEDTLS_SSL_HS_HELLO_VERIFY_REQUEST;
+    msg[1] = msg[9] = 0;
+    msg[2] = msg[10] = (unsigned char)(body_len >> 8);
+    msg[3] = msg[11] = (unsigned char)body_len;
+    msg[4] = (unsigned char)(msg_seq >> 8);
+    msg[5] = (unsigned char)msg_seq;
+    msg[6] = msg[7] = msg[8] = 0;
+
+    // DTLS 1.0 is used in HelloVerifyRequests whatever the version
+    body[0] = 0xfe;
+    body[1] = 0xff;
+    body[2] = (unsigned char)cookie_len;
+
+    size_t len = DTLS_RECORD_HEADER + record_len;
+    return _udp.sendto(address, out, len) == (nsapi_size_or_error_t)len;
+}
+
+int DTLSSocket::handshake(peer *p)
+{
+    _current = p;
+
+    // Stepped like mbedtls_ssl_handshake, to see whether the hellos
+    // resumed the session before the handshake parameters are freed
+    int ret = 0;
+    while (p->ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+        ret = mbedtls_ssl_handshake_step(&p->ssl);
+        if (ret != 0) {
+            break;
+        }
+
+        if (p->ssl.handshake) {
+            p->resumed = p->ssl.handshake->resume != 0;
+        }
+    }
+    p->in = 0;
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        _bio_error = NSAPI_ERROR_OK;
+        return ret;
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED) {
+        // The cookie expired after it was checked, mbed TLS has sent a
+        // new one and the peer is forgotten as if it had not been valid
+        _stats.hello_verify++;
+        release(p, false);
+        return ret;
+    }
+
+    if (ret != 0) {
+        _handshake_error = dtls_error(ret);
+        _stats.failures++;
+
+        // Do not keep offering a session the server chokes on
+        if (p->session_offered && _cache) {
+            _cache->remove(_hostname ? _hostname : p->address.get_ip_address(),
+                    p->address.get_port());
+        }
+        release(p, false);
+        return ret;
+    }
+
+    // Store the session even when resumed, the server may have issued
+    // a new ticket
+    if (_role == ROLE_CLIENT && _cache) {
+        _cache->store(_hostname ? _hostname : p->address.get_ip_address(),
+                p->address.get_port(), &p->ssl);
+    }
+
+    _stats.handshakes++;
+    if (p->resumed) {
+        _stats.resumed++;
+    }
+
+    p->state = PEER_ESTABLISHED;
+    p->timer.stop();
+    return 0;
+}
+
+int DTLSSocket::read(peer *p, void *data, nsapi_size_t size)
+{
+    _current = p;
+    int ret = mbedtls_ssl_read(&p->ssl, (unsigned char *)data, size);
+    p->in = 0;
+
+    if (ret > 0) {
+        // The rest of the datagram may hold more records
+        _pending = p;
+        return ret;
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == 0) {
+        _bio_error = NSAPI_ERROR_OK;
+        return 0;
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_CLIENT_RECONNECT) {
+        // The client restarted from the same port with a valid cookie,
+        // mbed TLS has kept its ClientHello for a new handshake
+        p->state = PEER_HANDSHAKE;
+        p->resumed = false;
+        handshake(p);
+        return 0;
+    }
+
+    _bio_error = NSAPI_ERROR_OK;
+    _stats.closed++;
+    release(p, false);
+    return 0;
+}
+
+uint32_t DTLSSocket::run_timers()
+{
+    uint32_t next = osWaitForever;
+
+    for (unsigned i = 0; i < _capacity; i++) {
+        peer *p = &_peers[i];
+        if (p->state != PEER_HANDSHAKE || !p->fin_ms) {
+            continue;
+        }
+
+        // mbed TLS retransmits the last flight, or gives up, when its
+        // timer has expired
+        if ((uint32_t)p->timer.read_ms() >= p->fin_ms) {
+            handshake(p);
+            if (p->state != PEER_HANDSHAKE || !p->fin_ms) {
+                continue;
+            }
+        }
+
+        uint32_t elapsed = p->timer.read_ms();
+        uint32_t left = elapsed < p->fin_ms ? p->fin_ms - elapsed : 0;
+        if (left < next) {
+            next = left;
+        }
+    }
+
+    return next;
+}
+
+nsapi_size_or_error_t DTLSSocket::recv_datagram(SocketAddress *from,
+        mbed::Timer &timer, uint32_t timeout, bool *expired)
+{
+    uint32_t wait = run_timers();
+    uint32_t left = timeout;
+    if (timeout != osWaitForever) {
+        uint32_t elapsed = timer.read_ms();
+        left = elapsed < timeout ? timeout - elapsed : 0;
+    }
+
+    // Wake up for the next retransmission if it comes first. The timeout
+    // of the UDP socket is private, the socket's own covers whole calls
+    *expired = wait >= left;
+    uint32_t ms = wait < left ? wait : left;
+    _udp.set_timeout(ms == osWaitForever ? -1 : (int)ms);
+    return _udp.recvfrom(from, _buffer, MBED_CONF_NSAPI_DTLS_DATAGRAM_SIZE);
+}
+
+nsapi_error_t DTLSSocket::connect(const SocketAddress &address)
+{
+    nsapi_error_t err = setup(ROLE_CLIENT);
+    if (err) {
+        return err;
+    }
+
+    peer *p = find(address);
+    if (p && p->state == PEER_ESTABLISHED) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+
+    if (!p) {
+        // A client only talks to one server at a time
+        for (unsigned i = 0; i < _capacity; i++) {
+            if (_peers[i].state != PEER_FREE) {
+                release(&_peers[i], true);
+            }
+        }
+
+        unsigned char id[MAX_ID];
+        unsigned id_len = make_id(address, id);
+        p = add(address, id, id_len);
+        if (!p) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+
+        if (_hostname && mbedtls_ssl_set_hostname(&p->ssl, _hostname) != 0) {
+            release(p, false);
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+
+        p->session_offered = _cache && _cache->load(
+                _hostname ? _hostname : address.get_ip_address(),
+                address.get_port(), &p->ssl);
+        _handshake_error = NSAPI_ERROR_OK;
+
+        // Sends the ClientHello
+        handshake(p);
+    }
+
+    mbed::Timer timer;
+    timer.start();
+    uint32_t timeout = _timeout;
+
+    while (p->state == PEER_HANDSHAKE) {
+        SocketAddress from;
+        bool expired;
+        nsapi_size_or_error_t ret = recv_datagram(&from, timer, timeout, &expired);
+        if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+            if (expired && p->state == PEER_HANDSHAKE) {
+                return NSAPI_ERROR_WOULD_BLOCK;
+            }
+            continue;
+        } else if (ret < 0) {
+            return ret;
+        }
+
+        if (p->state != PEER_HANDSHAKE) {
+            break;
+        }
+
+        if (from != address) {
+            _stats.dropped++;
+            continue;
+        }
+
+        p->in = _buffer;
+        p->in_len = ret;
+        p->last_active = ++_clock;
+        handshake(p);
+    }
+
+    if (p->state != PEER_ESTABLISHED) {
+        return _handshake_error ? _handshake_error : NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    // Application data may have come with the last flight
+    _pending = p;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t DTLSSocket::sendto(const SocketAddress &address,
+        const void *data, nsapi_size_t size)
+{
+    peer *p = find(address);
+    if (!p || p->state != PEER_ESTABLISHED) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    _current = p;
+    p->last_active = ++_clock;
+    int ret = mbedtls_ssl_write(&p->ssl, (const unsigned char *)data, size);
+    if (ret < 0) {
+        return dtls_error(ret);
+    }
+
+    return ret;
+}
+
+nsapi_size_or_error_t DTLSSocket::recvfrom(SocketAddress *address,
+        void *data, nsapi_size_t size)
+{
+    // A socket that has not connected serves clients
+    if (!_conf_ready) {
+        nsapi_error_t err = setup(ROLE_SERVER);
+        if (err) {
+            return err;
+        }
+    }
+
+    mbed::Timer timer;
+    timer.start();
+    uint32_t timeout = _timeout;
+
+    while (true) {
+        // Records left over from the last datagram come first
+        if (_pending) {
+            peer *p = _pending;
+            _pending = 0;
+            int ret = read(p, data, size);
+            if (ret > 0) {
+                if (address) {
+                    *address = p->address;
+                }
+                return ret;
+            }
+        }
+
+        SocketAddress from;
+        bool expired;
+        nsapi_size_or_error_t ret = recv_datagram(&from, timer, timeout, &expired);
+        if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+            if (expired) {
+                return NSAPI_ERROR_WOULD_BLOCK;
+            }
+            continue;
+        } else if (ret < 0) {
+            return ret;
+        }
+
+        unsigned char id[MAX_ID];
+        unsigned id_len = make_id(from, id);
+        peer *p = find(id, id_len);
+        if (!p) {
+            if (_role != ROLE_SERVER) {
+                _stats.dropped++;
+                continue;
+            }
+
+            p = hello(from, _buffer, ret);
+            if (!p) {
+                continue;
+            }
+        }
+
+        p->in = _buffer;
+        p->in_len = ret;
+        p->last_active = ++_clock;
+
+        if (p->state == PEER_HANDSHAKE) {
+            if (handshake(p) == 0) {
+                _pending = p;
+            }
+            continue;
+        }
+
+        int len = read(p, data, size);
+        if (len > 0) {
+            if (address) {
+                *address = p->address;
+            }
+            return len;
+        }
+    }
+}
+
+nsapi_error_t DTLSSocket::close_peer(const SocketAddress &address)
+{
+    peer *p = find(address);
+    if (!p) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    if (p->state == PEER_ESTABLISHED) {
+        _stats.closed++;
+    }
+    release(p, true);
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t DTLSSocket::close()
+{
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_peers[i].state != PEER_FREE) {
+            if (_peers[i].state == PEER_ESTABLISHED) {
+                _stats.closed++;
+            }
+            release(&_peers[i], true);
+        }
+    }
+
+    _pending = 0;
+    _bio_error = NSAPI_ERROR_OK;
+    return _udp.close();
+}
+
+#endif
@@ -0,0 +1,406 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* DTLSSocket
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DTLSSOCKET_H
+#define DTLSSOCKET_H
+
+#include "netsocket/UDPSocket.h"
+#include "netsocket/TLSSocket.h"
+#include "Timer.h"
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cookie.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_X509_CRT_PARSE_C) && \
+    defined(MBEDTLS_CTR_DRBG_C) && defined(MBEDTLS_ENTROPY_C) && \
+    defined(MBEDTLS_SSL_PROTO_DTLS) && defined(MBEDTLS_SSL_SRV_C) && \
+    defined(MBEDTLS_SSL_COOKIE_C) && defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY)
+
+
+/** Counters of a DTLS socket
+ */
+typedef struct nsapi_dtls_stats {
+    unsigned peers;             /*!< peers currently in the peer table */
+    unsigned hello_verify;      /*!< HelloVerifyRequests sent without keeping state */
+    unsigned handshakes;        /*!< handshakes completed */
+    unsigned resumed;           /*!< handshakes that resumed a session */
+    unsigned failures;          /*!< handshakes that failed or timed out */
+    unsigned closed;            /*!< established peers that were closed */
+    unsigned evicted;           /*!< peers evicted to make room for a new one */
+    unsigned dropped;           /*!< datagrams dropped as invalid or unexpected */
+} nsapi_dtls_stats_t;
+
+
+/** DTLS socket
+ *
+ *  Runs DTLS with mbed TLS over a UDP socket. A bound socket acts as a
+ *  server for any number of clients, while a socket that connects to an
+ *  address acts as a client of that server.
+ *
+ *  As a server the socket keeps a table of peers, hashed on the address
+ *  and port of each client, so a datagram finds its peer in constant
+ *  time. ClientHellos are answered with a HelloVerifyRequest carrying a
+ *  cookie before any state is kept, so only clients that prove they own
+ *  their address take a slot in the table, and the mbed TLS context of a
+ *  slot only holds its buffers while in use. When the table is full the
+ *  least recently active peer is evicted. Sessions are kept in a server
+ *  side session cache and issued as session tickets, so evicted peers
+ *  reconnect with a resumed handshake.
+ *
+ *  As a client, the server certificate is verified against the name set
+ *  with set_hostname, and sessions are stored in a TLSSessionCache and
+ *  offered on the next connection to the same server.
+ *
+ *  The UDP socket is private to the socket, so datagrams can only be sent
+ *  and received through DTLS. Socket calls such as bind, setsockopt and
+ *  attach apply to the UDP socket, also when made through a Socket
+ *  pointer. The timeout set with set_timeout applies to connect and
+ *  recvfrom as a whole.
+ *
+ *  recvfrom drives the handshakes and retransmissions of every peer and
+ *  only returns application data. It needs to be called regularly, even
+ *  by a socket that mostly sends.
+ *
+ *  Only one thread may use a DTLS socket at a time.
+ */
+class DTLSSocket : public Socket {
+public:
+    /** Create an uninitialized socket
+     *
+     *  Must call open to initialize the socket on a network stack.
+     *
+     *  @param capacity Maximum number of peers of a server
+     *                  (defaults to nsapi.dtls-peer-max)
+     */
+    DTLSSocket(unsigned capacity = MBED_CONF_NSAPI_DTLS_PEER_MAX);
+
+    /** Create a socket on a network interface
+     *
+     *  Creates and opens a socket on the network stack of the given
+     *  network interface.
+     *
+     *  @param stack    Network stack as target for socket
+     *  @param capacity Maximum number of peers of a server
+     *                  (defaults to nsapi.dtls-peer-max)
+     */
+    template <typename S>
+    DTLSSocket(S *stack, unsigned capacity = MBED_CONF_NSAPI_DTLS_PEER_MAX)
+    {
+        init(capacity);
+        open(stack);
+    }
+
+    /** Destroy a socket
+     *
+     *  Closes socket if the socket is still open
+     */
+    virtual ~DTLSSocket();
+
+    /** Opens a socket
+     *
+     *  Creates the UDP socket on the network stack of the given network
+     *  interface. Not needed if stack is passed to the socket's
+     *  constructor.
+     *
+     *  @param stack    Network stack as target for socket
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t open(NetworkStack *stack);
+
+    template <typename S>
+    nsapi_error_t open(S *stack) {
+        return open(nsapi_create_stack(stack));
+    }
+
+    /** Bind a specific address to the UDP socket
+     *
+     *  A server binds to the port its clients connect to.
+     *
+     *  @param port     Local port to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    nsapi_error_t bind(uint16_t port);
+
+    /** Bind a specific address to the UDP socket
+     *
+     *  @param address  Null-terminated local address to bind
+     *  @param port     Local port to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    nsapi_error_t bind(const char *address, uint16_t port);
+
+    /** Bind a specific address to the UDP socket
+     *
+     *  @param address  Local address to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    virtual nsapi_error_t bind(const SocketAddress &address);
+
+    /*  Set options of the UDP socket
+     *
+     *  @param level    Stack level, see @ref nsapi_socket_level
+     *  @param optname  Level-specific option name
+     *  @param optval   Option value
+     *  @param optlen   Length of the option value
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t setsockopt(int level, int optname, const void *optval, unsigned optlen);
+
+    /*  Get options of the UDP socket
+     *
+     *  @param level    Stack level, see @ref nsapi_socket_level
+     *  @param optname  Level-specific option name
+     *  @param optval   Destination for option value
+     *  @param optlen   Length of the option value
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen);
+
+    /** Set the root CA certificates used to verify the peer
+     *
+     *  Required for a client. A server with root CA certificates requires
+     *  clients to authenticate with a certificate. Must be called before
+     *  the first handshake.
+     *
+     *  @param cert     PEM or DER certificates, PEM must be null terminated
+     *  @param len      Length of the certificates in bytes, including the
+     *                  null terminator for PEM
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_root_ca_cert(const void *cert, size_t len);
+
+    /** Set the root CA certificates used to verify the peer
+     *
+     *  @param cert     Null terminated PEM certificates
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_root_ca_cert(const char *cert);
+
+    /** Set the certificate and key of the socket
+     *
+     *  Required for a server. Must be called before the first handshake.
+     *
+     *  @param cert     PEM or DER certificate chain
+     *  @param cert_len Length of the certificate in bytes, including the
+     *                  null terminator for PEM
+     *  @param key      PEM or DER private key
+     *  @param key_len  Length of the key in bytes, including the null
+     *                  terminator for PEM
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_own_cert_key(const void *cert, size_t cert_len,
+            const void *key, size_t key_len);
+
+    /** Set the server name used by a client
+     *
+     *  The name is sent in the server name indication extension and must
+     *  match the server certificate. Required for a client, verification
+     *  fails without a name.
+     *
+     *  @param hostname Server name, copied by the socket
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_hostname(const char *hostname);
+
+    /** Set the session cache used by a client
+     *
+     *  Sockets use the cache returned by TLSSessionCache::get_default
+     *  unless set otherwise. Passing null disables resumption.
+     *
+     *  @param cache    Session cache, must outlive the socket
+     */
+    void set_session_cache(TLSSessionCache *cache);
+
+    /** Connects to a DTLS server
+     *
+     *  Performs the handshake with the server, after which the socket is
+     *  a client and only exchanges datagrams with that server. The server
+     *  name must be set with set_hostname first.
+     *
+     *  @param address  The SocketAddress of the server
+     *  @return         0 on success, negative error code on failure
+     *                  NSAPI_ERROR_AUTH_FAILURE indicates the server
+     *                  certificate could not be verified
+     */
+    nsapi_error_t connect(const SocketAddress &address);
+
+    /** Send data to a peer
+     *
+     *  The handshake with the peer must be complete.
+     *
+     *  @param address  The SocketAddress of the peer
+     *  @param data     Buffer of data to send to the peer
+     *  @param size     Size of the buffer in bytes
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure, NSAPI_ERROR_NO_CONNECTION if there
+     *                  is no established peer at the address
+     */
+    nsapi_size_or_error_t sendto(const SocketAddress &address,
+            const void *data, nsapi_size_t size);
+
+    /** Receive data from any peer
+     *
+     *  Handshakes, retransmissions and alerts are handled while waiting,
+     *  and only decrypted application data is returned. The socket
+     *  timeout applies to the call as a whole.
+     *
+     *  @param address  Destination for the address of the peer, may be null
+     *  @param data     Destination buffer for the data
+     *  @param size     Size of the buffer in bytes
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recvfrom(SocketAddress *address,
+            void *data, nsapi_size_t size);
+
+    /** Close the session with a peer
+     *
+     *  Sends a close notification if the handshake completed and frees
+     *  the slot of the peer. Its session remains available for resumption.
+     *
+     *  @param address  The SocketAddress of the peer
+     *  @return         0 on success, NSAPI_ERROR_NO_CONNECTION if the
+     *                  address is not a peer
+     */
+    nsapi_error_t close_peer(const SocketAddress &address);
+
+    /** Close the socket
+     *
+     *  Closes the sessions of all peers, then closes the UDP socket. The
+     *  socket keeps its configuration and can be opened again.
+     *
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t close();
+
+    /** Get the counters of the socket
+     *
+     *  @param stats    Destination for the counters
+     */
+    void get_stats(nsapi_dtls_stats_t *stats) const;
+
+protected:
+    /* Largest client transport ID, an IPv6 address and a port */
+    static const unsigned MAX_ID = NSAPI_IPv6_BYTES + 2;
+
+    struct peer {
+        peer *next;                 // next peer in the same hash bucket
+        DTLSSocket *socket;
+        SocketAddress address;
+        unsigned char id[MAX_ID];
+        uint8_t id_len;
+        uint8_t state;
+        bool resumed;
+        bool session_offered;
+        unsigned last_active;
+        const unsigned char *in;    // datagram waiting to be read by mbed TLS
+        size_t in_len;
+        mbed::Timer timer;
+        uint32_t int_ms;
+        uint32_t fin_ms;
+        mbedtls_ssl_context ssl;
+    };
+
+    enum peer_state {
+        PEER_FREE,
+        PEER_HANDSHAKE,
+        PEER_ESTABLISHED,
+    };
+
+    enum socket_role {
+        ROLE_NONE,
+        ROLE_SERVER,
+        ROLE_CLIENT,
+    };
+
+    virtual nsapi_protocol_t get_proto();
+    virtual void event();
+
+    void init(unsigned capacity);
+    nsapi_error_t setup(socket_role role);
+    nsapi_error_t dtls_error(int ret);
+
+    static unsigned make_id(const SocketAddress &address, unsigned char *id);
+    unsigned bucket(const unsigned char *id, unsigned id_len) const;
+    peer *find(const SocketAddress &address);
+    peer *find(const unsigned char *id, unsigned id_len);
+    peer *add(const SocketAddress &address, const unsigned char *id, unsigned id_len);
+    void release(peer *p, bool notify);
+
+    peer *hello(const SocketAddress &address, const unsigned char *buf, size_t len);
+    bool send_hello_verify(const SocketAddress &address,
+            const unsigned char *id, unsigned id_len,
+            const unsigned char *buf, uint16_t msg_seq);
+    int handshake(peer *p);
+    int read(peer *p, void *data, nsapi_size_t size);
+    uint32_t run_timers();
+    nsapi_size_or_error_t recv_datagram(SocketAddress *from,
+            mbed::Timer &timer, uint32_t timeout, bool *expired);
+
+    static int ssl_send(void *ctx, const unsigned char *buf, size_t len);
+    static int ssl_recv(void *ctx, unsigned char *buf, size_t len);
+    static void ssl_set_timer(void *ctx, uint32_t int_ms, uint32_t fin_ms);
+    static int ssl_get_timer(void *ctx);
+    static int ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags);
+
+    UDPSocket _udp;
+    peer *_peers;
+    peer **_buckets;
+    unsigned _capacity;
+    unsigned _bucket_mask;
+    unsigned _clock;
+    peer *_current;             // peer mbed TLS is working on
+    peer *_pending;             // peer that may hold more records
+    socket_role _role;
+    bool _conf_ready;
+    nsapi_error_t _bio_error;
+    nsapi_error_t _handshake_error;
+    char *_hostname;
+    TLSSessionCache *_cache;
+    nsapi_dtls_stats_t _stats;
+    unsigned char *_buffer;
+
+    mbedtls_ssl_config _conf;
+    mbedtls_entropy_context _entropy;
+    mbedtls_ctr_drbg_context _drbg;
+    mbedtls_x509_crt _ca;
+    mbedtls_x509_crt _own_cert;
+    mbedtls_pk_context _own_key;
+    mbedtls_ssl_cookie_ctx _cookie;
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_context _session_cache;
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_context _ticket;
+#endif
+
+private:
+    /* Disallow copy constructor and assignment operators */
+    DTLSSocket(const DTLSSocket &);
+    DTLSSocket &operator=(const DTLSSocket &);
+};
+
+
+#endif
+
+#endif
+
+/** @}*/
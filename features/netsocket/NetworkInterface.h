@@ -22,6 +22,7 @@
 
 #include "netsocket/nsapi_types.h"
 #include "netsocket/SocketAddress.h"
+#include "platform/Callback.h"
 
 // Predeclared class
 class NetworkStack;
@@ -35,6 +36,13 @@ class NetworkInterface {
 public:
     virtual ~NetworkInterface() {};
 
+    /** Hostname translation callback for asynchronous gethostbyname
+     *
+     *  @param result   0 on success, negative error code on failure
+     *  @param address  Resolved address, or null on failure
+     */
+    typedef mbed::Callback<void (nsapi_error_t result, SocketAddress *address)> hostbyname_cb_t;
+
     /** Get the local MAC address
      *
      *  Provided MAC address is intended for info or debug purposes and
@@ -121,6 +129,35 @@ public:
     virtual nsapi_error_t gethostbyname(const char *host,
             SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
 
+    /** Translates a hostname to an IP address without blocking
+     *
+     *  The hostname may be either a domain name or an IP address. If the
+     *  hostname is an IP address or the answer is already cached, the
+     *  callback is called before this function returns and 0 is returned.
+     *  Otherwise the query is sent to the DNS servers in the background
+     *  and the callback is called once the first server answers.
+     *
+     *  @param host     Hostname to resolve
+     *  @param callback Callback that is called with the result
+     *  @param version  IP version of address to resolve, NSAPI_UNSPEC indicates
+     *                  version is chosen by the stack (defaults to NSAPI_UNSPEC)
+     *  @return         0 if the callback was already called, a positive
+     *                  unique id of the query that can be passed to
+     *                  gethostbyname_async_cancel, or a negative error code
+     *                  on failure
+     */
+    virtual nsapi_value_or_error_t gethostbyname_async(const char *host,
+            hostbyname_cb_t callback, nsapi_version_t version = NSAPI_UNSPEC);
+
+    /** Cancels an asynchronous hostname translation
+     *
+     *  Once this returns the callback of the query is not called.
+     *
+     *  @param id       Unique id of the query
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t gethostbyname_async_cancel(int id);
+
     /** Add a domain name server to list of servers to query
      *
      *  @param addr     Destination for the host address
@@ -45,11 +45,194 @@ nsapi_error_t NetworkStack::gethostbyname(const char *name, SocketAddress *addre
     return nsapi_dns_query(this, name, address, version);
 }
 
+nsapi_value_or_error_t NetworkStack::gethostbyname_async(const char *name, hostbyname_cb_t callback, nsapi_version_t version)
+{
+    // check for simple ip addresses
+    SocketAddress address;
+    if (address.set_ip_address(name)) {
+        if (version != NSAPI_UNSPEC && address.get_ip_version() != version) {
+            callback(NSAPI_ERROR_DNS_FAILURE, NULL);
+        } else {
+            callback(NSAPI_ERROR_OK, &address);
+        }
+
+        return NSAPI_ERROR_OK;
+    }
+
+    // if the version is unspecified, try to guess the version from the
+    // ip address of the underlying stack
+    if (version == NSAPI_UNSPEC) {
+        SocketAddress testaddress;
+        if (testaddress.set_ip_address(this->get_ip_address())) {
+            version = testaddress.get_ip_version();
+        }
+    }
+
+    return nsapi_dns_query_async(this, name, callback, version);
+}
+
+nsapi_error_t NetworkStack::gethostbyname_async_cancel(int id)
+{
+    return nsapi_dns_query_async_cancel(id);
+}
+
 nsapi_error_t NetworkStack::add_dns_server(const SocketAddress &address)
 {
     return nsapi_dns_add_server(address);
 }
 
+nsapi_size_or_error_t NetworkStack::socket_send_nocopy(nsapi_socket_t handle, const void *data, nsapi_size_t size, mbed::Callback<void()> complete)
+{
+    nsapi_size_or_error_t ret = socket_send(handle, data, size);
+    if (ret > 0 && complete) {
+        complete();
+    }
+
+    return ret;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_sendmsg(nsapi_socket_t handle, const SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt)
+{
+    nsapi_size_t size = 0;
+    for (unsigned i = 0; i < iovcnt; i++) {
+        size += iov[i].iov_len;
+    }
+
+    // a single buffer needs no gathering
+    const void *data = iovcnt ? iov[0].iov_base : 0;
+    uint8_t *buffer = 0;
+    if (iovcnt > 1) {
+        buffer = (uint8_t *)malloc(size);
+        if (!buffer) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+
+        nsapi_size_t offset = 0;
+        for (unsigned i = 0; i < iovcnt; i++) {
+            memcpy(&buffer[offset], iov[i].iov_base, iov[i].iov_len);
+            offset += iov[i].iov_len;
+        }
+        data = buffer;
+    }
+
+    nsapi_size_or_error_t ret;
+    if (address) {
+        ret = socket_sendto(handle, *address, data, size);
+    } else {
+        ret = socket_send(handle, data, size);
+    }
+
+    free(buffer);
+    return ret;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvmsg(nsapi_socket_t handle, SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt)
+{
+    nsapi_size_t size = 0;
+    for (unsigned i = 0; i < iovcnt; i++) {
+        size += iov[i].iov_len;
+    }
+
+    // a single buffer needs no scattering
+    void *data = iovcnt ? iov[0].iov_base : 0;
+    uint8_t *buffer = 0;
+    if (iovcnt > 1) {
+        buffer = (uint8_t *)malloc(size);
+        if (!buffer) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+        data = buffer;
+    }
+
+    nsapi_size_or_error_t ret;
+    if (address) {
+        ret = socket_recvfrom(handle, address, data, size);
+    } else {
+        ret = socket_recv(handle, data, size);
+    }
+
+    if (buffer && ret > 0) {
+        nsapi_size_t offset = 0;
+        for (unsigned i = 0; i < iovcnt && offset < (nsapi_size_t)ret; i++) {
+            nsapi_size_t len = iov[i].iov_len;
+            if (len > ret - offset) {
+                len = ret - offset;
+            }
+
+            memcpy(iov[i].iov_base, &buffer[offset], len);
+            offset += len;
+        }
+    }
+
+    free(buffer);
+    return ret;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_sendto_many(nsapi_socket_t handle, nsapi_datagram_t *msgs, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        SocketAddress address(msgs[i].addr, msgs[i].port);
+        nsapi_size_or_error_t ret = socket_sendto(handle, address, msgs[i].data, msgs[i].size);
+        if (ret < 0) {
+            return i ? (nsapi_size_or_error_t)i : ret;
+        }
+    }
+
+    return count;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvfrom_many(nsapi_socket_t handle, nsapi_datagram_t *msgs, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        SocketAddress address;
+        nsapi_size_or_error_t ret = socket_recvfrom(handle, &address, msgs[i].data, msgs[i].size);
+        if (ret < 0) {
+            return i ? (nsapi_size_or_error_t)i : ret;
+        }
+
+        msgs[i].addr = address.get_addr();
+        msgs[i].port = address.get_port();
+        msgs[i].length = ret;
+    }
+
+    return count;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recv_chain(nsapi_socket_t handle, SocketAddress *address, nsapi_chain_t *chain)
+{
+    void *buffer = malloc(MBED_CONF_NSAPI_RECV_CHAIN_COPY_SIZE);
+    if (!buffer) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_size_or_error_t ret;
+    if (address) {
+        ret = socket_recvfrom(handle, address, buffer, MBED_CONF_NSAPI_RECV_CHAIN_COPY_SIZE);
+    } else {
+        ret = socket_recv(handle, buffer, MBED_CONF_NSAPI_RECV_CHAIN_COPY_SIZE);
+    }
+
+    if (ret < 0) {
+        free(buffer);
+        return ret;
+    }
+
+    chain->segment[0].data = buffer;
+    chain->segment[0].size = ret;
+    chain->count = 1;
+    chain->size = ret;
+    chain->token = buffer;
+    return ret;
+}
+
+void NetworkStack::socket_recv_release(nsapi_socket_t handle, nsapi_chain_t *chain)
+{
+    free(chain->token);
+    chain->token = 0;
+    chain->count = 0;
+    chain->size = 0;
+}
+
 nsapi_error_t NetworkStack::setstackopt(int level, int optname, const void *optval, unsigned optlen)
 {
     return NSAPI_ERROR_UNSUPPORTED;
@@ -71,6 +254,15 @@ nsapi_error_t NetworkStack::getsockopt(void *handle, int level, int optname, voi
 }
 
 
+// Completion of a zero-copy send through the C api
+static void nsapi_send_nocopy_complete(void *context)
+{
+    mbed::Callback<void()> *complete = static_cast<mbed::Callback<void()> *>(context);
+    (*complete)();
+    delete complete;
+}
+
+
 // NetworkStackWrapper class for encapsulating the raw nsapi_stack structure
 class NetworkStackWrapper : public NetworkStack
 {
@@ -212,6 +404,26 @@ protected:
         return _stack_api()->socket_send(_stack(), socket, data, size);
     }
 
+    virtual nsapi_size_or_error_t socket_send_nocopy(nsapi_socket_t socket, const void *data, nsapi_size_t size, mbed::Callback<void()> complete)
+    {
+        if (!_stack_api()->socket_send_nocopy) {
+            return NetworkStack::socket_send_nocopy(socket, data, size, complete);
+        }
+
+        mbed::Callback<void()> *context = 0;
+        if (complete) {
+            context = new mbed::Callback<void()>(complete);
+        }
+
+        nsapi_size_or_error_t ret = _stack_api()->socket_send_nocopy(_stack(), socket,
+                data, size, context ? nsapi_send_nocopy_complete : 0, context);
+        if (ret <= 0) {
+            delete context;
+        }
+
+        return ret;
+    }
+
     virtual nsapi_size_or_error_t socket_recv(nsapi_socket_t socket, void *data, nsapi_size_t size)
     {
         if (!_stack_api()->socket_recv) {
@@ -249,6 +461,87 @@ protected:
         return err;
     }
 
+    virtual nsapi_size_or_error_t socket_sendmsg(nsapi_socket_t socket, const SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt)
+    {
+        if (!_stack_api()->socket_sendmsg) {
+            return NetworkStack::socket_sendmsg(socket, address, iov, iovcnt);
+        }
+
+        if (!address) {
+            return _stack_api()->socket_sendmsg(_stack(), socket, 0, 0, iov, iovcnt);
+        }
+
+        nsapi_addr_t addr = address->get_addr();
+        return _stack_api()->socket_sendmsg(_stack(), socket, &addr, address->get_port(), iov, iovcnt);
+    }
+
+    virtual nsapi_size_or_error_t socket_recvmsg(nsapi_socket_t socket, SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt)
+    {
+        if (!_stack_api()->socket_recvmsg) {
+            return NetworkStack::socket_recvmsg(socket, address, iov, iovcnt);
+        }
+
+        nsapi_addr_t addr = {NSAPI_IPv4, 0};
+        uint16_t port = 0;
+
+        nsapi_size_or_error_t err = _stack_api()->socket_recvmsg(_stack(), socket,
+                address ? &addr : 0, &port, iov, iovcnt);
+
+        if (address) {
+            address->set_addr(addr);
+            address->set_port(port);
+        }
+
+        return err;
+    }
+
+    virtual nsapi_size_or_error_t socket_sendto_many(nsapi_socket_t socket, nsapi_datagram_t *msgs, unsigned count)
+    {
+        if (!_stack_api()->socket_sendto_many) {
+            return NetworkStack::socket_sendto_many(socket, msgs, count);
+        }
+
+        return _stack_api()->socket_sendto_many(_stack(), socket, msgs, count);
+    }
+
+    virtual nsapi_size_or_error_t socket_recvfrom_many(nsapi_socket_t socket, nsapi_datagram_t *msgs, unsigned count)
+    {
+        if (!_stack_api()->socket_recvfrom_many) {
+            return NetworkStack::socket_recvfrom_many(socket, msgs, count);
+        }
+
+        return _stack_api()->socket_recvfrom_many(_stack(), socket, msgs, count);
+    }
+
+    virtual nsapi_size_or_error_t socket_recv_chain(nsapi_socket_t socket, SocketAddress *address, nsapi_chain_t *chain)
+    {
+        if (!_stack_api()->socket_recv_chain || !_stack_api()->socket_recv_release) {
+            return NetworkStack::socket_recv_chain(socket, address, chain);
+        }
+
+        nsapi_addr_t addr = {NSAPI_IPv4, 0};
+        uint16_t port = 0;
+
+        nsapi_size_or_error_t err = _stack_api()->socket_recv_chain(_stack(), socket,
+                address ? &addr : 0, &port, chain);
+
+        if (address) {
+            address->set_addr(addr);
+            address->set_port(port);
+        }
+
+        return err;
+    }
+
+    virtual void socket_recv_release(nsapi_socket_t socket, nsapi_chain_t *chain)
+    {
+        if (!_stack_api()->socket_recv_chain || !_stack_api()->socket_recv_release) {
+            return NetworkStack::socket_recv_release(socket, chain);
+        }
+
+        _stack_api()->socket_recv_release(_stack(), socket, chain);
+    }
+
     virtual void socket_attach(nsapi_socket_t socket, void (*callback)(void *), void *data)
     {
         if (!_stack_api()->socket_attach) {
@@ -37,6 +37,10 @@ class NetworkStack
 public:
     virtual ~NetworkStack() {};
 
+    /** Hostname translation callback, see NetworkInterface::hostbyname_cb_t
+     */
+    typedef NetworkInterface::hostbyname_cb_t hostbyname_cb_t;
+
     /** Get the local IP address
      *
      *  @return         Null-terminated representation of the local IP address
@@ -61,6 +65,38 @@ public:
     virtual nsapi_error_t gethostbyname(const char *host,
             SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
 
+    /** Translates a hostname to an IP address without blocking
+     *
+     *  The hostname may be either a domain name or an IP address. If the
+     *  hostname is an IP address or the answer is already cached, the
+     *  callback is called before this function returns and 0 is returned.
+     *
+     *  If no stack-specific DNS resolution is provided, the query is sent
+     *  to all configured DNS servers from a UDP socket on the stack, with
+     *  staggered starts, and the first answer completes the query. The
+     *  callback is then called from the context of the DNS event queue.
+     *
+     *  @param host     Hostname to resolve
+     *  @param callback Callback that is called with the result
+     *  @param version  IP version of address to resolve, NSAPI_UNSPEC indicates
+     *                  version is chosen by the stack (defaults to NSAPI_UNSPEC)
+     *  @return         0 if the callback was already called, a positive
+     *                  unique id of the query that can be passed to
+     *                  gethostbyname_async_cancel, or a negative error code
+     *                  on failure
+     */
+    virtual nsapi_value_or_error_t gethostbyname_async(const char *host,
+            hostbyname_cb_t callback, nsapi_version_t version = NSAPI_UNSPEC);
+
+    /** Cancels an asynchronous hostname translation
+     *
+     *  Once this returns the callback of the query is not called.
+     *
+     *  @param id       Unique id of the query
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t gethostbyname_async_cancel(int id);
+
     /** Add a domain name server to list of servers to query
      *
      *  @param addr     Destination for the host address
@@ -201,6 +237,29 @@ protected:
     virtual nsapi_size_or_error_t socket_send(nsapi_socket_t handle,
             const void *data, nsapi_size_t size) = 0;
 
+    /** Send data over a TCP socket without copying it
+     *
+     *  Like socket_send, but the stack keeps references to the sent bytes
+     *  of the buffer until they are acknowledged by the remote host, then
+     *  calls the complete callback. The callback is not called if no bytes
+     *  were sent.
+     *
+     *  By default the data is copied with socket_send and the callback is
+     *  called before returning.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param data     Buffer of data to send to the host
+     *  @param size     Size of the buffer in bytes
+     *  @param complete Callback called once the sent bytes can be reused
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_send_nocopy(nsapi_socket_t handle,
+            const void *data, nsapi_size_t size, mbed::Callback<void()> complete);
+
     /** Receive data over a TCP socket
      *
      *  The socket must be connected to a remote host. Returns the number of
@@ -254,6 +313,124 @@ protected:
     virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
             void *buffer, nsapi_size_t size) = 0;
 
+    /** Send data gathered from several buffers
+     *
+     *  Sends the buffers in order as if they were one contiguous buffer.
+     *  For a TCP socket, pass a NULL address. For a UDP socket, the
+     *  buffers form a single datagram sent to address.
+     *
+     *  By default the buffers are gathered into one temporary buffer
+     *  that is passed to socket_send or socket_sendto.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param address  The SocketAddress of the remote host, or NULL
+     *  @param iov      Array of buffers to send
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_sendmsg(nsapi_socket_t handle,
+            const SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Receive data scattered into several buffers
+     *
+     *  Fills the buffers in order as if they were one contiguous buffer.
+     *  For a TCP socket, pass a NULL address. For a UDP socket, the source
+     *  of the datagram is stored in address.
+     *
+     *  By default the data is received into one temporary buffer with
+     *  socket_recv or socket_recvfrom and scattered from there.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address of a UDP socket,
+     *                  or NULL for a TCP socket
+     *  @param iov      Array of buffers to receive into
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recvmsg(nsapi_socket_t handle,
+            SocketAddress *address, const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Send several datagrams over a UDP socket
+     *
+     *  Sends the datagrams in order, each of length size to the address
+     *  and port of its descriptor, until one would block or fails.
+     *
+     *  By default each datagram is passed to socket_sendto.
+     *
+     *  This call is non-blocking. If the first send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of datagrams sent on success, negative error
+     *                  code if no datagram could be sent
+     */
+    virtual nsapi_size_or_error_t socket_sendto_many(nsapi_socket_t handle,
+            nsapi_datagram_t *msgs, unsigned count);
+
+    /** Receive several datagrams over a UDP socket
+     *
+     *  Takes the datagrams already queued on the socket, up to count, and
+     *  fills in the address, port and length of each descriptor.
+     *
+     *  By default socket_recvfrom is called until it would block.
+     *
+     *  This call is non-blocking. If no datagram is queued,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param msgs     Array of datagrams to receive into
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of datagrams received on success, negative
+     *                  error code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recvfrom_many(nsapi_socket_t handle,
+            nsapi_datagram_t *msgs, unsigned count);
+
+    /** Receive data without copying it
+     *
+     *  Fills the chain with read-only views of the received data held
+     *  by the stack. For a TCP socket, pass a NULL address; the data not
+     *  covered by the chain remains for the next receive. For a UDP
+     *  socket, the chain holds one datagram and its source is stored in
+     *  address.
+     *
+     *  The chain must be released with socket_recv_release whenever
+     *  this returns a non-negative size.
+     *
+     *  By default the data is copied with socket_recv or socket_recvfrom
+     *  into a buffer of nsapi.recv-chain-copy-size bytes that is released
+     *  with the chain.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address of a UDP socket,
+     *                  or NULL for a TCP socket
+     *  @param chain    Destination for the received segments
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recv_chain(nsapi_socket_t handle,
+            SocketAddress *address, nsapi_chain_t *chain);
+
+    /** Release a chain returned by socket_recv_chain
+     *
+     *  @param handle   Socket handle
+     *  @param chain    Chain to release
+     */
+    virtual void socket_recv_release(nsapi_socket_t handle, nsapi_chain_t *chain);
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
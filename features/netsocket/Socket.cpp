@@ -149,6 +149,17 @@ nsapi_error_t Socket::getsockopt(int level, int optname, void *optval, unsigned
 
 }
 
+void Socket::recv_release(nsapi_chain_t *chain)
+{
+    _lock.lock();
+
+    if (_socket) {
+        _stack->socket_recv_release(_socket, chain);
+    }
+
+    _lock.unlock();
+}
+
 void Socket::attach(Callback<void()> callback)
 {
     _lock.lock();
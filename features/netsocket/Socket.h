@@ -28,6 +28,10 @@
 
 
 /** Abstract socket class
+ *
+ *  Sockets layered over another socket, such as TLSSocket, override open,
+ *  close, bind, set_timeout, setsockopt and getsockopt, so calls through a
+ *  Socket pointer reach the socket they are layered over.
  */
 class Socket {
 public:
@@ -46,7 +50,7 @@ public:
      *  @param stack    Network stack as target for socket
      *  @return         0 on success, negative error code on failure
      */
-    nsapi_error_t open(NetworkStack *stack);
+    virtual nsapi_error_t open(NetworkStack *stack);
 
     template <typename S>
     nsapi_error_t open(S *stack) {
@@ -60,7 +64,7 @@ public:
      *
      *  @return         0 on success, negative error code on failure
      */
-    nsapi_error_t close();
+    virtual nsapi_error_t close();
     
     /** Bind a specific address to a socket
      *
@@ -91,7 +95,7 @@ public:
      *  @param address  Local address to bind
      *  @return         0 on success, negative error code on failure.
      */
-    nsapi_error_t bind(const SocketAddress &address);
+    virtual nsapi_error_t bind(const SocketAddress &address);
     
     /** Set blocking or non-blocking mode of the socket
      *
@@ -118,7 +122,7 @@ public:
      *
      *  @param timeout  Timeout in milliseconds
      */
-    void set_timeout(int timeout);
+    virtual void set_timeout(int timeout);
 
     /*  Set socket options
      *
@@ -135,7 +139,7 @@ public:
      *  @param optlen   Length of the option value
      *  @return         0 on success, negative error code on failure
      */    
-    nsapi_error_t setsockopt(int level, int optname, const void *optval, unsigned optlen);
+    virtual nsapi_error_t setsockopt(int level, int optname, const void *optval, unsigned optlen);
 
     /*  Get socket options
      *
@@ -152,7 +156,7 @@ public:
      *  @param optlen   Length of the option value
      *  @return         0 on success, negative error code on failure
      */    
-    nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen);
+    virtual nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen);
 
     /** Register a callback on state change of the socket
      *
@@ -167,6 +171,16 @@ public:
      */
     void attach(mbed::Callback<void()> func);
 
+    /** Release a chain of received data
+     *
+     *  Returns the buffers referenced by a chain from recv_chain or
+     *  recvfrom_chain to the network stack. Must be called before the
+     *  socket is closed.
+     *
+     *  @param chain    Chain to release
+     */
+    void recv_release(nsapi_chain_t *chain);
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
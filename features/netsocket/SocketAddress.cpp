@@ -19,139 +19,7 @@
 #include "NetworkStack.h"
 #include <string.h>
 #include "mbed.h"
-
-
-static bool ipv4_is_valid(const char *addr)
-{
-    int i = 0;
-
-    // Check each digit for [0-9.]
-    for (; addr[i]; i++) {
-        if (!(addr[i] >= '0' && addr[i] <= '9') && addr[i] != '.') {
-            return false;
-        }
-    }
-
-    // Ending with '.' garuntees host
-    if (i > 0 && addr[i-1] == '.') {
-        return false;
-    }
-
-    return true;
-}
-
-static bool ipv6_is_valid(const char *addr)
-{
-    // Check each digit for [0-9a-fA-F:]
-    // Must also have at least 2 colons
-    int colons = 0;
-    for (int i = 0; addr[i]; i++) {
-        if (!(addr[i] >= '0' && addr[i] <= '9') &&
-            !(addr[i] >= 'a' && addr[i] <= 'f') &&
-            !(addr[i] >= 'A' && addr[i] <= 'F') &&
-            addr[i] != ':') {
-            return false;
-        }
-        if (addr[i] == ':') {
-            colons++;
-        }
-    }
-
-    return colons >= 2;
-}
-
-static void ipv4_from_address(uint8_t *bytes, const char *addr)
-{
-    int count = 0;
-    int i = 0;
-
-    for (; count < NSAPI_IPv4_BYTES; count++) {
-        unsigned char b;
-        int scanned = sscanf(&addr[i], "%hhu", &b);
-        if (scanned < 1) {
-            return;
-        }
-
-        bytes[count] = b;
-
-        for (; addr[i] != '.'; i++) {
-            if (!addr[i]) {
-                return;
-            }
-        }
-
-        i++;
-    }
-}
-
-static int ipv6_scan_chunk(uint16_t *shorts, const char *chunk) {
-    int count = 0;
-    int i = 0;
-
-    for (; count < NSAPI_IPv6_BYTES/2; count++) {
-        unsigned short s;
-        int scanned = sscanf(&chunk[i], "%hx", &s);
-        if (scanned < 1) {
-            return count;
-        }
-
-        shorts[count] = s;
-
-        for (; chunk[i] != ':'; i++) {
-            if (!chunk[i]) {
-                return count+1;
-            }
-        }
-
-        i++;
-    }
-
-    return count;
-}
-
-static void ipv6_from_address(uint8_t *bytes, const char *addr)
-{
-    // Start with zeroed address
-    uint16_t shorts[NSAPI_IPv6_BYTES/2];
-    int suffix = 0;
-
-    // Find double colons and scan suffix
-    for (int i = 0; addr[i]; i++) {
-        if (addr[i] == ':' && addr[i+1] == ':') {
-            suffix = ipv6_scan_chunk(shorts, &addr[i+2]);
-            break;
-        }
-    }
-
-    // Move suffix to end
-    memmove(&shorts[NSAPI_IPv6_BYTES/2-suffix], &shorts[0],
-            suffix*sizeof(uint16_t));
-    memset(&shorts[0], 0,
-            (NSAPI_IPv6_BYTES/2-suffix)*sizeof(uint16_t));
-
-    // Scan prefix
-    ipv6_scan_chunk(shorts, &addr[0]);
-
-    // Flip bytes
-    for (int i = 0; i < NSAPI_IPv6_BYTES/2; i++) {
-        bytes[2*i+0] = (uint8_t)(shorts[i] >> 8);
-        bytes[2*i+1] = (uint8_t)(shorts[i] >> 0);
-    }
-}
-
-static void ipv4_to_address(char *addr, const uint8_t *bytes)
-{
-    sprintf(addr, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
-}
-
-static void ipv6_to_address(char *addr, const uint8_t *bytes)
-{
-    for (int i = 0; i < NSAPI_IPv6_BYTES/2; i++) {
-        sprintf(&addr[5*i], "%02x%02x", bytes[2*i], bytes[2*i+1]);
-        addr[5*i+4] = ':';
-    }
-    addr[NSAPI_IPv6_SIZE-1] = '\0';
-}
+#include "mbed_ipstring.h"
 
 
 SocketAddress::SocketAddress(nsapi_addr_t addr, uint16_t port)
@@ -186,13 +54,12 @@ bool SocketAddress::set_ip_address(const char *addr)
 {
     _ip_address[0] = '\0';
 
-    if (addr && ipv4_is_valid(addr)) {
+    size_t len = addr ? strlen(addr) : 0;
+    if (addr && mbed_ipv4_from_string(addr, len, _addr.bytes)) {
         _addr.version = NSAPI_IPv4;
-        ipv4_from_address(_addr.bytes, addr);
         return true;
-    } else if (addr && ipv6_is_valid(addr)) {
+    } else if (addr && mbed_ipv6_from_string(addr, len, _addr.bytes)) {
         _addr.version = NSAPI_IPv6;
-        ipv6_from_address(_addr.bytes, addr);
         return true;
     } else {
         _addr = nsapi_addr_t();
@@ -233,9 +100,9 @@ const char *SocketAddress::get_ip_address() const
 
     if (!_ip_address[0]) {
         if (_addr.version == NSAPI_IPv4) {
-            ipv4_to_address(_ip_address, _addr.bytes);
+            mbed_ipv4_to_string(_addr.bytes, _ip_address);
         } else if (_addr.version == NSAPI_IPv6) {
-            ipv6_to_address(_ip_address, _addr.bytes);
+            mbed_ipv6_to_string(_addr.bytes, _ip_address);
         }
     }
 
@@ -0,0 +1,246 @@
+/* SocketSet
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SocketSet.h"
+#include "events/EventQueue.h"
+#include "Timer.h"
+#include "critical.h"
+
+SocketSet::SocketSet(unsigned capacity)
+    : _entries(new entry[capacity])
+    , _capacity(capacity)
+    , _next(0)
+    , _queue(0)
+    , _dispatch_posted(false)
+    , _dispatch_event(0)
+    , _signal(0)
+{
+    for (unsigned i = 0; i < _capacity; i++) {
+        _entries[i].set = this;
+        _entries[i].socket = 0;
+        _entries[i].signalled = false;
+    }
+}
+
+SocketSet::~SocketSet()
+{
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_entries[i].socket) {
+            _entries[i].socket->attach(0);
+        }
+    }
+
+    // a dispatch may still be queued and would run on a freed set
+    if (_queue) {
+        cancel_dispatch(_queue);
+    }
+
+    delete[] _entries;
+}
+
+nsapi_error_t SocketSet::add(Socket *socket)
+{
+    _lock.lock();
+
+    entry *free_entry = 0;
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_entries[i].socket == socket) {
+            _lock.unlock();
+            return NSAPI_ERROR_PARAMETER;
+        }
+
+        if (!_entries[i].socket && !free_entry) {
+            free_entry = &_entries[i];
+        }
+    }
+
+    if (!free_entry) {
+        _lock.unlock();
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    free_entry->socket = socket;
+    socket->set_blocking(false);
+    socket->attach(mbed::Callback<void()>(&SocketSet::socket_event, free_entry));
+
+    _lock.unlock();
+
+    // data may already be waiting on the socket
+    socket_event(free_entry);
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t SocketSet::remove(Socket *socket)
+{
+    _lock.lock();
+
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_entries[i].socket == socket) {
+            socket->attach(0);
+            _entries[i].socket = 0;
+            _entries[i].signalled = false;
+            _lock.unlock();
+            return NSAPI_ERROR_OK;
+        }
+    }
+
+    _lock.unlock();
+    return NSAPI_ERROR_PARAMETER;
+}
+
+nsapi_size_or_error_t SocketSet::wait(Socket **ready, unsigned count, uint32_t millisec)
+{
+    mbed::Timer timer;
+    timer.start();
+
+    while (true) {
+        _lock.lock();
+        unsigned found = collect(ready, count);
+        _lock.unlock();
+
+        if (found) {
+            return found;
+        }
+
+        uint32_t remaining = millisec;
+        if (millisec != osWaitForever) {
+            uint32_t elapsed = timer.read_ms();
+            remaining = (elapsed < millisec) ? millisec - elapsed : 0;
+        }
+
+        if (_signal.wait(remaining) < 1) {
+            return NSAPI_ERROR_WOULD_BLOCK;
+        }
+    }
+}
+
+void SocketSet::attach(events::EventQueue *queue, mbed::Callback<void(Socket *)> handler)
+{
+    _lock.lock();
+    events::EventQueue *old_queue = _queue;
+    _queue = handler ? queue : 0;
+    _handler = handler;
+    _lock.unlock();
+
+    if (old_queue && old_queue != _queue) {
+        cancel_dispatch(old_queue);
+    }
+
+    if (_queue) {
+        // hand over sockets signalled while waiting
+        post_dispatch(_queue);
+    }
+}
+
+// Posts a dispatch unless one is already queued, possibly in interrupt context
+void SocketSet::post_dispatch(events::EventQueue *queue)
+{
+    core_util_critical_section_enter();
+    bool post = !_dispatch_posted;
+    _dispatch_posted = true;
+    core_util_critical_section_exit();
+
+    if (!post) {
+        return;
+    }
+
+    int id = queue->call(this, &SocketSet::dispatch);
+
+    core_util_critical_section_enter();
+    if (!id) {
+        // the queue is full, the next socket event tries again
+        _dispatch_posted = false;
+    } else if (_dispatch_posted) {
+        _dispatch_event = id;
+    }
+    core_util_critical_section_exit();
+}
+
+void SocketSet::cancel_dispatch(events::EventQueue *queue)
+{
+    core_util_critical_section_enter();
+    int id = _dispatch_event;
+    _dispatch_event = 0;
+    _dispatch_posted = false;
+    core_util_critical_section_exit();
+
+    if (id) {
+        queue->cancel(id);
+    }
+}
+
+// Called from the network stack, possibly in interrupt context
+void SocketSet::socket_event(entry *e)
+{
+    SocketSet *set = e->set;
+    e->signalled = true;
+
+    // keep the semaphore close to binary, wait rechecks the entries anyway
+    set->_signal.wait(0);
+    set->_signal.release();
+
+    events::EventQueue *queue = set->_queue;
+    if (queue) {
+        set->post_dispatch(queue);
+    }
+}
+
+// Called with the lock held
+unsigned SocketSet::collect(Socket **ready, unsigned count)
+{
+    unsigned found = 0;
+
+    for (unsigned i = 0; i < _capacity && found < count; i++) {
+        entry *e = &_entries[(_next + i) % _capacity];
+
+        core_util_critical_section_enter();
+        bool signalled = e->signalled;
+        e->signalled = false;
+        core_util_critical_section_exit();
+
+        if (signalled && e->socket) {
+            ready[found++] = e->socket;
+        }
+    }
+
+    _next = (_next + 1) % _capacity;
+    return found;
+}
+
+void SocketSet::dispatch()
+{
+    core_util_critical_section_enter();
+    _dispatch_posted = false;
+    _dispatch_event = 0;
+    core_util_critical_section_exit();
+
+    while (true) {
+        Socket *ready[4];
+
+        _lock.lock();
+        mbed::Callback<void(Socket *)> handler = _handler;
+        unsigned found = handler ? collect(ready, sizeof(ready)/sizeof(ready[0])) : 0;
+        _lock.unlock();
+
+        if (!found) {
+            return;
+        }
+
+        for (unsigned i = 0; i < found; i++) {
+            handler(ready[i]);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* SocketSet
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOCKET_SET_H
+#define SOCKET_SET_H
+
+#include "netsocket/Socket.h"
+#include "rtos/Mutex.h"
+#include "rtos/Semaphore.h"
+#include "Callback.h"
+
+namespace events {
+class EventQueue;
+}
+
+
+/** Set of sockets that are waited on together
+ *
+ *  A SocketSet lets a single thread serve many sockets. Each socket
+ *  added to the set is switched to non-blocking mode and its state
+ *  change callback is taken over by the set. A socket is reported
+ *  as signalled once the stack indicates it may have become readable,
+ *  writable, accepted a connection or been closed, after which the
+ *  caller performs the non-blocking operations it is interested in.
+ *  Sockets are reported once per batch of events, so an operation
+ *  returning NSAPI_ERROR_WOULD_BLOCK simply means there is nothing
+ *  left to do until the socket is signalled again.
+ *
+ *  Sockets are signalled when they are added, as they may already
+ *  have pending data.
+ */
+class SocketSet {
+public:
+    /** Create an empty socket set
+     *
+     *  @param capacity Maximum number of sockets in the set
+     *                  (defaults to nsapi.socket-set-size)
+     */
+    SocketSet(unsigned capacity = MBED_CONF_NSAPI_SOCKET_SET_SIZE);
+
+    /** Destroy the socket set
+     *
+     *  Detaches the set from all of its sockets
+     */
+    ~SocketSet();
+
+    /** Add a socket to the set
+     *
+     *  The socket is made non-blocking and its callback registered with
+     *  Socket::attach is replaced by the set.
+     *
+     *  @param socket   Open socket to add
+     *  @return         0 on success, NSAPI_ERROR_NO_MEMORY if the set is
+     *                  full, NSAPI_ERROR_PARAMETER if the socket is
+     *                  already in the set
+     */
+    nsapi_error_t add(Socket *socket);
+
+    /** Remove a socket from the set
+     *
+     *  The callback of the socket is cleared. A socket must be removed
+     *  before it is destroyed.
+     *
+     *  @param socket   Socket to remove
+     *  @return         0 on success, NSAPI_ERROR_PARAMETER if the socket
+     *                  is not in the set
+     */
+    nsapi_error_t remove(Socket *socket);
+
+    /** Wait until sockets in the set are signalled
+     *
+     *  Blocks until at least one socket has been signalled since it was
+     *  last returned, then returns up to count of them. Signalled sockets
+     *  are returned in turn so a busy socket does not starve the others.
+     *
+     *  @param ready    Destination for the signalled sockets
+     *  @param count    Number of entries in ready
+     *  @param millisec Timeout value or 0 in case of no time-out
+     *                  (default: osWaitForever)
+     *  @return         Number of sockets stored in ready, or
+     *                  NSAPI_ERROR_WOULD_BLOCK on timeout
+     */
+    nsapi_size_or_error_t wait(Socket **ready, unsigned count,
+            uint32_t millisec = osWaitForever);
+
+    /** Dispatch signalled sockets on an event queue
+     *
+     *  Instead of blocking in wait, the handler is called from the
+     *  context of the event queue for each signalled socket. Passing a
+     *  null handler returns the set to wait mode.
+     *
+     *  The set must not be destroyed from another thread while the
+     *  handler is running.
+     *
+     *  @param queue    Event queue that dispatches the handler
+     *  @param handler  Function to call with each signalled socket
+     */
+    void attach(events::EventQueue *queue, mbed::Callback<void(Socket *)> handler);
+
+private:
+    struct entry {
+        SocketSet *set;
+        Socket *socket;
+        volatile bool signalled;
+    };
+
+    static void socket_event(entry *e);
+    unsigned collect(Socket **ready, unsigned count);
+    void post_dispatch(events::EventQueue *queue);
+    void cancel_dispatch(events::EventQueue *queue);
+    void dispatch();
+
+    entry *_entries;
+    unsigned _capacity;
+    unsigned _next;
+
+    events::EventQueue *_queue;
+    mbed::Callback<void(Socket *)> _handler;
+    volatile bool _dispatch_posted;
+    volatile int _dispatch_event;
+
+    rtos::Semaphore _signal;
+    rtos::Mutex _lock;
+
+    /* Disallow copy constructor and assignment operators */
+    SocketSet(const SocketSet &);
+    SocketSet &operator=(const SocketSet &);
+};
+
+
+#endif
+
+/** @}*/
@@ -18,7 +18,7 @@
 #include "mbed.h"
 
 TCPServer::TCPServer()
-    : _pending(0), _accept_sem(0)
+    : _pending(0), _accept_sem(0), _accept_cb(0)
 {
 }
 
@@ -63,18 +63,7 @@ nsapi_error_t TCPServer::accept(TCPSocket *connection, SocketAddress *address)
         ret = _stack->socket_accept(_socket, &socket, address);
 
         if (0 == ret) {
-            connection->_lock.lock();
-
-            if (connection->_socket) {
-                connection->close();
-            }
-
-            connection->_stack = _stack;
-            connection->_socket = socket;
-            connection->_event = Callback<void()>(connection, &TCPSocket::event);
-            _stack->socket_attach(socket, &Callback<void()>::thunk, &connection->_event);
-
-            connection->_lock.unlock();
+            attach_connection(connection, socket);
             break;
         } else if (NSAPI_ERROR_WOULD_BLOCK != ret) {
             break;
@@ -99,6 +88,62 @@ nsapi_error_t TCPServer::accept(TCPSocket *connection, SocketAddress *address)
     return ret;
 }
 
+nsapi_size_or_error_t TCPServer::accept_many(TCPSocket *connections, SocketAddress *addresses, unsigned count)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    if (!_socket) {
+        ret = NSAPI_ERROR_NO_SOCKET;
+    } else {
+        _pending = 0;
+        unsigned accepted = 0;
+        nsapi_error_t err = 0;
+
+        // Take what is already queued, the stack returns
+        // NSAPI_ERROR_WOULD_BLOCK once the queue is empty
+        while (accepted < count) {
+            void *socket;
+            err = _stack->socket_accept(_socket, &socket,
+                    addresses ? &addresses[accepted] : NULL);
+            if (err) {
+                break;
+            }
+
+            attach_connection(&connections[accepted], socket);
+            accepted++;
+        }
+
+        ret = accepted ? (nsapi_size_or_error_t)accepted : err;
+    }
+
+    _lock.unlock();
+    return ret;
+}
+
+void TCPServer::attach_accept(Callback<void()> callback)
+{
+    _lock.lock();
+    _accept_cb = callback;
+    _lock.unlock();
+}
+
+void TCPServer::attach_connection(TCPSocket *connection, void *socket)
+{
+    connection->_lock.lock();
+
+    if (connection->_socket) {
+        connection->close();
+    }
+
+    connection->_stack = _stack;
+    connection->_socket = socket;
+    connection->_event = Callback<void()>(connection, &TCPSocket::event);
+    _stack->socket_attach(socket, &Callback<void()>::thunk, &connection->_event);
+
+    connection->_lock.unlock();
+}
+
 void TCPServer::event()
 {
     int32_t acount = _accept_sem.wait(0);
@@ -106,6 +151,10 @@ void TCPServer::event()
         _accept_sem.release();
     }
 
+    if (_accept_cb) {
+        _accept_cb();
+    }
+
     _pending += 1;
     if (_callback && _pending == 1) {
         _callback();
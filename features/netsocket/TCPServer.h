@@ -46,7 +46,7 @@ public:
      */
     template <typename S>
     TCPServer(S *stack)
-        : _pending(0), _accept_sem(0)
+        : _pending(0), _accept_sem(0), _accept_cb(0)
     {
         open(stack);
     }
@@ -84,12 +84,46 @@ public:
      */
     nsapi_error_t accept(TCPSocket *connection, SocketAddress *address = NULL);
 
+    /** Accepts several connections on a TCP socket
+     *
+     *  Takes the connections already waiting in the stack's accept queue,
+     *  up to count, and hands each one to the socket instance at the same
+     *  position in the array. The depth of the queue is set by the
+     *  network stack, for lwIP with lwip.accept-queue-size.
+     *
+     *  accept_many never blocks. If no connection is waiting,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param connections  Array of TCPSocket instances for the incoming connections
+     *  @param addresses    Array of destinations for the remote addresses or NULL
+     *  @param count        Number of entries in the arrays
+     *  @return             Number of accepted connections on success,
+     *                      negative error code on failure
+     */
+    nsapi_size_or_error_t accept_many(TCPSocket *connections, SocketAddress *addresses, unsigned count);
+
+    /** Register a callback for incoming connections
+     *
+     *  The callback is called each time the stack queues a new connection
+     *  on the socket, unlike the callback passed to attach which is only
+     *  called once until the next accept. It may also be called for errors
+     *  on the socket, in which case accepting returns an error.
+     *
+     *  The callback may be called in an interrupt context and should not
+     *  perform expensive operations such as accepting the connection.
+     *
+     *  @param func     Function to call on an incoming connection, may be null
+     */
+    void attach_accept(mbed::Callback<void()> func);
+
 protected:
     virtual nsapi_protocol_t get_proto();
     virtual void event();
+    void attach_connection(TCPSocket *connection, void *socket);
 
     volatile unsigned _pending;
     rtos::Semaphore _accept_sem;
+    mbed::Callback<void()> _accept_cb;
 };
 
 
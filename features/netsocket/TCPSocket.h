@@ -93,6 +93,50 @@ public:
      *                  code on failure
      */
     nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+
+    /** Send data gathered from several buffers over a TCP socket
+     *
+     *  Sends the buffers in order as if they were one contiguous buffer,
+     *  so a header and its payload need not be copied together first.
+     *  Returns the number of bytes sent, which may be less than the total
+     *  length of the buffers.
+     *
+     *  By default, sendmsg blocks until data is sent. If socket is set to
+     *  non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately.
+     *
+     *  @param iov      Array of buffers to send
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t sendmsg(const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Send data over a TCP socket without copying it
+     *
+     *  Behaves like send, except that the stack references the data in
+     *  place instead of copying it. The sent bytes of the buffer must not
+     *  be modified or released until the complete callback is called,
+     *  which happens once they have been acknowledged by the remote host
+     *  or the connection has been reset.
+     *
+     *  The complete callback is only registered if some bytes were sent.
+     *  It may be called from the context of the network stack and should
+     *  not perform expensive operations. Stacks without zero-copy support
+     *  copy the data and call the callback before send_nocopy returns.
+     *
+     *  Closing the socket waits for the outstanding data to be
+     *  acknowledged, for the NSAPI_LINGER time when one is set, and
+     *  resets the connection if it is not.
+     *
+     *  @param data     Buffer of data to send to the host
+     *  @param size     Size of the buffer in bytes
+     *  @param complete Callback called once the sent bytes can be reused
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t send_nocopy(const void *data, nsapi_size_t size,
+            mbed::Callback<void()> complete);
     
     /** Receive data over a TCP socket
      *
@@ -110,6 +154,41 @@ public:
      */
     nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
 
+    /** Receive data scattered into several buffers over a TCP socket
+     *
+     *  Fills the buffers in order as if they were one contiguous buffer.
+     *  Returns the number of bytes received.
+     *
+     *  By default, recvmsg blocks until some data is received. If socket
+     *  is set to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is
+     *  returned immediately.
+     *
+     *  @param iov      Array of buffers to receive into
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recvmsg(const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Receive data over a TCP socket without copying it
+     *
+     *  Fills the chain with read-only views of received data held by the
+     *  network stack. Data that does not fit in the chain remains for the
+     *  next receive.
+     *
+     *  Whenever this returns a non-negative size, the chain must be
+     *  passed to recv_release before the socket is received from again.
+     *
+     *  By default, recv_chain blocks until some data is received. If socket
+     *  is set to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is
+     *  returned immediately.
+     *
+     *  @param chain    Destination for the received segments
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recv_chain(nsapi_chain_t *chain);
+
 protected:
     friend class TCPServer;
 
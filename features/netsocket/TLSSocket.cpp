@@ -0,0 +1,637 @@
+/* TLSSocket
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TLSSocket.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_X509_CRT_PARSE_C) && \
+    defined(MBEDTLS_CTR_DRBG_C) && defined(MBEDTLS_ENTROPY_C)
+
+#include "platform/SingletonPtr.h"
+#include "mbedtls/ssl_internal.h"
+#include <string.h>
+
+static const char tls_drbg_personalization[] = "mbed TLSSocket";
+
+static SingletonPtr<TLSSessionCache> default_cache;
+
+
+TLSSessionCache::TLSSessionCache(unsigned capacity)
+    : _entries(new entry[capacity])
+    , _capacity(capacity)
+    , _clock(0)
+{
+    for (unsigned i = 0; i < _capacity; i++) {
+        _entries[i].host = 0;
+        _entries[i].port = 0;
+        _entries[i].last_used = 0;
+        mbedtls_ssl_session_init(&_entries[i].session);
+    }
+}
+
+TLSSessionCache::~TLSSessionCache()
+{
+    clear();
+    delete[] _entries;
+}
+
+TLSSessionCache *TLSSessionCache::get_default()
+{
+    return default_cache.get();
+}
+
+TLSSessionCache::entry *TLSSessionCache::find(const char *host, uint16_t port)
+{
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_entries[i].host && _entries[i].port == port &&
+            strcmp(_entries[i].host, host) == 0) {
+            return &_entries[i];
+        }
+    }
+
+    return 0;
+}
+
+void TLSSessionCache::release(entry *e)
+{
+    delete[] e->host;
+    e->host = 0;
+    e->port = 0;
+    mbedtls_ssl_session_free(&e->session);
+}
+
+bool TLSSessionCache::load(const char *host, uint16_t port, mbedtls_ssl_context *ssl)
+{
+    _lock.lock();
+
+    bool loaded = false;
+    entry *e = find(host, port);
+    if (e && mbedtls_ssl_set_session(ssl, &e->session) == 0) {
+        e->last_used = ++_clock;
+        loaded = true;
+    }
+
+    _lock.unlock();
+    return loaded;
+}
+
+void TLSSessionCache::store(const char *host, uint16_t port, const mbedtls_ssl_context *ssl)
+{
+    _lock.lock();
+
+    // Reuse the entry of the same server, otherwise the least recently used
+    entry *e = find(host, port);
+    if (!e) {
+        for (unsigned i = 0; i < _capacity; i++) {
+            if (!e || !_entries[i].host ||
+                (e->host && _entries[i].last_used < e->last_used)) {
+                e = &_entries[i];
+            }
+        }
+
+        if (!e) {
+            _lock.unlock();
+            return;
+        }
+
+        release(e);
+        e->host = new char[strlen(host) + 1];
+        strcpy(e->host, host);
+        e->port = port;
+    }
+
+    // The session copies its own peer certificate and ticket
+    mbedtls_ssl_session_free(&e->session);
+    if (mbedtls_ssl_get_session(ssl, &e->session) != 0) {
+        release(e);
+    } else {
+        e->last_used = ++_clock;
+    }
+
+    _lock.unlock();
+}
+
+void TLSSessionCache::remove(const char *host, uint16_t port)
+{
+    _lock.lock();
+
+    entry *e = find(host, port);
+    if (e) {
+        release(e);
+    }
+
+    _lock.unlock();
+}
+
+void TLSSessionCache::clear()
+{
+    _lock.lock();
+
+    for (unsigned i = 0; i < _capacity; i++) {
+        if (_entries[i].host) {
+            release(&_entries[i]);
+        }
+    }
+
+    _lock.unlock();
+}
+
+
+TLSSocket::TLSSocket()
+{
+    init();
+}
+
+void TLSSocket::init()
+{
+    _tls_state = TLS_IDLE;
+    _conf_ready = false;
+    _ssl_ready = false;
+    _hostname_changed = false;
+    _session_offered = false;
+    _resumed = false;
+    _bio_error = NSAPI_ERROR_OK;
+    _hostname = 0;
+    _address_host[0] = '\0';
+    _port = 0;
+    _tcp_stack = 0;
+    _cache = TLSSessionCache::get_default();
+    memset(&_stats, 0, sizeof(_stats));
+
+    mbedtls_ssl_init(&_ssl);
+    mbedtls_ssl_config_init(&_conf);
+    mbedtls_entropy_init(&_entropy);
+    mbedtls_ctr_drbg_init(&_drbg);
+    mbedtls_x509_crt_init(&_ca);
+    mbedtls_x509_crt_init(&_own_cert);
+    mbedtls_pk_init(&_own_key);
+
+    _tcp.attach(mbed::callback(this, &TLSSocket::event));
+}
+
+TLSSocket::~TLSSocket()
+{
+    close();
+
+    mbedtls_ssl_free(&_ssl);
+    mbedtls_ssl_config_free(&_conf);
+    mbedtls_ctr_drbg_free(&_drbg);
+    mbedtls_entropy_free(&_entropy);
+    mbedtls_x509_crt_free(&_ca);
+    mbedtls_x509_crt_free(&_own_cert);
+    mbedtls_pk_free(&_own_key);
+    delete[] _hostname;
+}
+
+nsapi_protocol_t TLSSocket::get_proto()
+{
+    return NSAPI_TCP;
+}
+
+void TLSSocket::event()
+{
+    // The stack signals the TCP socket, which passes it on
+    if (_callback) {
+        _callback();
+    }
+}
+
+nsapi_error_t TLSSocket::open(NetworkStack *stack)
+{
+    nsapi_error_t err = _tcp.open(stack);
+    if (err) {
+        return err;
+    }
+
+    _tcp_stack = stack;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocket::bind(uint16_t port)
+{
+    return _tcp.bind(port);
+}
+
+nsapi_error_t TLSSocket::bind(const char *address, uint16_t port)
+{
+    return _tcp.bind(address, port);
+}
+
+nsapi_error_t TLSSocket::bind(const SocketAddress &address)
+{
+    return _tcp.bind(address);
+}
+
+void TLSSocket::set_timeout(int timeout)
+{
+    _tcp.set_timeout(timeout);
+}
+
+nsapi_error_t TLSSocket::setsockopt(int level, int optname, const void *optval, unsigned optlen)
+{
+    return _tcp.setsockopt(level, optname, optval, optlen);
+}
+
+nsapi_error_t TLSSocket::getsockopt(int level, int optname, void *optval, unsigned *optlen)
+{
+    return _tcp.getsockopt(level, optname, optval, optlen);
+}
+
+nsapi_error_t TLSSocket::set_root_ca_cert(const void *cert, size_t len)
+{
+    if (_conf_ready) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // Certificates that cannot be parsed are skipped, as long as some can
+    mbedtls_x509_crt_free(&_ca);
+    mbedtls_x509_crt_init(&_ca);
+    if (mbedtls_x509_crt_parse(&_ca, (const unsigned char *)cert, len) < 0 || !_ca.version) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocket::set_root_ca_cert(const char *cert)
+{
+    return set_root_ca_cert(cert, strlen(cert) + 1);
+}
+
+nsapi_error_t TLSSocket::set_client_cert_key(const void *cert, size_t cert_len,
+        const void *key, size_t key_len)
+{
+    if (_conf_ready) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    mbedtls_x509_crt_free(&_own_cert);
+    mbedtls_x509_crt_init(&_own_cert);
+    mbedtls_pk_free(&_own_key);
+    mbedtls_pk_init(&_own_key);
+    if (mbedtls_x509_crt_parse(&_own_cert, (const unsigned char *)cert, cert_len) != 0 ||
+        mbedtls_pk_parse_key(&_own_key, (const unsigned char *)key, key_len, NULL, 0) != 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocket::set_hostname(const char *hostname)
+{
+    if (_tls_state != TLS_IDLE) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    if ((!hostname && !_hostname) ||
+        (hostname && _hostname && strcmp(hostname, _hostname) == 0)) {
+        return NSAPI_ERROR_OK;
+    }
+
+    _hostname_changed = true;
+    delete[] _hostname;
+    _hostname = 0;
+    if (hostname) {
+        _hostname = new char[strlen(hostname) + 1];
+        strcpy(_hostname, hostname);
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+void TLSSocket::set_session_cache(TLSSessionCache *cache)
+{
+    _cache = cache;
+}
+
+mbedtls_ssl_context *TLSSocket::get_ssl_context()
+{
+    return &_ssl;
+}
+
+void TLSSocket::get_stats(nsapi_tls_stats_t *stats) const
+{
+    *stats = _stats;
+}
+
+const char *TLSSocket::cache_host() const
+{
+    return _hostname ? _hostname : _address_host;
+}
+
+int TLSSocket::ssl_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    TLSSocket *socket = static_cast<TLSSocket *>(ctx);
+    nsapi_size_or_error_t ret = socket->_tcp.send(buf, len);
+    if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    } else if (ret < 0) {
+        // Keep the socket error so it can be returned instead of the
+        // generic one mbed TLS passes up
+        socket->_bio_error = ret;
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    return ret;
+}
+
+int TLSSocket::ssl_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    TLSSocket *socket = static_cast<TLSSocket *>(ctx);
+    nsapi_size_or_error_t ret = socket->_tcp.recv(buf, len);
+    if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    } else if (ret < 0) {
+        socket->_bio_error = ret;
+        return MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    return ret;
+}
+
+int TLSSocket::ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags)
+{
+    // mbed TLS only checks the name of the server certificate when one
+    // is set, without one any certificate from the CA would do
+    TLSSocket *socket = static_cast<TLSSocket *>(ctx);
+    if (depth == 0 && !socket->_hostname) {
+        *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
+    }
+    return 0;
+}
+
+nsapi_error_t TLSSocket::tls_error(int ret)
+{
+    if (_bio_error) {
+        nsapi_error_t err = _bio_error;
+        _bio_error = NSAPI_ERROR_OK;
+        return err;
+    }
+
+    switch (ret) {
+        case MBEDTLS_ERR_SSL_WANT_READ:
+        case MBEDTLS_ERR_SSL_WANT_WRITE:
+            return NSAPI_ERROR_WOULD_BLOCK;
+        case MBEDTLS_ERR_X509_CERT_VERIFY_FAILED:
+            return NSAPI_ERROR_AUTH_FAILURE;
+        case MBEDTLS_ERR_SSL_ALLOC_FAILED:
+            return NSAPI_ERROR_NO_MEMORY;
+        case MBEDTLS_ERR_SSL_CONN_EOF:
+        case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
+            return NSAPI_ERROR_NO_CONNECTION;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+nsapi_error_t TLSSocket::start_handshake(const SocketAddress &address)
+{
+    int ret;
+
+    if (!_conf_ready) {
+        ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy,
+                (const unsigned char *)tls_drbg_personalization,
+                sizeof(tls_drbg_personalization));
+        if (ret != 0) {
+            return NSAPI_ERROR_DEVICE_ERROR;
+        }
+
+        ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT,
+                MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+        if (ret != 0) {
+            return tls_error(ret);
+        }
+
+        mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+        mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&_conf, &_ca, NULL);
+        mbedtls_ssl_conf_verify(&_conf, &TLSSocket::ssl_verify, this);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+        if (_own_cert.version) {
+            ret = mbedtls_ssl_conf_own_cert(&_conf, &_own_cert, &_own_key);
+            if (ret != 0) {
+                return tls_error(ret);
+            }
+        }
+
+        _conf_ready = true;
+    }
+
+    if (_ssl_ready && !_hostname_changed) {
+        // Keeps the I/O buffers of the previous connection
+        ret = mbedtls_ssl_session_reset(&_ssl);
+        if (ret != 0) {
+            return tls_error(ret);
+        }
+    } else {
+        // The server name of a context cannot be replaced or cleared, so
+        // a new name needs a new context
+        if (_ssl_ready) {
+            mbedtls_ssl_free(&_ssl);
+            mbedtls_ssl_init(&_ssl);
+            _ssl_ready = false;
+        }
+
+        ret = mbedtls_ssl_setup(&_ssl, &_conf);
+        if (ret != 0) {
+            return tls_error(ret);
+        }
+
+        mbedtls_ssl_set_bio(&_ssl, this, &TLSSocket::ssl_send, &TLSSocket::ssl_recv, NULL);
+        _ssl_ready = true;
+
+        if (_hostname) {
+            ret = mbedtls_ssl_set_hostname(&_ssl, _hostname);
+            if (ret != 0) {
+                return tls_error(ret);
+            }
+        }
+        _hostname_changed = false;
+    }
+
+    strcpy(_address_host, address.get_ip_address());
+    _port = address.get_port();
+
+    _session_offered = _cache && _cache->load(cache_host(), _port, &_ssl);
+    _resumed = false;
+    _bio_error = NSAPI_ERROR_OK;
+    _tls_state = TLS_HANDSHAKE;
+
+    _timer.reset();
+    _timer.start();
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocket::continue_handshake()
+{
+    // Stepped like mbedtls_ssl_handshake, to see whether the server hello
+    // resumed the session before the handshake parameters are freed
+    int ret = 0;
+    while (_ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+        ret = mbedtls_ssl_handshake_step(&_ssl);
+        if (ret != 0) {
+            break;
+        }
+
+        if (_ssl.handshake) {
+            _resumed = _ssl.handshake->resume != 0;
+        }
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        _bio_error = NSAPI_ERROR_OK;
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+
+    _timer.stop();
+    uint32_t elapsed = _timer.read_ms();
+
+    if (ret != 0) {
+        _stats.failures++;
+        _tls_state = TLS_IDLE;
+
+        // Do not keep offering a session the server chokes on
+        if (_session_offered) {
+            _cache->remove(cache_host(), _port);
+        }
+        return tls_error(ret);
+    }
+
+    bool resumed = _resumed;
+    _stats.handshakes++;
+    _stats.last_resumed = resumed;
+    _stats.last_ms = elapsed;
+    if (resumed) {
+        _stats.resumed++;
+        _stats.resumed_ms += elapsed;
+    } else {
+        _stats.full_ms += elapsed;
+    }
+
+    // Store the session even when resumed, the server may have issued a
+    // new ticket
+    if (_cache) {
+        _cache->store(cache_host(), _port, &_ssl);
+    }
+
+    _tls_state = TLS_CONNECTED;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocket::connect(const SocketAddress &address)
+{
+    if (_tls_state == TLS_CONNECTED) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+
+    if (_tls_state == TLS_IDLE) {
+        nsapi_error_t err = _tcp.connect(address);
+        if (err == NSAPI_ERROR_IS_CONNECTED) {
+            // A non-blocking connect has completed
+            err = NSAPI_ERROR_OK;
+        }
+        if (err) {
+            return err;
+        }
+
+        err = start_handshake(address);
+        if (err) {
+            return err;
+        }
+    }
+
+    return continue_handshake();
+}
+
+nsapi_error_t TLSSocket::connect(const char *host, uint16_t port)
+{
+    // Non-blocking calls continue with the address of the first one
+    if (!_resolved) {
+        if (_tls_state == TLS_IDLE) {
+            nsapi_error_t err = set_hostname(host);
+            if (err) {
+                return err;
+            }
+        }
+
+        if (!_tcp_stack) {
+            return NSAPI_ERROR_NO_SOCKET;
+        }
+
+        nsapi_error_t err = _tcp_stack->gethostbyname(host, &_resolved);
+        if (err) {
+            _resolved = SocketAddress();
+            return NSAPI_ERROR_DNS_FAILURE;
+        }
+
+        _resolved.set_port(port);
+    }
+
+    nsapi_error_t err = connect(_resolved);
+    if (err != NSAPI_ERROR_WOULD_BLOCK && err != NSAPI_ERROR_IN_PROGRESS &&
+        err != NSAPI_ERROR_ALREADY) {
+        _resolved = SocketAddress();
+    }
+
+    return err;
+}
+
+nsapi_size_or_error_t TLSSocket::send(const void *data, nsapi_size_t size)
+{
+    if (_tls_state != TLS_CONNECTED) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    int ret = mbedtls_ssl_write(&_ssl, (const unsigned char *)data, size);
+    if (ret < 0) {
+        return tls_error(ret);
+    }
+
+    return ret;
+}
+
+nsapi_size_or_error_t TLSSocket::recv(void *data, nsapi_size_t size)
+{
+    if (_tls_state != TLS_CONNECTED) {
+        return NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    int ret = mbedtls_ssl_read(&_ssl, (unsigned char *)data, size);
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || ret == MBEDTLS_ERR_SSL_CONN_EOF) {
+        return 0;
+    } else if (ret < 0) {
+        return tls_error(ret);
+    }
+
+    return ret;
+}
+
+nsapi_error_t TLSSocket::close()
+{
+    if (_tls_state == TLS_CONNECTED) {
+        // Best effort, the connection is closed whether or not it is sent
+        mbedtls_ssl_close_notify(&_ssl);
+    }
+
+    _tls_state = TLS_IDLE;
+    _bio_error = NSAPI_ERROR_OK;
+    _resolved = SocketAddress();
+    _tcp_stack = 0;
+    return _tcp.close();
+}
+
+#endif
@@ -0,0 +1,439 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* TLSSocket
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TLSSOCKET_H
+#define TLSSOCKET_H
+
+#include "netsocket/Socket.h"
+#include "netsocket/TCPSocket.h"
+#include "rtos/Mutex.h"
+#include "Timer.h"
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_X509_CRT_PARSE_C) && \
+    defined(MBEDTLS_CTR_DRBG_C) && defined(MBEDTLS_ENTROPY_C)
+
+
+/** Handshake counters of a TLS socket
+ */
+typedef struct nsapi_tls_stats {
+    unsigned handshakes;        /*!< handshakes completed */
+    unsigned resumed;           /*!< handshakes that resumed a cached session */
+    unsigned failures;          /*!< handshakes that failed */
+    bool last_resumed;          /*!< whether the last handshake was resumed */
+    uint32_t last_ms;           /*!< duration of the last handshake in ms */
+    uint32_t full_ms;           /*!< total duration of full handshakes in ms */
+    uint32_t resumed_ms;        /*!< total duration of resumed handshakes in ms */
+} nsapi_tls_stats_t;
+
+
+/** Cache of TLS client sessions
+ *
+ *  Keeps the most recently used sessions, by server name and port, so a
+ *  reconnecting TLSSocket can resume with the session ID or session
+ *  ticket of its previous connection instead of doing a full handshake.
+ *
+ *  Sessions are only held in RAM, so they do not survive a reset and the
+ *  first connection after a reset needs a full handshake. The cache can
+ *  be shared by any number of sockets and is thread safe.
+ */
+class TLSSessionCache {
+public:
+    /** Create an empty session cache
+     *
+     *  @param capacity Maximum number of sessions in the cache
+     *                  (defaults to nsapi.tls-session-cache-size)
+     */
+    TLSSessionCache(unsigned capacity = MBED_CONF_NSAPI_TLS_SESSION_CACHE_SIZE);
+
+    /** Destroy the session cache
+     *
+     *  Frees all cached sessions
+     */
+    ~TLSSessionCache();
+
+    /** Offer a cached session for resumption
+     *
+     *  @param host     Server name the session was stored under
+     *  @param port     Server port the session was stored under
+     *  @param ssl      TLS context about to start a handshake
+     *  @return         True if a session was set on the context
+     */
+    bool load(const char *host, uint16_t port, mbedtls_ssl_context *ssl);
+
+    /** Store the session of a completed handshake
+     *
+     *  Replaces any session stored for the same server. When the cache
+     *  is full the least recently used session is evicted.
+     *
+     *  @param host     Server name to store the session under
+     *  @param port     Server port to store the session under
+     *  @param ssl      TLS context that completed a handshake
+     */
+    void store(const char *host, uint16_t port, const mbedtls_ssl_context *ssl);
+
+    /** Remove the session stored for a server
+     *
+     *  @param host     Server name the session was stored under
+     *  @param port     Server port the session was stored under
+     */
+    void remove(const char *host, uint16_t port);
+
+    /** Remove all sessions
+     */
+    void clear();
+
+    /** Get the cache used by TLS sockets by default
+     *
+     *  @return         Shared session cache
+     */
+    static TLSSessionCache *get_default();
+
+private:
+    struct entry {
+        char *host;
+        uint16_t port;
+        unsigned last_used;
+        mbedtls_ssl_session session;
+    };
+
+    entry *find(const char *host, uint16_t port);
+    void release(entry *e);
+
+    entry *_entries;
+    unsigned _capacity;
+    unsigned _clock;
+    rtos::Mutex _lock;
+
+    /* Disallow copy constructor and assignment operators */
+    TLSSessionCache(const TLSSessionCache &);
+    TLSSessionCache &operator=(const TLSSessionCache &);
+};
+
+
+/** TLS client socket
+ *
+ *  Runs TLS with mbed TLS over a TCP connection. The server certificate
+ *  is always verified against the server name, so a root CA must be set
+ *  before connecting, and a host name when connecting to an address. The
+ *  TCP connection is private to the socket, so data can only be sent and
+ *  received through TLS.
+ *
+ *  Socket calls such as set_blocking, set_timeout, setsockopt and attach
+ *  apply to the TCP connection, also when made through a Socket pointer,
+ *  so a TLS socket can be added to a SocketSet. A signal only means the
+ *  TCP connection changed state, a record may need several segments.
+ *
+ *  Sessions are stored in a session cache after each handshake and
+ *  offered on the next connection to the same server, which saves the
+ *  public key operations of a full handshake when the server accepts
+ *  them. Both session IDs and session tickets are supported.
+ *
+ *  In non-blocking mode connect returns NSAPI_ERROR_IN_PROGRESS or
+ *  NSAPI_ERROR_WOULD_BLOCK until the handshake is complete, and must be
+ *  called again when the socket is signalled. As with mbedtls_ssl_write,
+ *  a send that returns NSAPI_ERROR_WOULD_BLOCK must be repeated with the
+ *  same data.
+ *
+ *  Only one thread may use a TLS socket at a time.
+ */
+class TLSSocket : public Socket {
+public:
+    /** Create an uninitialized socket
+     *
+     *  Must call open to initialize the socket on a network stack.
+     */
+    TLSSocket();
+
+    /** Create a socket on a network interface
+     *
+     *  Creates and opens a socket on the network stack of the given
+     *  network interface.
+     *
+     *  @param stack    Network stack as target for socket
+     */
+    template <typename S>
+    TLSSocket(S *stack)
+    {
+        init();
+        open(stack);
+    }
+
+    /** Destroy a socket
+     *
+     *  Closes socket if the socket is still open
+     */
+    virtual ~TLSSocket();
+
+    /** Opens a socket
+     *
+     *  Creates the TCP socket on the network stack of the given network
+     *  interface. Not needed if stack is passed to the socket's
+     *  constructor.
+     *
+     *  @param stack    Network stack as target for socket
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t open(NetworkStack *stack);
+
+    template <typename S>
+    nsapi_error_t open(S *stack) {
+        return open(nsapi_create_stack(stack));
+    }
+
+    /** Bind a specific address to the TCP socket
+     *
+     *  @param port     Local port to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    nsapi_error_t bind(uint16_t port);
+
+    /** Bind a specific address to the TCP socket
+     *
+     *  @param address  Null-terminated local address to bind
+     *  @param port     Local port to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    nsapi_error_t bind(const char *address, uint16_t port);
+
+    /** Bind a specific address to the TCP socket
+     *
+     *  @param address  Local address to bind
+     *  @return         0 on success, negative error code on failure.
+     */
+    virtual nsapi_error_t bind(const SocketAddress &address);
+
+    /** Set timeout on blocking socket operations
+     *
+     *  The timeout applies to each read or write of the TCP socket made
+     *  by mbed TLS. Blocking mode applies to connect, send and recv as a
+     *  whole, including the handshake.
+     *
+     *  @param timeout  Timeout in milliseconds
+     */
+    virtual void set_timeout(int timeout);
+
+    /*  Set options of the TCP socket
+     *
+     *  @param level    Stack-specific protocol level or nsapi_socket_level_t
+     *  @param optname  Level-specific option name
+     *  @param optval   Option value
+     *  @param optlen   Length of the option value
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t setsockopt(int level, int optname, const void *optval, unsigned optlen);
+
+    /*  Get options of the TCP socket
+     *
+     *  @param level    Stack-specific protocol level or nsapi_socket_level_t
+     *  @param optname  Level-specific option name
+     *  @param optval   Destination for option value
+     *  @param optlen   Length of the option value
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen);
+
+    /** Set the root CA certificates used to verify the server
+     *
+     *  Must be called before the first connect.
+     *
+     *  @param cert     PEM or DER certificates, PEM must be null terminated
+     *  @param len      Length of the certificates in bytes, including the
+     *                  null terminator for PEM
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_root_ca_cert(const void *cert, size_t len);
+
+    /** Set the root CA certificates used to verify the server
+     *
+     *  @param cert     Null terminated PEM certificates
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_root_ca_cert(const char *cert);
+
+    /** Set the certificate and key used to authenticate to the server
+     *
+     *  Must be called before the first connect.
+     *
+     *  @param cert     PEM or DER certificate chain
+     *  @param cert_len Length of the certificate in bytes, including the
+     *                  null terminator for PEM
+     *  @param key      PEM or DER private key
+     *  @param key_len  Length of the key in bytes, including the null
+     *                  terminator for PEM
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_client_cert_key(const void *cert, size_t cert_len,
+            const void *key, size_t key_len);
+
+    /** Set the server name
+     *
+     *  The name is sent in the server name indication extension and must
+     *  match the server certificate. connect(host, port) sets it to host.
+     *  Connecting to an address fails verification without a name.
+     *
+     *  @param hostname Server name, copied by the socket
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t set_hostname(const char *hostname);
+
+    /** Set the session cache
+     *
+     *  Sockets use the cache returned by TLSSessionCache::get_default
+     *  unless set otherwise. Passing null disables resumption.
+     *
+     *  @param cache    Session cache, must outlive the socket
+     */
+    void set_session_cache(TLSSessionCache *cache);
+
+    /** Connects to a TLS server
+     *
+     *  Resolves the host, connects over TCP and performs the handshake.
+     *  The host is used as the server name. In non-blocking mode the host
+     *  is only resolved on the first call, later calls continue the
+     *  connection to the same address.
+     *
+     *  @param host     Hostname of the remote host
+     *  @param port     Port of the remote host
+     *  @return         0 on success, negative error code on failure
+     *                  NSAPI_ERROR_AUTH_FAILURE indicates the server
+     *                  certificate could not be verified
+     */
+    nsapi_error_t connect(const char *host, uint16_t port);
+
+    /** Connects to a TLS server
+     *
+     *  Connects over TCP and performs the handshake. The server name
+     *  must be set with set_hostname first.
+     *
+     *  @param address  The SocketAddress of the remote host
+     *  @return         0 on success, negative error code on failure
+     *                  NSAPI_ERROR_AUTH_FAILURE indicates the server
+     *                  certificate could not be verified
+     */
+    nsapi_error_t connect(const SocketAddress &address);
+
+    /** Send data over the TLS connection
+     *
+     *  @param data     Buffer of data to send to the host
+     *  @param size     Size of the buffer in bytes
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t send(const void *data, nsapi_size_t size);
+
+    /** Receive data over the TLS connection
+     *
+     *  @param data     Destination buffer for data received from the host
+     *  @param size     Size of the buffer in bytes
+     *  @return         Number of received bytes on success, 0 if the
+     *                  server closed the connection, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
+
+    /** Close the socket
+     *
+     *  Sends a close notification if the handshake completed, then
+     *  closes the TCP connection. The socket keeps its configuration and
+     *  can be opened and connected again.
+     *
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t close();
+
+    /** Get the handshake counters of the socket
+     *
+     *  Counters accumulate over every connection made with the socket.
+     *
+     *  @param stats    Destination for the counters
+     */
+    void get_stats(nsapi_tls_stats_t *stats) const;
+
+    /** Get the underlying mbed TLS context
+     *
+     *  Allows the negotiated parameters to be inspected once connected.
+     *
+     *  @return         mbed TLS context of the socket
+     */
+    mbedtls_ssl_context *get_ssl_context();
+
+protected:
+    virtual nsapi_protocol_t get_proto();
+    virtual void event();
+
+    void init();
+    nsapi_error_t start_handshake(const SocketAddress &address);
+    nsapi_error_t continue_handshake();
+    nsapi_error_t tls_error(int ret);
+    const char *cache_host() const;
+
+    static int ssl_send(void *ctx, const unsigned char *buf, size_t len);
+    static int ssl_recv(void *ctx, unsigned char *buf, size_t len);
+    static int ssl_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags);
+
+    enum tls_state {
+        TLS_IDLE,
+        TLS_HANDSHAKE,
+        TLS_CONNECTED,
+    };
+
+    tls_state _tls_state;
+    bool _conf_ready;
+    bool _ssl_ready;
+    bool _hostname_changed;
+    bool _session_offered;
+    bool _resumed;
+    nsapi_error_t _bio_error;
+    char *_hostname;
+    char _address_host[NSAPI_IP_SIZE];
+    uint16_t _port;
+    SocketAddress _resolved;    // address of a connect(host, port) in progress
+    NetworkStack *_tcp_stack;   // stack of the TCP socket, resolves hosts
+    TLSSessionCache *_cache;
+    nsapi_tls_stats_t _stats;
+    mbed::Timer _timer;
+
+    mbedtls_ssl_context _ssl;
+    mbedtls_ssl_config _conf;
+    mbedtls_entropy_context _entropy;
+    mbedtls_ctr_drbg_context _drbg;
+    mbedtls_x509_crt _ca;
+    mbedtls_x509_crt _own_cert;
+    mbedtls_pk_context _own_key;
+
+private:
+    TCPSocket _tcp;
+
+    /* Disallow copy constructor and assignment operators */
+    TLSSocket(const TLSSocket &);
+    TLSSocket &operator=(const TLSSocket &);
+};
+
+
+#endif
+
+#endif
+
+/** @}*/
@@ -94,6 +94,25 @@ public:
     nsapi_size_or_error_t sendto(const SocketAddress &address,
             const void *data, nsapi_size_t size);
 
+    /** Send a packet gathered from several buffers over a UDP socket
+     *
+     *  Sends the buffers in order as a single datagram to the specified
+     *  address, so a header and its payload need not be copied together
+     *  first.
+     *
+     *  By default, sendmsg blocks until data is sent. If socket is set to
+     *  non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately.
+     *
+     *  @param address  The SocketAddress of the remote host
+     *  @param iov      Array of buffers to send
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t sendmsg(const SocketAddress &address,
+            const nsapi_iovec_t *iov, unsigned iovcnt);
+
     /** Receive a packet over a UDP socket
      *
      *  Receives data and stores the source address in address if address
@@ -112,6 +131,81 @@ public:
     nsapi_size_or_error_t recvfrom(SocketAddress *address,
             void *data, nsapi_size_t size);
 
+    /** Receive a packet scattered into several buffers over a UDP socket
+     *
+     *  Fills the buffers in order with one datagram and stores the source
+     *  address in address if address is not NULL. Returns the number of
+     *  bytes received.
+     *
+     *  By default, recvmsg blocks until data is received. If socket is set
+     *  to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately.
+     *
+     *  @param address  Destination for the source address or NULL
+     *  @param iov      Array of buffers to receive into
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recvmsg(SocketAddress *address,
+            const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Send several packets over a UDP socket
+     *
+     *  Sends the datagrams in order, each of length size to the address
+     *  and port of its descriptor, with a single call into the stack.
+     *  Returns the number of datagrams sent, which may be less than count
+     *  if the stack runs out of buffers.
+     *
+     *  By default, sendto_many blocks until at least one datagram is sent.
+     *  If socket is set to non-blocking or times out,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of sent datagrams on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t sendto_many(nsapi_datagram_t *msgs, unsigned count);
+
+    /** Receive several packets over a UDP socket
+     *
+     *  Takes the datagrams queued on the socket, up to count, with a single
+     *  call into the stack. Fills in the source address, port and length
+     *  of each descriptor, truncating datagrams larger than their buffer.
+     *  Returns the number of datagrams received.
+     *
+     *  By default, recvfrom_many blocks until at least one datagram is
+     *  received. If socket is set to non-blocking or times out,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param msgs     Array of datagrams to receive into
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of received datagrams on success, negative
+     *                  error code on failure
+     */
+    nsapi_size_or_error_t recvfrom_many(nsapi_datagram_t *msgs, unsigned count);
+
+    /** Receive a packet over a UDP socket without copying it
+     *
+     *  Fills the chain with read-only views of one datagram held by the
+     *  network stack and stores the source address in address if address
+     *  is not NULL. Segments that do not fit in the chain are discarded.
+     *
+     *  Whenever this returns a non-negative size, the chain must be
+     *  passed to recv_release before the socket is received from again.
+     *
+     *  By default, recvfrom_chain blocks until data is received. If socket
+     *  is set to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is
+     *  returned immediately.
+     *
+     *  @param address  Destination for the source address or NULL
+     *  @param chain    Destination for the received segments
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recvfrom_chain(SocketAddress *address, nsapi_chain_t *chain);
+
 protected:
     virtual nsapi_protocol_t get_proto();
     virtual void event();
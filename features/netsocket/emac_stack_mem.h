@@ -20,6 +20,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * Stack memory module
  *
@@ -30,6 +34,18 @@
 typedef void emac_stack_mem_t;
 typedef void emac_stack_mem_chain_t;
 typedef void emac_stack_t;
+typedef void emac_stack_mem_ring_t;
+
+/**
+ * Receive buffer ring counters
+ */
+typedef struct emac_stack_mem_ring_stats {
+    uint32_t count;         /**< Buffers in the ring */
+    uint32_t available;     /**< Buffers ready to be taken */
+    uint32_t low_water;     /**< Fewest buffers that have been ready to be taken */
+    uint32_t taken;         /**< Buffers taken by the driver */
+    uint32_t starved;       /**< Takes that failed because every buffer was in use */
+} emac_stack_mem_ring_stats_t;
 
 /**
  * Allocates stack memory
@@ -79,6 +95,8 @@ uint32_t emac_stack_mem_len(emac_stack_t* stack, emac_stack_mem_t *mem);
 /**
  * Sets the actual payload size (the allocated payload size will not change)
  *
+ * For memory that is not part of a chain this is also the total size.
+ *
  * @param stack Emac stack context
  * @param mem Memory structure
  * @param len Actual payload size
@@ -111,6 +129,72 @@ uint32_t emac_stack_mem_chain_len(emac_stack_t* stack, emac_stack_mem_chain_t *c
  */
 void emac_stack_mem_ref(emac_stack_t* stack, emac_stack_mem_t *mem);
 
+/**
+ * Create a ring of receive buffers
+ *
+ * All buffers are allocated and aligned once, when the ring is created, so
+ * a driver can hand them to its DMA descriptors and pass received frames to
+ * the stack without copying. When the stack is done with a frame, its buffer
+ * goes back to the ring instead of being freed.
+ *
+ * @a emac_stack_mem_ring_take and @a emac_stack_mem_ring_get_stats may be
+ * called from interrupt context, so a receive interrupt can refill its
+ * descriptors. Creating and destroying a ring, and freeing its buffers,
+ * must be done from a thread.
+ *
+ * @param  stack Emac stack context
+ * @param  count Number of buffers in the ring
+ * @param  size  Size of each buffer
+ * @param  align Alignment of each buffer, 0 for the stack default
+ * @return       Ring of buffers, or NULL in case of error
+ */
+emac_stack_mem_ring_t *emac_stack_mem_ring_create(emac_stack_t* stack, uint32_t count, uint32_t size, uint32_t align);
+
+/**
+ * Destroy a ring of receive buffers
+ *
+ * Buffers still taken from the ring, including frames held by the stack,
+ * remain valid. The ring memory is released when the last one is freed.
+ *
+ * @param stack Emac stack context
+ * @param ring  Ring to destroy
+ */
+void emac_stack_mem_ring_destroy(emac_stack_t* stack, emac_stack_mem_ring_t *ring);
+
+/**
+ * Take a buffer from a ring
+ *
+ * The buffer has the full size of the ring buffers. After a frame is
+ * received into it, its size is set with @a emac_stack_mem_set_len and it
+ * is passed to the stack as it is. A buffer that is not passed to the stack
+ * is returned with @a emac_stack_mem_free, or kept for the next frame.
+ *
+ * May be called from interrupt context.
+ *
+ * @param  stack Emac stack context
+ * @param  ring  Ring to take the buffer from
+ * @return       Buffer, or NULL if the stack holds every buffer of the ring
+ */
+emac_stack_mem_t *emac_stack_mem_ring_take(emac_stack_t* stack, emac_stack_mem_ring_t *ring);
+
+/**
+ * Read the counters of a ring
+ *
+ * A growing starved count means received frames are dropped because the
+ * stack does not release buffers fast enough, and the ring should be larger.
+ *
+ * May be called from interrupt context.
+ *
+ * @param stack Emac stack context
+ * @param ring  Ring of buffers
+ * @param stats Destination for the counters
+ */
+void emac_stack_mem_ring_get_stats(emac_stack_t* stack, emac_stack_mem_ring_t *ring, emac_stack_mem_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* DEVICE_EMAC */
 
 #endif /* EMAC_MBED_STACK_MEM_h */
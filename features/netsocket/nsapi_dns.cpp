@@ -16,19 +16,36 @@
  */
 #include "nsapi_dns.h"
 #include "netsocket/UDPSocket.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+#include "hal/us_ticker_api.h"
+#if DEVICE_TRNG
+#include "hal/trng_api.h"
+#endif
+#include "events/EventQueue.h"
+#include "rtos/Thread.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 
 #define CLASS_IN 1
 
 #define RR_A 1
 #define RR_AAAA 28
 
+#define RCODE_NXDOMAIN 3
+
 // DNS options
 #define DNS_BUFFER_SIZE 512
 #define DNS_TIMEOUT 5000
 #define DNS_SERVERS_SIZE 5
+#define DNS_CACHE_SIZE MBED_CONF_NSAPI_DNS_CACHE_SIZE
+#define DNS_CACHE_ADDRESSES MBED_CONF_NSAPI_DNS_CACHE_ADDRESSES
+#define DNS_CACHE_NEGATIVE_TTL MBED_CONF_NSAPI_DNS_CACHE_NEGATIVE_TTL
+#define DNS_ASYNC_QUERIES MBED_CONF_NSAPI_DNS_ASYNC_QUERIES
+#define DNS_ASYNC_STAGGER MBED_CONF_NSAPI_DNS_ASYNC_STAGGER
+#define DNS_ASYNC_QUEUE_SIZE (16*EVENTS_EVENT_SIZE)
 
 nsapi_addr_t dns_servers[DNS_SERVERS_SIZE] = {
     {NSAPI_IPv4, {8, 8, 8, 8}},                             // Google
@@ -43,14 +60,161 @@ nsapi_addr_t dns_servers[DNS_SERVERS_SIZE] = {
 // DNS server configuration
 extern "C" nsapi_error_t nsapi_dns_add_server(nsapi_addr_t addr)
 {
-    memmove(&dns_servers[1], &dns_servers[0],
-            (DNS_SERVERS_SIZE-1)*sizeof(nsapi_addr_t));
+    // A server already in the list only moves to the front
+    unsigned i;
+    for (i = 0; i < DNS_SERVERS_SIZE-1; i++) {
+        if (dns_servers[i].version == addr.version &&
+                memcmp(dns_servers[i].bytes, addr.bytes, NSAPI_IP_BYTES) == 0) {
+            break;
+        }
+    }
+
+    memmove(&dns_servers[1], &dns_servers[0], i*sizeof(nsapi_addr_t));
 
     dns_servers[0] = addr;
     return NSAPI_ERROR_OK;
 }
 
 
+// DNS resolver cache
+#if DNS_CACHE_SIZE > 0
+struct dns_cache_entry {
+    char *host;
+    nsapi_version_t version;
+    nsapi_addr_t addr[DNS_CACHE_ADDRESSES];
+    unsigned addr_count;        // 0 for a cached failure
+    us_timestamp_t expires;
+    us_timestamp_t used;
+};
+
+static dns_cache_entry dns_cache[DNS_CACHE_SIZE];
+static SingletonPtr<PlatformMutex> dns_cache_mutex;
+#endif
+
+static nsapi_dns_cache_stats_t dns_cache_stats;
+
+// Look up a host in the cache, returning the number of addresses copied,
+// NSAPI_ERROR_DNS_FAILURE for a cached failure or 0 on a miss
+static nsapi_size_or_error_t dns_cache_find(const char *host, nsapi_version_t version,
+        nsapi_addr_t *addr, unsigned addr_count)
+{
+#if DNS_CACHE_SIZE > 0
+    nsapi_size_or_error_t result = 0;
+    us_timestamp_t now = us_ticker_read_us();
+
+    dns_cache_mutex->lock();
+    for (unsigned i = 0; i < DNS_CACHE_SIZE; i++) {
+        dns_cache_entry *entry = &dns_cache[i];
+        if (!entry->host || entry->version != version || strcmp(entry->host, host) != 0) {
+            continue;
+        }
+
+        if (entry->expires <= now) {
+            free(entry->host);
+            entry->host = NULL;
+            break;
+        }
+
+        // A full entry may have been cut short, so it can not answer
+        // a query for more addresses than the cache keeps
+        if (entry->addr_count == DNS_CACHE_ADDRESSES && addr_count > DNS_CACHE_ADDRESSES) {
+            break;
+        }
+
+        entry->used = now;
+        if (entry->addr_count == 0) {
+            dns_cache_stats.negative_hits++;
+            result = NSAPI_ERROR_DNS_FAILURE;
+        } else {
+            dns_cache_stats.hits++;
+            result = (entry->addr_count < addr_count) ? entry->addr_count : addr_count;
+            memcpy(addr, entry->addr, result*sizeof(nsapi_addr_t));
+        }
+        break;
+    }
+
+    if (result == 0) {
+        dns_cache_stats.misses++;
+    }
+    dns_cache_mutex->unlock();
+    return result;
+#else
+    dns_cache_stats.misses++;
+    return 0;
+#endif
+}
+
+// Store an answer, or a failure when addr_count is 0, replacing the
+// least recently used entry
+static void dns_cache_add(const char *host, nsapi_version_t version,
+        const nsapi_addr_t *addr, unsigned addr_count, uint32_t ttl)
+{
+#if DNS_CACHE_SIZE > 0
+    if (ttl == 0) {
+        return;
+    }
+
+    char *name = (char *)malloc(strlen(host) + 1);
+    if (!name) {
+        return;
+    }
+    strcpy(name, host);
+
+    us_timestamp_t now = us_ticker_read_us();
+
+    dns_cache_mutex->lock();
+    dns_cache_entry *entry = &dns_cache[0];
+    for (unsigned i = 0; i < DNS_CACHE_SIZE; i++) {
+        dns_cache_entry *e = &dns_cache[i];
+        if (!e->host ||
+                (e->version == version && strcmp(e->host, host) == 0)) {
+            entry = e;
+            break;
+        }
+        if (e->used < entry->used) {
+            entry = e;
+        }
+    }
+
+    if (entry->host) {
+        if (entry->version != version || strcmp(entry->host, host) != 0) {
+            dns_cache_stats.evictions++;
+        }
+        free(entry->host);
+    }
+
+    if (addr_count > DNS_CACHE_ADDRESSES) {
+        addr_count = DNS_CACHE_ADDRESSES;
+    }
+
+    entry->host = name;
+    entry->version = version;
+    memcpy(entry->addr, addr, addr_count*sizeof(nsapi_addr_t));
+    entry->addr_count = addr_count;
+    entry->expires = now + (us_timestamp_t)ttl*1000000;
+    entry->used = now;
+    dns_cache_mutex->unlock();
+#endif
+}
+
+extern "C" void nsapi_dns_cache_flush(void)
+{
+#if DNS_CACHE_SIZE > 0
+    dns_cache_mutex->lock();
+    for (unsigned i = 0; i < DNS_CACHE_SIZE; i++) {
+        free(dns_cache[i].host);
+        dns_cache[i].host = NULL;
+    }
+    dns_cache_mutex->unlock();
+#endif
+}
+
+extern "C" void nsapi_dns_cache_get_stats(nsapi_dns_cache_stats_t *stats)
+{
+    *stats = dns_cache_stats;
+}
+
+
 // DNS packet parsing
 static void dns_append_byte(uint8_t **p, uint8_t byte)
 {
@@ -84,10 +248,10 @@ static uint16_t dns_scan_word(const uint8_t **p)
 }
 
 
-static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t version)
+static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t version, uint16_t id)
 {
     // fill the header
-    dns_append_word(p, 1);      // id      = 1
+    dns_append_word(p, id);     // id
     dns_append_word(p, 0x0100); // flags   = recursion required
     dns_append_word(p, 1);      // qdcount = 1
     dns_append_word(p, 0);      // ancount = 0
@@ -112,66 +276,100 @@ static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t v
     dns_append_word(p, CLASS_IN);
 }
 
-static int dns_scan_response(const uint8_t **p, nsapi_addr_t *addr, unsigned addr_count)
+// Skips a name, which ends with a zero length or a compression pointer
+static bool dns_scan_name(const uint8_t **p, const uint8_t *end)
 {
+    while (*p < end) {
+        uint8_t len = dns_scan_byte(p);
+        if (len == 0) {
+            return true;
+        } else if ((len & 0xc0) == 0xc0) { // this is link
+            if (*p == end) {
+                return false;
+            }
+            dns_scan_byte(p);
+            return true;
+        } else if (len & 0xc0) { // reserved label types
+            return false;
+        }
+
+        if (end - *p < len) {
+            return false;
+        }
+        *p += len;
+    }
+
+    return false;
+}
+
+// Returns the number of addresses in the answer, or -1 if the packet is
+// not a complete answer to the query. Every read is checked against the
+// size received, so a truncated or malformed packet is dropped.
+static int dns_scan_response(const uint8_t *packet, nsapi_size_t size,
+        nsapi_addr_t *addr, unsigned addr_count, uint32_t *ttl, uint16_t query_id)
+{
+    const uint8_t *p = packet;
+    const uint8_t *end = packet + size;
+
+    if (size < 12) {
+        return -1;
+    }
+
     // scan header
-    uint16_t id    = dns_scan_word(p);
-    uint16_t flags = dns_scan_word(p);
+    uint16_t id    = dns_scan_word(&p);
+    uint16_t flags = dns_scan_word(&p);
     bool    qr     = 0x1 & (flags >> 15);
     uint8_t opcode = 0xf & (flags >> 11);
     uint8_t rcode  = 0xf & (flags >>  0);
 
-    uint16_t qdcount = dns_scan_word(p); // qdcount
-    uint16_t ancount = dns_scan_word(p); // ancount
-    dns_scan_word(p);                    // nscount
-    dns_scan_word(p);                    // arcount
+    uint16_t qdcount = dns_scan_word(&p); // qdcount
+    uint16_t ancount = dns_scan_word(&p); // ancount
+    dns_scan_word(&p);                    // nscount
+    dns_scan_word(&p);                    // arcount
 
     // verify header is response to query
-    if (!(id == 1 && qr && opcode == 0 && rcode == 0)) {
-        return 0;
+    if (!(id == query_id && qr && opcode == 0 && (rcode == 0 || rcode == RCODE_NXDOMAIN))) {
+        return -1;
     }
 
     // skip questions
     for (int i = 0; i < qdcount; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            }
-
-            *p += len;
+        if (!dns_scan_name(&p, end) || end - p < 4) {
+            return -1;
         }
 
-        dns_scan_word(p); // qtype
-        dns_scan_word(p); // qclass
+        dns_scan_word(&p); // qtype
+        dns_scan_word(&p); // qclass
     }
 
-    // scan each response
+    // scan each response, keeping the lowest ttl of the answers
     unsigned count = 0;
+    *ttl = 0xffffffff;
 
     for (int i = 0; i < ancount && count < addr_count; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            } else if (len & 0xc0) { // this is link
-                dns_scan_byte(p);
-                break;
-            }
+        if (!dns_scan_name(&p, end) || end - p < 10) {
+            return -1;
+        }
+
+        uint16_t rtype    = dns_scan_word(&p); // rtype
+        uint16_t rclass   = dns_scan_word(&p); // rclass
+        uint32_t rttl     = (uint32_t)dns_scan_word(&p) << 16;
+        rttl             |= dns_scan_word(&p); // ttl
+        uint16_t rdlength = dns_scan_word(&p); // rdlength
 
-            *p += len;
+        if (end - p < rdlength) {
+            return -1;
         }
 
-        uint16_t rtype    = dns_scan_word(p); // rtype
-        uint16_t rclass   = dns_scan_word(p); // rclass
-        *p += 4;                              // ttl
-        uint16_t rdlength = dns_scan_word(p); // rdlength
+        if (rttl < *ttl) {
+            *ttl = rttl;
+        }
 
         if (rtype == RR_A && rclass == CLASS_IN && rdlength == NSAPI_IPv4_BYTES) {
             // accept A record
             addr->version = NSAPI_IPv4;
             for (int i = 0; i < NSAPI_IPv4_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
+                addr->bytes[i] = dns_scan_byte(&p);
             }
 
             addr += 1;
@@ -180,20 +378,61 @@ static int dns_scan_response(const uint8_t **p, nsapi_addr_t *addr, unsigned add
             // accept AAAA record
             addr->version = NSAPI_IPv6;
             for (int i = 0; i < NSAPI_IPv6_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
+                addr->bytes[i] = dns_scan_byte(&p);
             }
 
             addr += 1;
             count += 1;
         } else {
             // skip unrecognized records
-            *p += rdlength;
+            p += rdlength;
         }
     }
 
     return count;
 }
 
+// Answers are only taken from the servers that were queried
+static bool dns_scan_source(const SocketAddress &from, unsigned first, unsigned last)
+{
+    if (from.get_port() != 53) {
+        return false;
+    }
+
+    for (unsigned i = first; i < last; i++) {
+        if (from == SocketAddress(dns_servers[i], 53)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Query ids protect against spoofed answers, so they come from the
+// TRNG when the target has one. Otherwise they come from a generator
+// that mixes in the ticker on every call.
+static uint16_t dns_random_id()
+{
+#if DEVICE_TRNG
+    trng_t trng;
+    uint16_t id;
+    size_t len = 0;
+    trng_init(&trng);
+    int err = trng_get_bytes(&trng, (uint8_t *)&id, sizeof(id), &len);
+    trng_free(&trng);
+    if (err == 0 && len == sizeof(id)) {
+        return id;
+    }
+#endif
+
+    static uint32_t state;
+    state ^= us_ticker_read();
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (uint16_t)(state ^ (state >> 16));
+}
+
 // core query function
 static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const char *host,
         nsapi_addr_t *addr, unsigned addr_count, nsapi_version_t version)
@@ -204,10 +443,30 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
         return NSAPI_ERROR_PARAMETER;
     }
 
+    nsapi_size_or_error_t cached = dns_cache_find(host, version, addr, addr_count);
+    if (cached != 0) {
+        return cached;
+    }
+
+    // resolve at least as many addresses as the cache keeps, so a later
+    // query for more addresses is not answered from a shorter list
+    nsapi_addr_t *answer = addr;
+    unsigned answer_count = addr_count;
+    if (DNS_CACHE_SIZE > 0 && answer_count < DNS_CACHE_ADDRESSES) {
+        answer = (nsapi_addr_t *)malloc(DNS_CACHE_ADDRESSES*sizeof(nsapi_addr_t));
+        if (!answer) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+        answer_count = DNS_CACHE_ADDRESSES;
+    }
+
     // create a udp socket
     UDPSocket socket;
     int err = socket.open(stack);
     if (err) {
+        if (answer != addr) {
+            free(answer);
+        }
         return err;
     }
 
@@ -216,16 +475,20 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
     // create network packet
     uint8_t *packet = (uint8_t *)malloc(DNS_BUFFER_SIZE);
     if (!packet) {
+        if (answer != addr) {
+            free(answer);
+        }
         return NSAPI_ERROR_NO_MEMORY;
     }
 
     nsapi_size_or_error_t result = NSAPI_ERROR_DNS_FAILURE;
+    uint16_t dns_id = dns_random_id();
 
     // check against each dns server
     for (unsigned i = 0; i < DNS_SERVERS_SIZE; i++) {
         // send the question
         uint8_t *question = packet;
-        dns_append_question(&question, host, version);
+        dns_append_question(&question, host, version, dns_id);
 
         err = socket.sendto(SocketAddress(dns_servers[i], 53), packet, DNS_BUFFER_SIZE);
         // send may fail for various reasons, including wrong address type - move on
@@ -233,8 +496,33 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
             continue;
         }
 
-        // recv the response
-        err = socket.recvfrom(NULL, packet, DNS_BUFFER_SIZE);
+        // recv the response, ignoring datagrams that are not an answer
+        // from this server until it times out
+        us_timestamp_t deadline = us_ticker_read_us() + DNS_TIMEOUT*1000ULL;
+        uint32_t ttl;
+        int count = -1;
+        while (true) {
+            us_timestamp_t now = us_ticker_read_us();
+            if (now >= deadline) {
+                err = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+            socket.set_timeout((deadline - now + 999) / 1000);
+
+            SocketAddress from;
+            err = socket.recvfrom(&from, packet, DNS_BUFFER_SIZE);
+            if (err < 0) {
+                break;
+            } else if (!dns_scan_source(from, i, i + 1)) {
+                continue;
+            }
+
+            count = dns_scan_response(packet, err, answer, answer_count, &ttl, dns_id);
+            if (count >= 0) {
+                break;
+            }
+        }
+
         if (err == NSAPI_ERROR_WOULD_BLOCK) {
             continue;
         } else if (err < 0) {
@@ -242,9 +530,15 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
             break;
         }
 
-        const uint8_t *response = packet;
-        if (dns_scan_response(&response, addr, addr_count) > 0) {
-            result = NSAPI_ERROR_OK;
+        if (count > 0) {
+            dns_cache_add(host, version, answer, count, ttl);
+            result = ((unsigned)count < addr_count) ? count : addr_count;
+            if (answer != addr) {
+                memcpy(addr, answer, result*sizeof(nsapi_addr_t));
+            }
+        } else if (count == 0) {
+            // The server answered that the host has no address
+            dns_cache_add(host, version, NULL, 0, DNS_CACHE_NEGATIVE_TTL);
         }
 
         /* The DNS response is final, no need to check other servers */
@@ -253,6 +547,9 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
 
     // clean up packet
     free(packet);
+    if (answer != addr) {
+        free(answer);
+    }
 
     // clean up udp
     err = socket.close();
@@ -304,3 +601,314 @@ nsapi_error_t nsapi_dns_query(NetworkStack *stack, const char *host,
     address->set_addr(addr);
     return (nsapi_error_t)((result > 0) ? 0 : result);
 }
+
+
+// asynchronous queries, run from the DNS event queue
+struct dns_async_query {
+    int id;                     // 0 for a free slot
+    NetworkStack *stack;
+    char *host;
+    nsapi_version_t version;
+    NetworkStack::hostbyname_cb_t callback;
+    UDPSocket *socket;
+    uint8_t *packet;
+    uint16_t dns_id;
+    unsigned server;            // next server to query
+    unsigned sent;              // servers queried
+    int event;                  // pending start, send or timeout event
+    bool done;
+    nsapi_error_t result;
+    nsapi_addr_t addr;
+};
+
+static dns_async_query dns_async_queries[DNS_ASYNC_QUERIES];
+static SingletonPtr<PlatformMutex> dns_async_mutex;
+static events::EventQueue *dns_queue;
+static rtos::Thread *dns_thread;
+static int dns_async_next_id = 1;
+
+static dns_async_query *dns_async_find(int id)
+{
+    for (unsigned i = 0; i < DNS_ASYNC_QUERIES; i++) {
+        if (dns_async_queries[i].id == id) {
+            return &dns_async_queries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void dns_async_free(dns_async_query *q)
+{
+    if (q->event) {
+        dns_queue->cancel(q->event);
+    }
+
+    if (q->socket) {
+        q->socket->close();
+        delete q->socket;
+    }
+
+    free(q->packet);
+    free(q->host);
+    q->id = 0;
+    q->stack = NULL;
+    q->host = NULL;
+    q->callback = NetworkStack::hostbyname_cb_t();
+    q->socket = NULL;
+    q->packet = NULL;
+    q->event = 0;
+    q->done = false;
+}
+
+static void dns_async_complete(dns_async_query *q, nsapi_error_t result, const nsapi_addr_t *addr)
+{
+    q->done = true;
+    q->result = result;
+    if (addr) {
+        q->addr = *addr;
+    }
+}
+
+// Release the lock taken by an event, calling the callback first if
+// the query completed. The callback runs under the lock so that a
+// concurrent cancel either stops it or waits for it to return.
+static void dns_async_unlock(dns_async_query *q)
+{
+    if (!q || !q->done) {
+        dns_async_mutex->unlock();
+        return;
+    }
+
+    NetworkStack::hostbyname_cb_t callback = q->callback;
+    nsapi_error_t result = q->result;
+    SocketAddress address(q->addr);
+    dns_async_free(q);
+
+    callback(result, result == NSAPI_ERROR_OK ? &address : NULL);
+    dns_async_mutex->unlock();
+}
+
+static void dns_async_recv(dns_async_query *q)
+{
+    while (!q->done) {
+        SocketAddress from;
+        nsapi_size_or_error_t size = q->socket->recvfrom(&from, q->packet, DNS_BUFFER_SIZE);
+        if (size == NSAPI_ERROR_WOULD_BLOCK) {
+            return;
+        } else if (size < 0) {
+            dns_async_complete(q, size, NULL);
+            return;
+        } else if (!dns_scan_source(from, 0, q->server)) {
+            continue;
+        }
+
+        nsapi_addr_t addr[DNS_CACHE_ADDRESSES];
+        uint32_t ttl;
+        int count = dns_scan_response(q->packet, size, addr, DNS_CACHE_ADDRESSES, &ttl, q->dns_id);
+        if (count > 0) {
+            dns_cache_add(q->host, q->version, addr, count, ttl);
+            dns_async_complete(q, NSAPI_ERROR_OK, &addr[0]);
+        } else if (count == 0) {
+            // The server answered that the host has no address
+            dns_cache_add(q->host, q->version, NULL, 0, DNS_CACHE_NEGATIVE_TTL);
+            dns_async_complete(q, NSAPI_ERROR_DNS_FAILURE, NULL);
+        }
+        // otherwise this is not an answer to the query, keep waiting
+    }
+}
+
+static void dns_async_timeout(int id)
+{
+    dns_async_mutex->lock();
+    dns_async_query *q = dns_async_find(id);
+    if (q) {
+        q->event = 0;
+        dns_async_recv(q);
+        if (!q->done) {
+            dns_async_complete(q, NSAPI_ERROR_DNS_FAILURE, NULL);
+        }
+    }
+    dns_async_unlock(q);
+}
+
+static void dns_async_send(int id)
+{
+    dns_async_mutex->lock();
+    dns_async_query *q = dns_async_find(id);
+    if (!q) {
+        dns_async_unlock(q);
+        return;
+    }
+
+    q->event = 0;
+    dns_async_recv(q);
+
+    // query the next server, skipping those the socket can not reach
+    while (!q->done && q->server < DNS_SERVERS_SIZE) {
+        uint8_t *question = q->packet;
+        dns_append_question(&question, q->host, q->version, q->dns_id);
+
+        nsapi_size_or_error_t err = q->socket->sendto(
+                SocketAddress(dns_servers[q->server++], 53),
+                q->packet, question - q->packet);
+        if (err >= 0) {
+            q->sent++;
+            break;
+        }
+    }
+
+    if (!q->done) {
+        if (q->server < DNS_SERVERS_SIZE) {
+            q->event = dns_queue->call_in(DNS_ASYNC_STAGGER, dns_async_send, id);
+        } else if (q->sent > 0) {
+            q->event = dns_queue->call_in(DNS_TIMEOUT, dns_async_timeout, id);
+        } else {
+            dns_async_complete(q, NSAPI_ERROR_DNS_FAILURE, NULL);
+        }
+
+        if (!q->done && !q->event) {
+            dns_async_complete(q, NSAPI_ERROR_NO_MEMORY, NULL);
+        }
+    }
+
+    dns_async_unlock(q);
+}
+
+static void dns_async_socket_recv(int id)
+{
+    dns_async_mutex->lock();
+    dns_async_query *q = dns_async_find(id);
+    if (q && q->socket) {
+        dns_async_recv(q);
+    }
+    dns_async_unlock(q);
+}
+
+// Called from the network stack, only defers to the event queue
+static void dns_async_socket_event(void *id)
+{
+    dns_queue->call(dns_async_socket_recv, (int)(intptr_t)id);
+}
+
+static void dns_async_start(int id)
+{
+    dns_async_mutex->lock();
+    dns_async_query *q = dns_async_find(id);
+    if (!q) {
+        dns_async_unlock(q);
+        return;
+    }
+
+    q->event = 0;
+    q->packet = (uint8_t *)malloc(DNS_BUFFER_SIZE);
+    q->socket = new UDPSocket;
+
+    nsapi_error_t err = q->packet ? q->socket->open(q->stack) : NSAPI_ERROR_NO_MEMORY;
+    if (err) {
+        dns_async_complete(q, err, NULL);
+        dns_async_unlock(q);
+        return;
+    }
+
+    q->socket->set_blocking(false);
+    q->socket->attach(mbed::Callback<void()>(dns_async_socket_event, (void *)(intptr_t)id));
+
+    // the first server is queried straight away
+    q->event = dns_queue->call(dns_async_send, id);
+    if (!q->event) {
+        dns_async_complete(q, NSAPI_ERROR_NO_MEMORY, NULL);
+    }
+    dns_async_unlock(q);
+}
+
+nsapi_error_t nsapi_dns_set_event_queue(events::EventQueue *queue)
+{
+    nsapi_error_t err = NSAPI_ERROR_OK;
+
+    dns_async_mutex->lock();
+    if (dns_queue && dns_queue != queue) {
+        err = NSAPI_ERROR_ALREADY;
+    } else {
+        dns_queue = queue;
+    }
+    dns_async_mutex->unlock();
+
+    return err;
+}
+
+nsapi_value_or_error_t nsapi_dns_query_async(NetworkStack *stack, const char *host,
+        NetworkStack::hostbyname_cb_t callback, nsapi_version_t version)
+{
+    // check for valid host name
+    int host_len = host ? strlen(host) : 0;
+    if (host_len > 128 || host_len == 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    nsapi_addr_t addr;
+    nsapi_size_or_error_t cached = dns_cache_find(host, version, &addr, 1);
+    if (cached > 0) {
+        SocketAddress address(addr);
+        callback(NSAPI_ERROR_OK, &address);
+        return NSAPI_ERROR_OK;
+    } else if (cached < 0) {
+        callback(cached, NULL);
+        return NSAPI_ERROR_OK;
+    }
+
+    dns_async_mutex->lock();
+    if (!dns_queue) {
+        dns_queue = new events::EventQueue(DNS_ASYNC_QUEUE_SIZE);
+        dns_thread = new rtos::Thread();
+        dns_thread->start(mbed::callback(dns_queue, &events::EventQueue::dispatch_forever));
+    }
+
+    dns_async_query *q = dns_async_find(0);
+    char *name = (char *)malloc(host_len + 1);
+    if (!q || !name) {
+        dns_async_mutex->unlock();
+        free(name);
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    strcpy(name, host);
+
+    q->id = dns_async_next_id;
+    dns_async_next_id = (dns_async_next_id == INT_MAX) ? 1 : dns_async_next_id + 1;
+    q->stack = stack;
+    q->host = name;
+    q->version = version;
+    q->callback = callback;
+    q->dns_id = dns_random_id();
+    q->server = 0;
+    q->sent = 0;
+
+    q->event = dns_queue->call(dns_async_start, q->id);
+    if (!q->event) {
+        dns_async_free(q);
+        dns_async_mutex->unlock();
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_value_or_error_t id = q->id;
+    dns_async_mutex->unlock();
+    return id;
+}
+
+nsapi_error_t nsapi_dns_query_async_cancel(int id)
+{
+    if (id <= 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    dns_async_mutex->lock();
+    dns_async_query *q = dns_async_find(id);
+    if (!q) {
+        dns_async_mutex->unlock();
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    dns_async_free(q);
+    dns_async_mutex->unlock();
+    return NSAPI_ERROR_OK;
+}
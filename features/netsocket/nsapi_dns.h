@@ -23,8 +23,21 @@
 #include "nsapi_types.h"
 #ifdef __cplusplus
 #include "netsocket/NetworkStack.h"
+
+namespace events {
+class EventQueue;
+}
 #endif
 
+/** Counters of the DNS resolver cache
+ */
+typedef struct nsapi_dns_cache_stats {
+    unsigned hits;              /*!< queries answered with cached addresses */
+    unsigned negative_hits;     /*!< queries answered with a cached failure */
+    unsigned misses;            /*!< queries sent to a server */
+    unsigned evictions;         /*!< live entries replaced to make room */
+} nsapi_dns_cache_stats_t;
+
 #ifndef __cplusplus
 
 
@@ -60,6 +73,16 @@ nsapi_size_or_error_t nsapi_dns_query_multiple(nsapi_stack_t *stack, const char
  */
 nsapi_error_t nsapi_dns_add_server(nsapi_addr_t addr);
 
+/** Remove all entries from the DNS resolver cache
+ */
+void nsapi_dns_cache_flush(void);
+
+/** Read the counters of the DNS resolver cache
+ *
+ *  @param stats    Destination for the counters
+ */
+void nsapi_dns_cache_get_stats(nsapi_dns_cache_stats_t *stats);
+
 
 #else
 
@@ -148,6 +171,49 @@ nsapi_size_or_error_t nsapi_dns_query_multiple(S *stack, const char *host,
                 host, addr, addr_count, version);
 }
 
+/** Query the domain name servers for an IP address without blocking
+ *
+ *  The question is sent to each configured server in turn, the next
+ *  server being started after nsapi.dns-async-stagger milliseconds
+ *  without waiting for an answer from the previous one. The first
+ *  answer completes the query and later answers are discarded.
+ *
+ *  The callback is called from the context of the DNS event queue,
+ *  or before this function returns if the answer is cached.
+ *  nsapi_dns_query_async_cancel called from another thread waits for
+ *  a running callback to return.
+ *
+ *  @param stack    Network stack as target for DNS query
+ *  @param host     Hostname to resolve
+ *  @param callback Callback that is called with the result
+ *  @param version  IP version to resolve (defaults to NSAPI_IPv4)
+ *  @return         0 if the callback was already called, a positive
+ *                  unique id of the query or a negative error code
+ *                  on failure
+ */
+nsapi_value_or_error_t nsapi_dns_query_async(NetworkStack *stack, const char *host,
+        NetworkStack::hostbyname_cb_t callback, nsapi_version_t version = NSAPI_IPv4);
+
+/** Cancel an asynchronous query
+ *
+ *  @param id       Unique id of the query
+ *  @return         0 on success, NSAPI_ERROR_PARAMETER if the query
+ *                  already completed
+ */
+nsapi_error_t nsapi_dns_query_async_cancel(int id);
+
+/** Set the event queue that runs asynchronous queries
+ *
+ *  By default a queue dispatched from a thread owned by the DNS resolver
+ *  is created on the first asynchronous query. An application may instead
+ *  provide its own queue, on which the query callbacks are then called.
+ *
+ *  @param queue    Event queue that is dispatched by the application
+ *  @return         0 on success, NSAPI_ERROR_ALREADY if asynchronous
+ *                  queries have already been started on another queue
+ */
+nsapi_error_t nsapi_dns_set_event_queue(events::EventQueue *queue);
+
 /** Add a domain name server to list of servers to query
  *
  *  @param addr     Destination for the host address
@@ -175,6 +241,16 @@ static inline nsapi_error_t nsapi_dns_add_server(const char *address)
     return nsapi_dns_add_server(SocketAddress(address));
 }
 
+/** Remove all entries from the DNS resolver cache
+ */
+extern "C" void nsapi_dns_cache_flush(void);
+
+/** Read the counters of the DNS resolver cache
+ *
+ *  @param stats    Destination for the counters
+ */
+extern "C" void nsapi_dns_cache_get_stats(nsapi_dns_cache_stats_t *stats);
+
 
 #endif
 
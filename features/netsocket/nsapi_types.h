@@ -71,6 +71,13 @@ typedef unsigned int nsapi_size_t;
  */
 typedef signed int nsapi_size_or_error_t;
 
+/** Type used to represent either a value or error
+ *
+ *  A valid nsapi_value_or_error_t is either a non-negative value or a
+ *  negative error code from the nsapi_error_t
+ */
+typedef signed int nsapi_value_or_error_t;
+
 /** Enum of encryption types
  *
  *  The security type specifies a particular security to use when
@@ -151,6 +158,51 @@ typedef struct nsapi_addr {
 typedef void *nsapi_socket_t;
 
 
+/** Buffer descriptor for scatter-gather socket operations
+ */
+typedef struct nsapi_iovec {
+    void *iov_base;             /*!< start of the buffer */
+    nsapi_size_t iov_len;       /*!< length of the buffer in bytes */
+} nsapi_iovec_t;
+
+
+/** Datagram descriptor for batched UDP socket operations
+ */
+typedef struct nsapi_datagram {
+    nsapi_addr_t addr;          /*!< address of the remote host */
+    uint16_t port;              /*!< port of the remote host */
+    void *data;                 /*!< buffer holding the datagram */
+    nsapi_size_t size;          /*!< size of the buffer in bytes */
+    nsapi_size_t length;        /*!< length of a received datagram, truncated to size */
+} nsapi_datagram_t;
+
+
+/** Maximum number of segments in a received buffer chain
+ */
+#ifndef NSAPI_CHAIN_SEGMENTS
+#define NSAPI_CHAIN_SEGMENTS 4
+#endif
+
+/** Contiguous segment of received data
+ */
+typedef struct nsapi_segment {
+    const void *data;           /*!< start of the segment */
+    nsapi_size_t size;          /*!< length of the segment in bytes */
+} nsapi_segment_t;
+
+/** Read-only view of received data held by the network stack
+ *
+ *  The segments reference buffers owned by the stack, which are kept
+ *  until the chain is released.
+ */
+typedef struct nsapi_chain {
+    nsapi_segment_t segment[NSAPI_CHAIN_SEGMENTS]; /*!< segments in order */
+    unsigned count;             /*!< number of valid segments */
+    nsapi_size_t size;          /*!< total length of the segments in bytes */
+    void *token;                /*!< stack-specific handle of the buffers */
+} nsapi_chain_t;
+
+
 /** Enum of socket protocols
  *
  *  The socket protocol specifies a particular protocol to
@@ -183,8 +235,49 @@ typedef enum nsapi_stack_level {
 typedef enum nsapi_stack_option {
     NSAPI_IPV4_MRU, /*!< Sets/gets size of largest IPv4 fragmented datagram to reassemble */
     NSAPI_IPV6_MRU, /*!< Sets/gets size of largest IPv6 fragmented datagram to reassemble */
+    NSAPI_STACK_STATS, /*!< Gets the stack counters as an nsapi_stack_stats_t */
 } nsapi_stack_option_t;
 
+/** nsapi_stack_proto_stats structure
+ *
+ *  Packet counters of one protocol layer
+ */
+typedef struct nsapi_stack_proto_stats {
+    uint32_t xmit;  /*!< Packets transmitted */
+    uint32_t recv;  /*!< Packets received */
+    uint32_t drop;  /*!< Packets dropped */
+    uint32_t err;   /*!< Checksum, length, memory, routing and protocol errors */
+} nsapi_stack_proto_stats_t;
+
+/** nsapi_stack_pool_stats structure
+ *
+ *  Usage of one of the stack's memory pools
+ */
+typedef struct nsapi_stack_pool_stats {
+    uint32_t avail; /*!< Size of the pool */
+    uint32_t used;  /*!< Currently allocated */
+    uint32_t max;   /*!< Most ever allocated at once */
+    uint32_t err;   /*!< Failed allocations */
+} nsapi_stack_pool_stats_t;
+
+/** nsapi_stack_stats structure
+ *
+ *  Counters retrieved with getstackopt(NSAPI_STACK, NSAPI_STACK_STATS).
+ *  Counters the stack does not keep are left as zero.
+ */
+typedef struct nsapi_stack_stats {
+    nsapi_stack_proto_stats_t link;     /*!< Frames on the network interface */
+    nsapi_stack_proto_stats_t ip;       /*!< IPv4 and IPv6 packets */
+    nsapi_stack_proto_stats_t udp;      /*!< UDP datagrams */
+    nsapi_stack_proto_stats_t tcp;      /*!< TCP segments */
+    uint32_t tcp_retransmit;            /*!< TCP segments retransmitted */
+    nsapi_stack_pool_stats_t heap;      /*!< Stack heap, in bytes */
+    nsapi_stack_pool_stats_t pbuf_pool; /*!< Receive buffers */
+    nsapi_stack_pool_stats_t pbuf;      /*!< Buffer headers referencing other memory */
+    nsapi_stack_pool_stats_t tcp_seg;   /*!< Queued TCP segments */
+    uint32_t mbox_full;                 /*!< Messages dropped by a full mailbox */
+} nsapi_stack_stats_t;
+
 /*  Enum of standardized socket option levels
  *  for use with Socket::setsockopt and getsockopt.
  *
@@ -207,11 +300,21 @@ typedef enum nsapi_socket_option {
     NSAPI_KEEPALIVE, /*!< Enables sending of keepalive messages */
     NSAPI_KEEPIDLE,  /*!< Sets timeout value to initiate keepalive */
     NSAPI_KEEPINTVL, /*!< Sets timeout value for keepalive */
-    NSAPI_LINGER,    /*!< Keeps close from returning until queues empty */
+    NSAPI_LINGER,    /*!< Keeps close from returning until queues empty, takes an nsapi_linger_t */
     NSAPI_SNDBUF,    /*!< Sets send buffer size */
     NSAPI_RCVBUF,    /*!< Sets recv buffer size */
+    NSAPI_TCP_NODELAY, /*!< Disables Nagle's algorithm, so small writes are sent without waiting */
 } nsapi_socket_option_t;
 
+/** nsapi_linger structure
+ *
+ *  Value of the NSAPI_LINGER socket option
+ */
+typedef struct nsapi_linger {
+    int l_onoff;    /*!< Nonzero to wait in close for sent data to be acknowledged */
+    int l_linger;   /*!< Seconds to wait, 0 resets the connection if data is left */
+} nsapi_linger_t;
+
 /* Backwards compatibility - previously didn't distinguish stack and socket options */
 typedef nsapi_socket_level_t nsapi_level_t;
 typedef nsapi_socket_option_t nsapi_option_t;
@@ -539,6 +642,141 @@ typedef struct nsapi_stack_api
      */    
     nsapi_error_t (*getsockopt)(nsapi_stack_t *stack, nsapi_socket_t socket, int level,
             int optname, void *optval, unsigned *optlen);
+
+    /** Send data over a TCP socket without copying it
+     *
+     *  Like socket_send, but the stack keeps references to the sent bytes
+     *  of the buffer until they are acknowledged by the remote host, then
+     *  calls the callback. The callback is not called if no bytes were
+     *  sent, and may be called from the context of the stack.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param data     Buffer of data to send to the host
+     *  @param size     Size of the buffer in bytes
+     *  @param callback Function to call once the sent bytes can be reused,
+     *                  may be null
+     *  @param context  Argument to pass to callback
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_send_nocopy)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            const void *data, nsapi_size_t size, void (*callback)(void *), void *context);
+
+    /** Receive data without copying it
+     *
+     *  Fills the chain with views of the received data still held by
+     *  the stack. For a TCP socket, the data not covered by the chain
+     *  remains for the next receive. For a UDP socket, the chain holds
+     *  one datagram and stores its source in addr and port if addr is
+     *  not NULL; segments that do not fit in the chain are discarded.
+     *
+     *  The chain must be released with socket_recv_release whenever
+     *  this returns a non-negative size.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param addr     Destination for the address of the remote host or NULL
+     *  @param port     Destination for the port of the remote host
+     *  @param chain    Destination for the received segments
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_recv_chain)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_addr_t *addr, uint16_t *port, nsapi_chain_t *chain);
+
+    /** Release a chain returned by socket_recv_chain
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param chain    Chain to release
+     */
+    void (*socket_recv_release)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_chain_t *chain);
+
+    /** Send data gathered from several buffers
+     *
+     *  Sends the buffers in order as if they were one contiguous buffer.
+     *  For a TCP socket addr is NULL; for a UDP socket the buffers form
+     *  a single datagram sent to addr and port.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param addr     The address of the remote host, or NULL
+     *  @param port     The port of the remote host
+     *  @param iov      Array of buffers to send
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_sendmsg)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            const nsapi_addr_t *addr, uint16_t port, const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Receive data scattered into several buffers
+     *
+     *  Fills the buffers in order as if they were one contiguous buffer.
+     *  For a UDP socket the source of the datagram is stored in addr and
+     *  port if addr is not NULL.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param addr     Destination for the address of the remote host or NULL
+     *  @param port     Destination for the port of the remote host
+     *  @param iov      Array of buffers to receive into
+     *  @param iovcnt   Number of buffers in the array
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_recvmsg)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_addr_t *addr, uint16_t *port, const nsapi_iovec_t *iov, unsigned iovcnt);
+
+    /** Send several datagrams over a UDP socket
+     *
+     *  Sends the datagrams in order, each of length size to the address
+     *  and port of its descriptor, until one would block or fails.
+     *
+     *  This call is non-blocking. If the first send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of datagrams sent on success, negative error
+     *                  code if no datagram could be sent
+     */
+    nsapi_size_or_error_t (*socket_sendto_many)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_datagram_t *msgs, unsigned count);
+
+    /** Receive several datagrams over a UDP socket
+     *
+     *  Takes the datagrams already queued on the socket, up to count, and
+     *  fills in the address, port and length of each descriptor.
+     *
+     *  This call is non-blocking. If no datagram is queued,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param msgs     Array of datagrams to receive into
+     *  @param count    Number of datagrams in the array
+     *  @return         Number of datagrams received on success, negative
+     *                  error code on failure
+     */
+    nsapi_size_or_error_t (*socket_recvfrom_many)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_datagram_t *msgs, unsigned count);
 } nsapi_stack_api_t;
 
 
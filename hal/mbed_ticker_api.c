@@ -17,6 +17,15 @@
 #include "hal/ticker_api.h"
 #include "platform/critical.h"
 
+static void update_present_time(const ticker_data_t *const data)
+{
+    uint32_t ticker_time = data->interface->read();
+
+    // Unsigned subtraction accounts for a single wrap of the counter
+    data->queue->present_time += (uint32_t)(ticker_time - data->queue->tick_last_read);
+    data->queue->tick_last_read = ticker_time;
+}
+
 void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
     data->interface->init();
 
@@ -25,6 +34,7 @@ void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler ha
 
 void ticker_irq_handler(const ticker_data_t *const data) {
     data->interface->clear_interrupt();
+    update_present_time(data);
 
     /* Go through all the pending TimerEvents */
     while (1) {
@@ -56,6 +66,7 @@ void ticker_irq_handler(const ticker_data_t *const data) {
 void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id) {
     /* disable interrupts for the duration of the function */
     core_util_critical_section_enter();
+    update_present_time(data);
 
     // initialise our data
     obj->timestamp = timestamp;
@@ -119,6 +130,18 @@ timestamp_t ticker_read(const ticker_data_t *const data)
     return data->interface->read();
 }
 
+us_timestamp_t ticker_read_us(const ticker_data_t *const data)
+{
+    us_timestamp_t present_time;
+
+    core_util_critical_section_enter();
+    update_present_time(data);
+    present_time = data->queue->present_time;
+    core_util_critical_section_exit();
+
+    return present_time;
+}
+
 int ticker_get_next_timestamp(const ticker_data_t *const data, timestamp_t *timestamp)
 {
     int ret = 0;
@@ -35,6 +35,11 @@ const ticker_data_t* get_us_ticker_data(void)
     return &us_data;
 }
 
+us_timestamp_t us_ticker_read_us(void)
+{
+    return ticker_read_us(&us_data);
+}
+
 void us_ticker_irq_handler(void)
 {
     ticker_irq_handler(&us_data);
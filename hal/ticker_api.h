@@ -24,6 +24,9 @@
 
 typedef uint32_t timestamp_t;
 
+/** 64-bit microsecond timestamp that does not wrap in practice */
+typedef uint64_t us_timestamp_t;
+
 /** Ticker's event structure
  */
 typedef struct ticker_event_s {
@@ -49,6 +52,8 @@ typedef struct {
 typedef struct {
     ticker_event_handler event_handler; /**< Event handler */
     ticker_event_t *head;               /**< A pointer to head */
+    uint32_t tick_last_read;            /**< Counter value at the last 64-bit time update */
+    us_timestamp_t present_time;        /**< 64-bit time at the last update */
 } ticker_event_queue_t;
 
 /** Ticker's data structure
@@ -103,6 +108,18 @@ void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, t
  */
 timestamp_t ticker_read(const ticker_data_t *const data);
 
+/** Read the current ticker's timestamp extended to 64 bits
+ *
+ * The 64-bit time is extended on every call, on every event insertion and
+ * on every ticker interrupt, so it stays correct as long as one of these
+ * happens at least once per wrap of the underlying counter. Its low 32 bits
+ * always match ticker_read.
+ *
+ * @param data The ticker's data
+ * @return The current 64-bit timestamp
+ */
+us_timestamp_t ticker_read_us(const ticker_data_t *const data);
+
 /** Read the next event's timestamp
  *
  * @param data The ticker's data
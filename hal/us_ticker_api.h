@@ -43,6 +43,12 @@ const ticker_data_t* get_us_ticker_data(void);
  */
 void us_ticker_irq_handler(void);
 
+/** Read the us ticker extended to a 64-bit timebase
+ *
+ * @return The time in microseconds since the ticker started, see ticker_read_us
+ */
+us_timestamp_t us_ticker_read_us(void);
+
 /* HAL us ticker */
 
 /** Initialize the ticker
@@ -0,0 +1,186 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed_checksum.h"
+#include <string.h>
+
+#if MBED_CONF_PLATFORM_CHECKSUM_SIMD && defined(__SSE2__)
+#define MBED_CHECKSUM_SSE2
+#include <emmintrin.h>
+#elif MBED_CONF_PLATFORM_CHECKSUM_SIMD && defined(__ARM_NEON)
+#define MBED_CHECKSUM_NEON
+#include <arm_neon.h>
+#endif
+
+static inline uint32_t load32(const uint8_t *p)
+{
+    // memcpy keeps this free of alignment and aliasing assumptions,
+    // compilers reduce it to a single load
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline uint16_t load16(const uint8_t *p)
+{
+    uint16_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline uint16_t fold(uint64_t sum)
+{
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    return (uint16_t)sum;
+}
+
+static inline uint16_t swap16(uint16_t x)
+{
+    return (uint16_t)((x << 8) | (x >> 8));
+}
+
+/* Sums an even aligned buffer, returns an unfolded 64-bit sum */
+static uint64_t sum_words(const uint8_t *p, size_t len)
+{
+    uint64_t sum = 0;
+
+    // Align to a word so the main loop does not straddle words
+    if (((uintptr_t)p & 2) && len >= 2) {
+        sum += load16(p);
+        p += 2;
+        len -= 2;
+    }
+
+    while (len >= 16) {
+        sum += load32(p);
+        sum += load32(p + 4);
+        sum += load32(p + 8);
+        sum += load32(p + 12);
+        p += 16;
+        len -= 16;
+    }
+
+    while (len >= 4) {
+        sum += load32(p);
+        p += 4;
+        len -= 4;
+    }
+
+    if (len >= 2) {
+        sum += load16(p);
+        p += 2;
+        len -= 2;
+    }
+
+    if (len) {
+        // Trailing byte sits in the first byte of a zero padded word
+        uint16_t t = 0;
+        *(uint8_t *)&t = *p;
+        sum += t;
+    }
+
+    return sum;
+}
+
+/* Sums the leading byte of an odd aligned buffer, the rest of the buffer
+ * is summed as if it started at an even address and swapped at the end */
+static uint64_t sum_odd_byte(const uint8_t *p)
+{
+    uint16_t t = 0;
+    ((uint8_t *)&t)[1] = *p;
+    return t;
+}
+
+uint16_t mbed_checksum_portable(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    int odd = (uintptr_t)p & 1;
+    uint64_t sum = 0;
+
+    if (odd && len) {
+        sum += sum_odd_byte(p);
+        p += 1;
+        len -= 1;
+    }
+
+    sum += sum_words(p, len);
+
+    uint16_t sum16 = fold(sum);
+    return odd ? swap16(sum16) : sum16;
+}
+
+#if defined(MBED_CHECKSUM_SSE2) || defined(MBED_CHECKSUM_NEON)
+
+/* 16-byte blocks that can be added to 32-bit lanes before they may overflow */
+#define SIMD_BLOCKS_MAX 0x4000
+
+uint16_t mbed_checksum(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    int odd = (uintptr_t)p & 1;
+    uint64_t sum = 0;
+
+    if (odd && len) {
+        sum += sum_odd_byte(p);
+        p += 1;
+        len -= 1;
+    }
+
+    while (len >= 16) {
+        size_t blocks = len / 16;
+        if (blocks > SIMD_BLOCKS_MAX) {
+            blocks = SIMD_BLOCKS_MAX;
+        }
+        len -= blocks * 16;
+
+        uint32_t lanes[4];
+#if defined(MBED_CHECKSUM_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (size_t i = 0; i < blocks; i++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)p);
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+            p += 16;
+        }
+        _mm_storeu_si128((__m128i *)lanes, acc);
+#else
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (size_t i = 0; i < blocks; i++) {
+            acc = vpadalq_u16(acc, vreinterpretq_u16_u8(vld1q_u8(p)));
+            p += 16;
+        }
+        vst1q_u32(lanes, acc);
+#endif
+        sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    sum += sum_words(p, len);
+
+    uint16_t sum16 = fold(sum);
+    return odd ? swap16(sum16) : sum16;
+}
+
+#else
+
+uint16_t mbed_checksum(const void *data, size_t len)
+{
+    return mbed_checksum_portable(data, len);
+}
+
+#endif
@@ -0,0 +1,65 @@
+
+/** \addtogroup platform */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CHECKSUM_H
+#define MBED_CHECKSUM_H
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compute the Internet checksum (RFC 1071) of a buffer
+ *
+ * Returns the 16-bit one's complement sum of the data, not inverted. The
+ * sum is in memory order: storing it as a 16-bit value gives the checksum
+ * bytes in network order, so on little-endian cores it is byte swapped
+ * compared to summing big-endian words. This matches what lwIP expects
+ * from LWIP_CHKSUM.
+ *
+ * Any alignment and length are supported. Uses SIMD instructions when
+ * the platform.checksum-simd option is enabled and the core has SSE2 or
+ * NEON, otherwise falls back to mbed_checksum_portable.
+ *
+ * @param data  Data to sum
+ * @param len   Length of the data in bytes
+ * @return      One's complement sum in memory order
+ */
+uint16_t mbed_checksum(const void *data, size_t len);
+
+/**
+ * Compute the Internet checksum of a buffer in portable C
+ *
+ * Sums 32-bit words into a 64-bit accumulator so carries only need to be
+ * folded once at the end. Gives the same result as mbed_checksum.
+ *
+ * @param data  Data to sum
+ * @param len   Length of the data in bytes
+ * @return      One's complement sum in memory order
+ */
+uint16_t mbed_checksum_portable(const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
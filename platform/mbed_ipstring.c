@@ -0,0 +1,247 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed_ipstring.h"
+#include <string.h>
+
+/* Character classes, the low nibble holds the digit value */
+#define CLASS_DEC   0x10
+#define CLASS_HEX   0x20
+#define CLASS_COLON 0x40
+#define CLASS_DOT   0x80
+#define CLASS_VALUE 0x0f
+
+#define DEC(v) (CLASS_DEC | CLASS_HEX | (v))
+#define HEX(v) (CLASS_HEX | (v))
+
+/* Anything not listed, including all non-ASCII characters, is invalid */
+static const uint8_t char_class[128] = {
+    ['0'] = DEC(0),  ['1'] = DEC(1),  ['2'] = DEC(2),  ['3'] = DEC(3),
+    ['4'] = DEC(4),  ['5'] = DEC(5),  ['6'] = DEC(6),  ['7'] = DEC(7),
+    ['8'] = DEC(8),  ['9'] = DEC(9),
+    ['a'] = HEX(10), ['b'] = HEX(11), ['c'] = HEX(12),
+    ['d'] = HEX(13), ['e'] = HEX(14), ['f'] = HEX(15),
+    ['A'] = HEX(10), ['B'] = HEX(11), ['C'] = HEX(12),
+    ['D'] = HEX(13), ['E'] = HEX(14), ['F'] = HEX(15),
+    [':'] = CLASS_COLON,
+    ['.'] = CLASS_DOT,
+};
+
+static const char hex_digits[16] = "0123456789abcdef";
+
+static inline uint8_t classify(char c)
+{
+    unsigned char u = (unsigned char)c;
+    return u < sizeof(char_class) ? char_class[u] : 0;
+}
+
+bool mbed_ipv4_from_string(const char *str, size_t len, uint8_t addr[4])
+{
+    const char *end = str + len;
+    uint8_t bytes[4];
+
+    for (int i = 0; i < 4; i++) {
+        if (i > 0) {
+            if (str == end || !(classify(*str) & CLASS_DOT)) {
+                return false;
+            }
+            str++;
+        }
+
+        unsigned value = 0;
+        int digits = 0;
+        uint8_t c;
+        while (str < end && digits < 3 && ((c = classify(*str)) & CLASS_DEC)) {
+            // Leading zeros are rejected, as inet_pton does
+            if (digits == 1 && value == 0) {
+                return false;
+            }
+            value = value * 10 + (c & CLASS_VALUE);
+            str++;
+            digits++;
+        }
+
+        if (!digits || value > 255) {
+            return false;
+        }
+        bytes[i] = (uint8_t)value;
+    }
+
+    if (str != end) {
+        return false;
+    }
+
+    memcpy(addr, bytes, sizeof(bytes));
+    return true;
+}
+
+bool mbed_ipv6_from_string(const char *str, size_t len, uint8_t addr[16])
+{
+    const char *end = str + len;
+    uint8_t bytes[16];
+    int n = 0;      // bytes parsed so far
+    int gap = -1;   // byte offset of the "::", if any
+
+    if (len >= 2 && str[0] == ':' && str[1] == ':') {
+        gap = 0;
+        str += 2;
+    }
+
+    while (str < end) {
+        const char *group = str;
+        unsigned value = 0;
+        uint8_t c;
+        while (str < end && str - group < 4 && ((c = classify(*str)) & CLASS_HEX)) {
+            value = (value << 4) | (c & CLASS_VALUE);
+            str++;
+        }
+
+        if (str == group) {
+            return false;
+        }
+
+        // A dot means the group was the start of a trailing IPv4 address
+        if (str < end && (classify(*str) & CLASS_DOT)) {
+            if (n > 12 || !mbed_ipv4_from_string(group, end - group, &bytes[n])) {
+                return false;
+            }
+            n += 4;
+            break;
+        }
+
+        if (n == 16) {
+            return false;
+        }
+        bytes[n++] = (uint8_t)(value >> 8);
+        bytes[n++] = (uint8_t)value;
+
+        if (str == end) {
+            break;
+        }
+
+        // Groups are only followed by ':' or "::", which also rejects
+        // groups of more than four digits
+        if (!(classify(*str) & CLASS_COLON)) {
+            return false;
+        }
+        str++;
+
+        if (str < end && (classify(*str) & CLASS_COLON)) {
+            if (gap >= 0) {
+                return false;
+            }
+            gap = n;
+            str++;
+        } else if (str == end) {
+            return false;
+        }
+    }
+
+    if (gap < 0) {
+        if (n != 16) {
+            return false;
+        }
+    } else {
+        // "::" stands for at least one group
+        if (n > 14) {
+            return false;
+        }
+        memmove(&bytes[gap + 16 - n], &bytes[gap], n - gap);
+        memset(&bytes[gap], 0, 16 - n);
+    }
+
+    memcpy(addr, bytes, sizeof(bytes));
+    return true;
+}
+
+size_t mbed_ipv4_to_string(const uint8_t addr[4], char *str)
+{
+    char *p = str;
+
+    for (int i = 0; i < 4; i++) {
+        unsigned value = addr[i];
+        if (i > 0) {
+            *p++ = '.';
+        }
+        if (value >= 100) {
+            *p++ = '0' + value / 100;
+            value %= 100;
+            *p++ = '0' + value / 10;
+        } else if (value >= 10) {
+            *p++ = '0' + value / 10;
+        }
+        *p++ = '0' + value % 10;
+    }
+    *p = '\0';
+
+    return p - str;
+}
+
+size_t mbed_ipv6_to_string(const uint8_t addr[16], char *str)
+{
+    uint16_t groups[8];
+    int zero_start = -1;
+    int zero_len = 1;   // runs of a single zero group are not compressed
+    char *p = str;
+
+    for (int i = 0; i < 8; i++) {
+        groups[i] = (uint16_t)(addr[2*i] << 8 | addr[2*i + 1]);
+    }
+
+    // Find the first longest run of zero groups, RFC 5952 section 4.2
+    for (int i = 0; i < 8; i++) {
+        int run = 0;
+        while (i + run < 8 && groups[i + run] == 0) {
+            run++;
+        }
+        if (run > zero_len) {
+            zero_start = i;
+            zero_len = run;
+        }
+        i += run;
+    }
+
+    for (int i = 0; i < 8;) {
+        if (i == zero_start) {
+            if (i == 0) {
+                *p++ = ':';
+            }
+            *p++ = ':';
+            i += zero_len;
+            continue;
+        }
+
+        // Lower case hex without leading zeros, RFC 5952 sections 4.1 and 4.3
+        unsigned group = groups[i];
+        if (group >= 0x1000) {
+            *p++ = hex_digits[group >> 12];
+        }
+        if (group >= 0x100) {
+            *p++ = hex_digits[(group >> 8) & 0xf];
+        }
+        if (group >= 0x10) {
+            *p++ = hex_digits[(group >> 4) & 0xf];
+        }
+        *p++ = hex_digits[group & 0xf];
+
+        i++;
+        if (i != 8) {
+            *p++ = ':';
+        }
+    }
+    *p = '\0';
+
+    return p - str;
+}
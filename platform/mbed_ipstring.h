@@ -0,0 +1,100 @@
+
+/** \addtogroup platform */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_IPSTRING_H
+#define MBED_IPSTRING_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Size of a buffer that can hold any formatted IPv4 address,
+ *  including the terminating null character
+ */
+#define MBED_IPV4_STRING_SIZE 16
+
+/** Size of a buffer that can hold any formatted IPv6 address,
+ *  including the terminating null character
+ */
+#define MBED_IPV6_STRING_SIZE 40
+
+/**
+ * Parse a dotted-decimal IPv4 address
+ *
+ * Accepts exactly four decimal fields of one to three digits, each at
+ * most 255 and without leading zeros. The string does not need to be null terminated; all len
+ * characters must be part of the address.
+ *
+ * @param str   Address string
+ * @param len   Length of the string in characters
+ * @param addr  Destination for the 4 address bytes, left untouched on failure
+ * @return      True if the string is a valid IPv4 address
+ */
+bool mbed_ipv4_from_string(const char *str, size_t len, uint8_t addr[4]);
+
+/**
+ * Parse a textual IPv6 address
+ *
+ * Accepts the forms of RFC 4291 section 2.2: eight groups of one to four
+ * hex digits in either case, at most one "::" standing for one or more
+ * zero groups, and an optional dotted-decimal IPv4 address in the last
+ * 32 bits. Zone identifiers and prefix lengths are not accepted.
+ *
+ * @param str   Address string
+ * @param len   Length of the string in characters
+ * @param addr  Destination for the 16 address bytes, left untouched on failure
+ * @return      True if the string is a valid IPv6 address
+ */
+bool mbed_ipv6_from_string(const char *str, size_t len, uint8_t addr[16]);
+
+/**
+ * Format an IPv4 address in dotted-decimal form
+ *
+ * @param addr  4 address bytes
+ * @param str   Destination, at least MBED_IPV4_STRING_SIZE bytes
+ * @return      Length of the string, excluding the terminating null character
+ */
+size_t mbed_ipv4_to_string(const uint8_t addr[4], char *str);
+
+/**
+ * Format an IPv6 address in the canonical form of RFC 5952
+ *
+ * Groups are printed in lower case without leading zeros, and the longest
+ * run of two or more zero groups is replaced by "::", the first one if
+ * there is a tie. IPv4-mapped addresses are printed in hex like any other.
+ *
+ * The result is at most 39 characters, eight groups of four digits and
+ * seven colons, so with the null character it needs MBED_IPV6_STRING_SIZE
+ * bytes, the same as NSAPI_IPv6_SIZE.
+ *
+ * @param addr  16 address bytes
+ * @param str   Destination, at least MBED_IPV6_STRING_SIZE bytes
+ * @return      Length of the string, excluding the terminating null character
+ */
+size_t mbed_ipv6_to_string(const uint8_t addr[16], char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
@@ -64,6 +64,121 @@ size_t mbed_stats_stack_get_each(mbed_stats_stack_t *stats, size_t count)
     return i;
 }
 
+#if MBED_STACK_STATS_ENABLED && MBED_CONF_RTOS_PRESENT
+#if defined(__MBED_CMSIS_RTOS_CM)
+#define STACK_INFO_SAMPLE   osThreadInfoStackWatermark
+#else
+#define STACK_INFO_SAMPLE   osThreadInfoStackMax
+#endif
+
+static void stack_sample(osThreadId threadid, mbed_stats_stack_t *stats)
+{
+    osEvent e;
+
+    e = _osThreadGetInfo(threadid, STACK_INFO_SAMPLE);
+    if (e.status == osOK) {
+       stats->max_size = (uint32_t)e.value.p;
+    }
+
+    e = _osThreadGetInfo(threadid, osThreadInfoStackSize);
+    if (e.status == osOK) {
+       stats->reserved_size = (uint32_t)e.value.p;
+    }
+
+    stats->thread_id = (uint32_t)threadid;
+    stats->stack_cnt = 1;
+}
+#endif
+
+size_t mbed_stats_stack_sample_each(mbed_stats_stack_t *stats, size_t count)
+{
+    memset(stats, 0, count*sizeof(mbed_stats_stack_t));
+    size_t i = 0;
+
+#if MBED_STACK_STATS_ENABLED && MBED_CONF_RTOS_PRESENT
+    osThreadEnumId enumid = _osThreadsEnumStart();
+    osThreadId threadid;
+
+    while ((threadid = _osThreadEnumNext(enumid)) && i < count) {
+        stack_sample(threadid, &stats[i]);
+        i += 1;
+    }
+#endif
+
+    return i;
+}
+
+#if MBED_STACK_STATS_ENABLED && MBED_CONF_RTOS_PRESENT
+static mbed_stats_stack_cb_t sampler_cb;
+static uint32_t sampler_threshold;
+static osTimerId sampler_id;
+
+static void stack_sampler(void const *arg)
+{
+    osThreadEnumId enumid = _osThreadsEnumStart();
+    osThreadId threadid;
+
+    while ((threadid = _osThreadEnumNext(enumid))) {
+        mbed_stats_stack_t stats;
+        uint32_t last = 0;
+
+#if defined(__MBED_CMSIS_RTOS_CM)
+        osEvent e = _osThreadGetInfo(threadid, osThreadInfoStackWatermarkLast);
+        if (e.status == osOK) {
+            last = (uint32_t)e.value.p;
+        }
+#endif
+
+        memset(&stats, 0, sizeof(stats));
+        stack_sample(threadid, &stats);
+
+        // Only report usage that grew into the threshold band
+        if (stats.max_size > last &&
+            (uint64_t)stats.max_size * 100 >= (uint64_t)stats.reserved_size * sampler_threshold) {
+            sampler_cb(&stats);
+        }
+    }
+}
+
+osTimerDef(stack_sampler_timer, stack_sampler);
+#endif
+
+int mbed_stats_stack_sampler_start(uint32_t period_ms, uint32_t threshold_percent, mbed_stats_stack_cb_t cb)
+{
+#if MBED_STACK_STATS_ENABLED && MBED_CONF_RTOS_PRESENT
+    if (sampler_id != NULL || cb == NULL) {
+        return -1;
+    }
+
+    sampler_cb = cb;
+    sampler_threshold = threshold_percent;
+    sampler_id = osTimerCreate(osTimer(stack_sampler_timer), osTimerPeriodic, NULL);
+    if (sampler_id == NULL) {
+        return -1;
+    }
+
+    if (osTimerStart(sampler_id, period_ms) != osOK) {
+        osTimerDelete(sampler_id);
+        sampler_id = NULL;
+        return -1;
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void mbed_stats_stack_sampler_stop(void)
+{
+#if MBED_STACK_STATS_ENABLED && MBED_CONF_RTOS_PRESENT
+    if (sampler_id != NULL) {
+        osTimerStop(sampler_id);
+        osTimerDelete(sampler_id);
+        sampler_id = NULL;
+    }
+#endif
+}
+
 #if MBED_STACK_STATS_ENABLED && !MBED_CONF_RTOS_PRESENT
 #warning Stack statistics are currently not supported without the rtos.
 #endif
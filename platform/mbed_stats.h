@@ -66,6 +66,47 @@ void mbed_stats_stack_get(mbed_stats_stack_t *stats);
  */
 size_t mbed_stats_stack_get_each(mbed_stats_stack_t *stats, size_t count);
 
+/**
+ *  Fill the passed array of stat structures with the stack stats for each
+ *  available stack, resuming each watermark scan from the high-water mark
+ *  found by the previous scan instead of rescanning the whole stack.
+ *
+ *  Growth below a run of untouched words (e.g. a large uninitialised local
+ *  array) is only picked up by the next mbed_stats_stack_get_each.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_stack_t structures to fill
+ *  @param count    The number of mbed_stats_stack_t structures in the provided array
+ *  @return         The number of mbed_stats_stack_t structures that have been filled,
+ *                  this is equal to the number of stacks on the system.
+ */
+size_t mbed_stats_stack_sample_each(mbed_stats_stack_t *stats, size_t count);
+
+/**
+ *  Callback type of the background stack sampler
+ *
+ *  @param stats    Stack stats of the thread whose usage crossed the threshold
+ */
+typedef void (*mbed_stats_stack_cb_t)(const mbed_stats_stack_t *stats);
+
+/**
+ *  Start sampling the stacks of all threads in the background.
+ *
+ *  Every period_ms, each stack is sampled as with mbed_stats_stack_sample_each.
+ *  The callback is called from the RTOS timer thread for every thread whose
+ *  maximum usage has grown to at least threshold_percent of its stack size.
+ *
+ *  @param period_ms            Sampling period in milliseconds
+ *  @param threshold_percent    Usage threshold in percent of the stack size
+ *  @param cb                   Callback for threads over the threshold
+ *  @return                     0 on success, -1 if the sampler could not be started
+ */
+int mbed_stats_stack_sampler_start(uint32_t period_ms, uint32_t threshold_percent, mbed_stats_stack_cb_t cb);
+
+/**
+ *  Stop the background stack sampler
+ */
+void mbed_stats_stack_sampler_stop(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -87,6 +87,57 @@ public:
         return osMailGet(_mail_id, millisec);
     }
 
+    /** Put several mails in the queue, waking waiting threads at most once per batch.
+      Together with Mail::alloc this lets a producer fill queue storage in place and
+      publish a whole batch with a single kernel call.
+      @param   mptrs  array of memory blocks previously allocated with Mail::alloc or Mail::calloc.
+      @param   count  number of memory blocks in mptrs.
+      @return  number of mails put, from the start of mptrs.
+    */
+    uint32_t put_many(T **mptrs, uint32_t count) {
+    #if defined(osFeature_MessageBatch) && (osFeature_MessageBatch != 0)
+        return osMailPutBatch(_mail_id, (void* const*)mptrs, count);
+    #else
+        uint32_t sent;
+        for (sent = 0; sent < count; sent++) {
+            if (osMailPut(_mail_id, (void*)mptrs[sent]) != osOK) {
+                break;
+            }
+        }
+        return sent;
+    #endif
+    }
+
+    /** Get several mails from a queue, waiting only for the first one.
+      @param   mptrs     array receiving the memory blocks.
+      @param   count     maximum number of mails to get.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  number of mails received; each must be released with Mail::free.
+    */
+    uint32_t get_many(T **mptrs, uint32_t count, uint32_t millisec=osWaitForever) {
+        if (count == 0) {
+            return 0;
+        }
+        osEvent evt = osMailGet(_mail_id, millisec);
+        if (evt.status != osEventMail) {
+            return 0;
+        }
+        mptrs[0] = (T*)evt.value.p;
+    #if defined(osFeature_MessageBatch) && (osFeature_MessageBatch != 0)
+        return 1 + osMailGetBatch(_mail_id, (void**)(mptrs + 1), count - 1);
+    #else
+        uint32_t recv;
+        for (recv = 1; recv < count; recv++) {
+            evt = osMailGet(_mail_id, 0);
+            if (evt.status != osEventMail) {
+                break;
+            }
+            mptrs[recv] = (T*)evt.value.p;
+        }
+        return recv;
+    #endif
+    }
+
     /** Free a memory block from a mail.
       @param   mptr  pointer to the memory block that was obtained with Mail::get.
       @return  status code that indicates the execution status of the function.
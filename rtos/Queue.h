@@ -71,7 +71,73 @@ public:
         return osMessageGet(_queue_id, millisec);
     }
 
+    /** Put several messages in a Queue, waking waiting threads at most once per batch.
+      @param   data      array of message pointers.
+      @param   count     number of messages in data.
+      @param   millisec  timeout value applied to each wait for free space or 0 in case of no time-out. (default: 0)
+      @return  number of messages put, from the start of data.
+    */
+    uint32_t put_many(T **data, uint32_t count, uint32_t millisec=0) {
+        uint32_t sent = put_batch(data, count);
+        while (sent < count && millisec != 0) {
+            if (osMessagePut(_queue_id, (uint32_t)data[sent], millisec) != osOK) {
+                break;
+            }
+            sent++;
+            sent += put_batch(data + sent, count - sent);
+        }
+        return sent;
+    }
+
+    /** Get several messages from a Queue, waiting only for the first one.
+      @param   data      array receiving the message pointers.
+      @param   count     maximum number of messages to get.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  number of messages received.
+    */
+    uint32_t get_many(T **data, uint32_t count, uint32_t millisec=osWaitForever) {
+        if (count == 0) {
+            return 0;
+        }
+        osEvent evt = osMessageGet(_queue_id, millisec);
+        if (evt.status != osEventMessage) {
+            return 0;
+        }
+        data[0] = (T*)evt.value.p;
+        return 1 + get_batch(data + 1, count - 1);
+    }
+
 private:
+    uint32_t put_batch(T **data, uint32_t count) {
+    #if defined(osFeature_MessageBatch) && (osFeature_MessageBatch != 0)
+        return osMessagePutBatch(_queue_id, (const uint32_t*)data, count);
+    #else
+        uint32_t sent;
+        for (sent = 0; sent < count; sent++) {
+            if (osMessagePut(_queue_id, (uint32_t)data[sent], 0) != osOK) {
+                break;
+            }
+        }
+        return sent;
+    #endif
+    }
+
+    uint32_t get_batch(T **data, uint32_t count) {
+    #if defined(osFeature_MessageBatch) && (osFeature_MessageBatch != 0)
+        return osMessageGetBatch(_queue_id, (uint32_t*)data, count);
+    #else
+        uint32_t recv;
+        for (recv = 0; recv < count; recv++) {
+            osEvent evt = osMessageGet(_queue_id, 0);
+            if (evt.status != osEventMessage) {
+                break;
+            }
+            data[recv] = (T*)evt.value.p;
+        }
+        return recv;
+    #endif
+    }
+
     osMessageQId    _queue_id;
     osMessageQDef_t _queue_def;
 #ifdef CMSIS_OS_RTX
@@ -0,0 +1,222 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "rtos/ThreadPool.h"
+
+#include "mbed.h"
+#include "hal/us_ticker_api.h"
+
+namespace rtos {
+
+ThreadPool::Job::Job()
+    : _done_sem(0), _done(true), _posted_us(0), _next(NULL), _pool(NULL) {
+}
+
+bool ThreadPool::Job::done() const {
+    ThreadPool *pool = _pool;
+    if (!pool) {
+        return _done;
+    }
+
+    // Workers publish completion under the pool mutex, so once this
+    // returns true the worker has let go of the job
+    pool->_mutex.lock();
+    bool done = _done;
+    pool->_mutex.unlock();
+    return done;
+}
+
+osStatus ThreadPool::Job::wait(uint32_t millisec) {
+    if (done()) {
+        return osOK;
+    }
+
+    if (_done_sem.wait(millisec) <= 0) {
+        return osErrorTimeoutResource;
+    }
+    return osOK;
+}
+
+ThreadPool::ThreadPool(uint32_t workers, uint32_t queue_depth,
+        osPriority priority, uint32_t stack_size)
+    : _workers(workers), _space_sem(queue_depth), _job_sem(0),
+      _head(NULL), _tail(NULL), _stopping(false),
+      _busy_workers(0), _queue_depth(0), _max_queue_depth(0),
+      _jobs_completed(0), _busy_time_us(0), _max_latency_us(0),
+      _total_latency_us(0) {
+    _start_us = us_ticker_read();
+
+    _threads = new Thread*[_workers];
+    for (uint32_t i = 0; i < _workers; i++) {
+        _threads[i] = new Thread(priority, stack_size);
+        if (_threads[i]->start(callback(this, &ThreadPool::worker)) != osOK) {
+            error("Error starting thread pool worker\n");
+        }
+    }
+}
+
+osStatus ThreadPool::post(Job *job, Callback<void()> task,
+        Callback<void()> complete, uint32_t millisec) {
+    _mutex.lock();
+    if (!job->_done || _stopping) {
+        _mutex.unlock();
+        return osErrorParameter;
+    }
+
+    // Claim the job so it cannot be posted twice while waiting for room
+    job->_done = false;
+    job->_pool = this;
+    _mutex.unlock();
+
+    if (_space_sem.wait(millisec) <= 0) {
+        _mutex.lock();
+        job->_done = true;
+        job->_pool = NULL;
+        _mutex.unlock();
+        return osErrorResource;
+    }
+
+    // Drop a completion token left over from a previous run of this job
+    while (job->_done_sem.wait(0) > 0) {
+    }
+
+    _mutex.lock();
+    if (_stopping) {
+        job->_done = true;
+        job->_pool = NULL;
+        _mutex.unlock();
+        _space_sem.release();
+        return osErrorParameter;
+    }
+
+    job->_task = task;
+    job->_complete = complete;
+    job->_next = NULL;
+    job->_posted_us = us_ticker_read();
+
+    if (_tail) {
+        _tail->_next = job;
+    } else {
+        _head = job;
+    }
+    _tail = job;
+    _queue_depth++;
+    if (_queue_depth > _max_queue_depth) {
+        _max_queue_depth = _queue_depth;
+    }
+    _mutex.unlock();
+
+    _job_sem.release();
+    return osOK;
+}
+
+void ThreadPool::worker() {
+    while (true) {
+        _job_sem.wait();
+
+        _mutex.lock();
+        Job *job = _head;
+        if (!job) {
+            // Woken up with an empty queue by shutdown
+            _mutex.unlock();
+            return;
+        }
+        _head = job->_next;
+        if (!_head) {
+            _tail = NULL;
+        }
+        _queue_depth--;
+        _busy_workers++;
+
+        uint32_t start = us_ticker_read();
+        uint32_t latency = start - job->_posted_us;
+        _total_latency_us += latency;
+        if (latency > _max_latency_us) {
+            _max_latency_us = latency;
+        }
+        _mutex.unlock();
+
+        _space_sem.release();
+
+        job->_task();
+        if (job->_complete) {
+            job->_complete();
+        }
+
+        _mutex.lock();
+        _busy_workers--;
+        _jobs_completed++;
+        _busy_time_us += us_ticker_read() - start;
+
+        // The job may be destroyed as soon as done() or wait() sees it
+        // complete, so nothing touches it after this point. Dropping the
+        // pool pointer lets done() outlive the pool
+        job->_done = true;
+        job->_pool = NULL;
+        job->_done_sem.release();
+        _mutex.unlock();
+    }
+}
+
+void ThreadPool::get_stats(thread_pool_stats_t *stats) {
+    _mutex.lock();
+    stats->workers = _workers;
+    stats->busy_workers = _busy_workers;
+    stats->queue_depth = _queue_depth;
+    stats->max_queue_depth = _max_queue_depth;
+    stats->jobs_completed = _jobs_completed;
+    stats->busy_time_us = _busy_time_us;
+    stats->uptime_us = us_ticker_read() - _start_us;
+    stats->max_latency_us = _max_latency_us;
+    stats->total_latency_us = _total_latency_us;
+    _mutex.unlock();
+}
+
+void ThreadPool::shutdown() {
+    _mutex.lock();
+    if (_stopping) {
+        _mutex.unlock();
+        return;
+    }
+    _stopping = true;
+    _mutex.unlock();
+
+    // Queued jobs are consumed first, then each worker picks up
+    // one empty wake-up and returns
+    for (uint32_t i = 0; i < _workers; i++) {
+        _job_sem.release();
+    }
+
+    for (uint32_t i = 0; i < _workers; i++) {
+        _threads[i]->join();
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+
+    for (uint32_t i = 0; i < _workers; i++) {
+        delete _threads[i];
+    }
+    delete[] _threads;
+}
+
+}
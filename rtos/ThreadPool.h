@@ -0,0 +1,172 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdint.h>
+#include "cmsis_os.h"
+#include "platform/Callback.h"
+#include "rtos/Thread.h"
+#include "rtos/Semaphore.h"
+#include "rtos/Mutex.h"
+
+namespace rtos {
+/** \addtogroup rtos */
+/** @{*/
+
+/** Statistics of a ThreadPool, as returned by ThreadPool::get_stats */
+typedef struct {
+    uint32_t workers;           /**< Number of worker threads */
+    uint32_t busy_workers;      /**< Workers currently running a job */
+    uint32_t queue_depth;       /**< Jobs waiting for a worker */
+    uint32_t max_queue_depth;   /**< Highest number of waiting jobs seen */
+    uint32_t jobs_completed;    /**< Jobs run to completion */
+    uint64_t busy_time_us;      /**< Time spent by all workers running jobs */
+    uint32_t uptime_us;         /**< Time since the pool was started, wraps like us_ticker_read */
+    uint32_t max_latency_us;    /**< Longest time a job waited for a worker */
+    uint64_t total_latency_us;  /**< Sum of the times jobs waited for a worker */
+} thread_pool_stats_t;
+
+/** The ThreadPool class runs jobs on a fixed set of worker threads sharing
+ *  a bounded job queue, instead of dedicating a thread and stack to each job.
+ *
+ *  Jobs are described by caller owned ThreadPool::Job objects, so posting
+ *  never allocates. A Job doubles as the future of the work it carries.
+ *
+ *  Example:
+ *  @code
+ *  #include "mbed.h"
+ *  #include "rtos.h"
+ *
+ *  ThreadPool pool(2, 8);
+ *  ThreadPool::Job job;
+ *
+ *  void work(int *value) {
+ *      *value *= 2;
+ *  }
+ *
+ *  int main() {
+ *      int value = 21;
+ *      pool.post(&job, callback(work, &value));
+ *      job.wait();
+ *      printf("%d\r\n", value);
+ *  }
+ *  @endcode
+ */
+class ThreadPool {
+public:
+    /** A unit of work posted to a ThreadPool and its completion handle */
+    class Job {
+    public:
+        Job();
+
+        /** Check if the job has run to completion
+          @return  true once the job function and its completion callback have returned.
+          @note not callable from interrupt
+        */
+        bool done() const;
+
+        /** Wait until the job has run to completion
+          @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+          @return  osOK if the job completed, osErrorTimeoutResource otherwise.
+          @note not callable from interrupt
+        */
+        osStatus wait(uint32_t millisec=osWaitForever);
+
+    private:
+        friend class ThreadPool;
+
+        // Jobs are linked into the pool queue and cannot be copied
+        Job(const Job&);
+        Job& operator=(const Job&);
+
+        mbed::Callback<void()> _task;
+        mbed::Callback<void()> _complete;
+        Semaphore _done_sem;
+        volatile bool _done;
+        uint32_t _posted_us;
+        Job *_next;
+        ThreadPool *volatile _pool;
+    };
+
+    /** Create a pool and start its worker threads
+      @param   workers      number of worker threads.
+      @param   queue_depth  maximum number of jobs waiting for a worker.
+      @param   priority     priority of the worker threads. (default: osPriorityNormal).
+      @param   stack_size   stack size (in bytes) of each worker thread. (default: DEFAULT_STACK_SIZE).
+    */
+    ThreadPool(uint32_t workers, uint32_t queue_depth,
+               osPriority priority=osPriorityNormal,
+               uint32_t stack_size=DEFAULT_STACK_SIZE);
+
+    /** Post a job to the pool
+      @param   job       job object, must stay valid until the job is done.
+      @param   task      function run by a worker thread.
+      @param   complete  function called by the worker once task has returned. (default: none).
+      @param   millisec  time to wait for room in the queue or 0 in case of no time-out. (default: 0).
+      @return  osOK on success, osErrorResource if the queue is full,
+               osErrorParameter if the job is still pending or the pool is stopping.
+    */
+    osStatus post(Job *job, mbed::Callback<void()> task,
+                  mbed::Callback<void()> complete=0, uint32_t millisec=0);
+
+    /** Get the statistics of this pool
+      @param   stats  structure filled with the current statistics.
+    */
+    void get_stats(thread_pool_stats_t *stats);
+
+    /** Stop accepting jobs, run the jobs already queued and stop the worker threads
+      @note not callable from interrupt or from a worker of this pool
+    */
+    void shutdown();
+
+    ~ThreadPool();
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void worker();
+
+    Thread **_threads;
+    uint32_t _workers;
+    Semaphore _space_sem;
+    Semaphore _job_sem;
+    Mutex _mutex;
+    Job *_head;
+    Job *_tail;
+    bool _stopping;
+
+    uint32_t _busy_workers;
+    uint32_t _queue_depth;
+    uint32_t _max_queue_depth;
+    uint32_t _jobs_completed;
+    uint64_t _busy_time_us;
+    uint32_t _max_latency_us;
+    uint64_t _total_latency_us;
+    uint32_t _start_us;
+};
+
+}
+#endif
+
+/** @}*/
@@ -32,6 +32,7 @@
 #include "rtos/Mail.h"
 #include "rtos/MemoryPool.h"
 #include "rtos/Queue.h"
+#include "rtos/ThreadPool.h"
 
 using namespace rtos;
 
@@ -31,7 +31,14 @@ static void default_idle_hook(void)
     */
     sleep();
 }
-static void (*idle_hook_fptr)(void) = &default_idle_hook;
+
+#if MBED_CONF_RTOS_TICKLESS_IDLE && DEVICE_LOWPOWERTIMER && defined(__MBED_CMSIS_RTOS_CM)
+#define IDLE_HOOK_DEFAULT rtos_tickless_idle
+#else
+#define IDLE_HOOK_DEFAULT default_idle_hook
+#endif
+
+static void (*idle_hook_fptr)(void) = &IDLE_HOOK_DEFAULT;
 
 void rtos_attach_idle_hook(void (*fptr)(void))
 {
@@ -39,7 +46,7 @@ void rtos_attach_idle_hook(void (*fptr)(void))
     if (fptr != NULL) {
         idle_hook_fptr = fptr;
     } else {
-        idle_hook_fptr = default_idle_hook;
+        idle_hook_fptr = IDLE_HOOK_DEFAULT;
     }
 }
 
@@ -33,6 +33,12 @@ extern "C" {
 
 void rtos_attach_idle_hook(void (*fptr)(void));
 
+/** Idle hook that stops the kernel tick and sleeps until the nearest kernel,
+ *  us_ticker or EventQueue deadline, then corrects the kernel time.
+ *  Used as the default idle hook when rtos.tickless-idle is enabled.
+ */
+void rtos_tickless_idle(void);
+
 #ifdef __cplusplus
 }
 #endif
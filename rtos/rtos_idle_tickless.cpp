@@ -0,0 +1,87 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2012 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "rtos/rtos_idle.h"
+
+#include "mbed.h"
+
+#if MBED_CONF_RTOS_TICKLESS_IDLE && DEVICE_LOWPOWERTIMER && defined(__MBED_CMSIS_RTOS_CM)
+
+#include "platform/SingletonPtr.h"
+#include "hal/us_ticker_api.h"
+#include "hal/lp_ticker_api.h"
+
+// Kernel tick period in microseconds, defined by RTX_CM_lib.h
+extern "C" uint32_t const os_clockrate;
+
+// Kernel ticks passed for fewer than this are not worth a wakeup timer
+#define TICKLESS_MIN_TICKS 2
+
+static SingletonPtr<LowPowerTimeout> wakeup;
+
+// Sleep time not yet handed to the kernel because it was less than a tick
+static uint32_t residual_us = 0;
+
+static void wakeup_handler(void)
+{
+    // Nothing to do, the interrupt itself ends sleep()
+}
+
+extern "C" void rtos_tickless_idle(void)
+{
+    // Lock the scheduler and stop the SysTick interrupt. Threads readied by
+    // interrupts from here on are only dispatched by os_resume.
+    uint32_t ticks = os_suspend();
+    if (ticks < TICKLESS_MIN_TICKS) {
+        os_resume(0);
+        sleep();
+        return;
+    }
+
+    // os_suspend covers the kernel delay list and RTX timers; the us_ticker
+    // queue carries Ticker, Timeout and the EventQueue timer.
+    uint32_t sleep_us = ticks * os_clockrate;
+    timestamp_t next;
+    if (ticker_get_next_timestamp(get_us_ticker_data(), &next)) {
+        int32_t until_next = (int32_t)(next - us_ticker_read());
+        if (until_next <= 0) {
+            os_resume(0);
+            return;
+        }
+        if ((uint32_t)until_next < sleep_us) {
+            sleep_us = until_next;
+        }
+    }
+
+    uint32_t start = lp_ticker_read();
+    wakeup->attach_us(wakeup_handler, sleep_us);
+    sleep();
+    wakeup->detach();
+
+    // Hand every whole tick that passed to the kernel, even past the
+    // deadline when the wakeup ran late, and carry the remainder over
+    uint32_t slept_us = (lp_ticker_read() - start) + residual_us;
+    uint32_t slept_ticks = slept_us / os_clockrate;
+    residual_us = slept_us - slept_ticks * os_clockrate;
+    os_resume(slept_ticks);
+}
+
+#endif
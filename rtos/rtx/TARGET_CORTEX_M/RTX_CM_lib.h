@@ -167,6 +167,10 @@ uint8_t  const os_fifo_size = OS_FIFOSZ;
 /* An array of Active task pointers. */
 void *os_active_TCB[OS_TASK_CNT];
 
+/* Lowest stack word seen in use by each task, 0=none. Kept outside the */
+/* TCB so that its layout and OS_TCB_SIZE stay unchanged.               */
+uint32_t os_stack_hwm[OS_TASK_CNT];
+
 /* User Timers Resources */
 #if (OS_TIMERS != 0)
 extern void osTimerThread (void const *argument);
@@ -53,6 +53,7 @@ extern U32 mp_tcb[];
 extern U64 mp_stk[];
 extern U32 os_fifo[];
 extern void *os_active_TCB[];
+extern U32 os_stack_hwm[];
 
 /* Constants */
 extern U16 const os_maxtaskrun;
@@ -107,6 +107,7 @@
 #define osFeature_Wait         0       ///< osWait not available
 #define osFeature_SysTick      1       ///< osKernelSysTick functions available
 #define osFeature_ThreadEnum   1       ///< Thread enumeration available
+#define osFeature_MessageBatch 1       ///< Batched Message Queue put/get available
 
 #if defined (__CC_ARM)
 #define os_InRegs __value_in_regs      // Compiler specific: force struct in registers
@@ -173,6 +174,8 @@ typedef enum {
   osThreadInfoStackMax,
   osThreadInfoEntry,
   osThreadInfoArg,
+  osThreadInfoStackWatermark,        ///< maximum stack usage, resuming the scan from the last known high-water mark
+  osThreadInfoStackWatermarkLast,    ///< maximum stack usage found by the last scan, without scanning
 
   osThreadInfo_reserved   =  0x7FFFFFFF  ///< prevent from enum down-size compiler optimization.
 } osThreadInfo;
@@ -640,6 +643,24 @@ osStatus osMessagePut (osMessageQId queue_id, uint32_t info, uint32_t millisec);
 /// \return event information that includes status code.
 os_InRegs osEvent osMessageGet (osMessageQId queue_id, uint32_t millisec);
 
+#if (defined (osFeature_MessageBatch)  &&  (osFeature_MessageBatch != 0))     // Batched Message Queue access available
+
+/// Put several Messages to a Queue without waiting.
+/// \param[in]     queue_id      message queue ID obtained with \ref osMessageCreate.
+/// \param[in]     info          array of message information.
+/// \param[in]     count         number of entries in info.
+/// \return number of messages put, stops at the first one that does not fit.
+uint32_t osMessagePutBatch (osMessageQId queue_id, const uint32_t *info, uint32_t count);
+
+/// Get several Messages from a Queue without waiting.
+/// \param[in]     queue_id      message queue ID obtained with \ref osMessageCreate.
+/// \param[out]    info          array receiving the message information.
+/// \param[in]     count         maximum number of messages to get.
+/// \return number of messages received.
+uint32_t osMessageGetBatch (osMessageQId queue_id, uint32_t *info, uint32_t count);
+
+#endif     // Batched Message Queue access available
+
 #endif     // Message Queues available
 
 
@@ -704,6 +725,24 @@ os_InRegs osEvent osMailGet (osMailQId queue_id, uint32_t millisec);
 /// \return status code that indicates the execution status of the function.
 osStatus osMailFree (osMailQId queue_id, void *mail);
 
+#if (defined (osFeature_MessageBatch)  &&  (osFeature_MessageBatch != 0))     // Batched Message Queue access available
+
+/// Put several mails to a queue without waiting.
+/// \param[in]     queue_id      mail queue ID obtained with \ref osMailCreate.
+/// \param[in]     mail          array of memory blocks previously allocated with \ref osMailAlloc or \ref osMailCAlloc.
+/// \param[in]     count         number of entries in mail.
+/// \return number of mails put, stops at the first one that does not fit.
+uint32_t osMailPutBatch (osMailQId queue_id, void *const *mail, uint32_t count);
+
+/// Get several mails from a queue without waiting.
+/// \param[in]     queue_id      mail queue ID obtained with \ref osMailCreate.
+/// \param[out]    mail          array receiving the memory blocks.
+/// \param[in]     count         maximum number of mails to get.
+/// \return number of mails received.
+uint32_t osMailGetBatch (osMailQId queue_id, void **mail, uint32_t count);
+
+#endif     // Batched Message Queue access available
+
 #endif  // Mail Queues available
 
 
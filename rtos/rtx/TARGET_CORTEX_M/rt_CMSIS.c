@@ -624,6 +624,11 @@ uint32_t osKernelSysTick (void) {
 
 // ==== Thread Management ====
 
+/// Untouched stack words that end an incremental watermark scan
+#ifndef STACK_WATERMARK_GAP
+#define STACK_WATERMARK_GAP 32U
+#endif
+
 /// Set Thread Error (for Create functions which return IDs)
 static void sysThreadError (osStatus status) {
   // To Do
@@ -821,8 +826,13 @@ os_InRegs osEvent_type svcThreadGetInfo (osThreadId thread_id, osThreadInfo info
     return osEvent_ret_value;
   }
 
-  if (osThreadInfoStackMax == info) {
+  if ((osThreadInfoStackMax == info) ||
+      (osThreadInfoStackWatermark == info) ||
+      (osThreadInfoStackWatermarkLast == info)) {
     uint32_t i;
+    uint32_t gap;
+    uint32_t hwm;
+    U32 *slot;
     uint32_t *stack_ptr;
     uint32_t stack_size;
     if (!(os_stackinfo & (1 << 28))) {
@@ -836,10 +846,34 @@ os_InRegs osEvent_type svcThreadGetInfo (osThreadId thread_id, osThreadInfo info
       // This is an OS task - always a fixed size
       stack_size = os_stackinfo & 0x3FFFF;
     }
-    for (i = 1; i <stack_size / 4; i++) {
-      if (stack_ptr[i] != MAGIC_PATTERN) {
-        break;
+    // The idle demon has no slot and always gets a full scan
+    slot = ((ptcb->task_id != 0U) && (ptcb->task_id <= os_maxtaskrun)) ?
+           &os_stack_hwm[ptcb->task_id - 1U] : NULL;
+    hwm = (slot != NULL) ? *slot : 0U;
+    if (osThreadInfoStackWatermarkLast == info) {
+      ret.value.v = (hwm != 0U) ? stack_size - hwm * 4 : 0U;
+      return osEvent_ret_value;
+    }
+    if ((osThreadInfoStackWatermark == info) && (hwm != 0U)) {
+      // Stack usage only grows: walk down from the last high-water mark
+      // and stop after a run of untouched words
+      i = hwm;
+      for (gap = 0U; (i - gap > 1U) && (gap < STACK_WATERMARK_GAP); ) {
+        gap++;
+        if (stack_ptr[i - gap] != MAGIC_PATTERN) {
+          i -= gap;
+          gap = 0U;
+        }
       }
+    } else {
+      for (i = 1; i <stack_size / 4; i++) {
+        if (stack_ptr[i] != MAGIC_PATTERN) {
+          break;
+        }
+      }
+    }
+    if (slot != NULL) {
+      *slot = i;
     }
     ret.value.v = stack_size - i * 4;
     return osEvent_ret_value;
@@ -1965,6 +1999,8 @@ osStatus osPoolFree (osPoolId pool_id, void *block) {
 SVC_2_1(svcMessageCreate,        osMessageQId, const osMessageQDef_t *, osThreadId,           RET_pointer)
 SVC_3_1(svcMessagePut,           osStatus,           osMessageQId,      uint32_t,   uint32_t, RET_osStatus)
 SVC_2_3(svcMessageGet, os_InRegs osEvent,            osMessageQId,      uint32_t,             RET_osEvent)
+SVC_3_1(svcMessagePutBatch,      uint32_t,           osMessageQId,      const uint32_t *, uint32_t, RET_uint32_t)
+SVC_3_1(svcMessageGetBatch,      uint32_t,           osMessageQId,      uint32_t *, uint32_t, RET_uint32_t)
 
 // Message Queue Service Calls
 
@@ -2036,6 +2072,34 @@ os_InRegs osEvent_type svcMessageGet (osMessageQId queue_id, uint32_t millisec)
   return osEvent_ret_value;
 }
 
+/// Put several Messages to a Queue without waiting
+uint32_t svcMessagePutBatch (osMessageQId queue_id, const uint32_t *info, uint32_t count) {
+
+  if ((queue_id == NULL) || (info == NULL)) {
+    return 0U;
+  }
+
+  if (((P_MCB)queue_id)->cb_type != MCB) {
+    return 0U;
+  }
+
+  return rt_mbx_send_n(queue_id, (void *const *)info, count);
+}
+
+/// Get several Messages from a Queue without waiting
+uint32_t svcMessageGetBatch (osMessageQId queue_id, uint32_t *info, uint32_t count) {
+
+  if ((queue_id == NULL) || (info == NULL)) {
+    return 0U;
+  }
+
+  if (((P_MCB)queue_id)->cb_type != MCB) {
+    return 0U;
+  }
+
+  return rt_mbx_wait_n(queue_id, (void **)info, count);
+}
+
 
 // Message Queue ISR Calls
 
@@ -2086,6 +2150,35 @@ os_InRegs osEvent isrMessageGet (osMessageQId queue_id, uint32_t millisec) {
   return ret;
 }
 
+/// Put several Messages to a Queue without waiting
+uint32_t isrMessagePutBatch (osMessageQId queue_id, const uint32_t *info, uint32_t count) {
+  uint32_t sent;
+
+  for (sent = 0U; sent < count; sent++) {
+    if (isrMessagePut(queue_id, info[sent], 0U) != osOK) {
+      break;
+    }
+  }
+
+  return sent;
+}
+
+/// Get several Messages from a Queue without waiting
+uint32_t isrMessageGetBatch (osMessageQId queue_id, uint32_t *info, uint32_t count) {
+  osEvent  evt;
+  uint32_t recv;
+
+  for (recv = 0U; recv < count; recv++) {
+    evt = isrMessageGet(queue_id, 0U);
+    if (evt.status != osEventMessage) {
+      break;
+    }
+    info[recv] = evt.value.v;
+  }
+
+  return recv;
+}
+
 
 // Message Queue Management Public API
 
@@ -2120,6 +2213,24 @@ os_InRegs osEvent osMessageGet (osMessageQId queue_id, uint32_t millisec) {
   }
 }
 
+/// Put several Messages to a Queue without waiting
+uint32_t osMessagePutBatch (osMessageQId queue_id, const uint32_t *info, uint32_t count) {
+  if (__get_PRIMASK() != 0U || __get_IPSR() != 0U) {                     // in ISR
+    return   isrMessagePutBatch(queue_id, info, count);
+  } else {                                      // in Thread
+    return __svcMessagePutBatch(queue_id, info, count);
+  }
+}
+
+/// Get several Messages from a Queue without waiting
+uint32_t osMessageGetBatch (osMessageQId queue_id, uint32_t *info, uint32_t count) {
+  if (__get_PRIMASK() != 0U || __get_IPSR() != 0U) {                     // in ISR
+    return   isrMessageGetBatch(queue_id, info, count);
+  } else {                                      // in Thread
+    return __svcMessageGetBatch(queue_id, info, count);
+  }
+}
+
 
 // ==== Mail Queue Management Functions ====
 
@@ -2323,6 +2434,22 @@ os_InRegs osEvent osMailGet (osMailQId queue_id, uint32_t millisec) {
   return ret;
 }
 
+/// Put several mails to a queue without waiting
+uint32_t osMailPutBatch (osMailQId queue_id, void *const *mail, uint32_t count) {
+  if ((queue_id == NULL) || (mail == NULL)) {
+    return 0U;
+  }
+  return osMessagePutBatch(*((void **)queue_id), (const uint32_t *)mail, count);
+}
+
+/// Get several mails from a queue without waiting
+uint32_t osMailGetBatch (osMailQId queue_id, void **mail, uint32_t count) {
+  if ((queue_id == NULL) || (mail == NULL)) {
+    return 0U;
+  }
+  return osMessageGetBatch(*((void **)queue_id), (uint32_t *)mail, count);
+}
+
 
 //  ==== RTX Extensions ====
 
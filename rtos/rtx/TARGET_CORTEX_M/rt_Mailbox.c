@@ -174,6 +174,98 @@ OS_RESULT rt_mbx_wait (OS_ID mailbox, void **message, U16 timeout) {
 }
 
 
+/*--------------------------- rt_mbx_send_n ---------------------------------*/
+
+U32 rt_mbx_send_n (OS_ID mailbox, void *const *p_msg, U32 count) {
+  /* Send up to "count" messages to a mailbox without waiting. Waiting     */
+  /* receivers are made ready and a task switch is requested only once.    */
+  P_MCB p_MCB = mailbox;
+  P_TCB p_TCB;
+  U32   sent;
+
+  for (sent = 0U; sent < count; sent++) {
+    if ((p_MCB->p_lnk != NULL) && (p_MCB->state == 1U)) {
+      /* A task is waiting for message */
+      p_TCB = rt_get_first ((P_XCB)p_MCB);
+#ifdef __CMSIS_RTOS
+      rt_ret_val2(p_TCB, 0x10U/*osEventMessage*/, (U32)p_msg[sent]);
+#else
+      *p_TCB->msg = p_msg[sent];
+      rt_ret_val (p_TCB, OS_R_MBX);
+#endif
+      rt_rmv_dly (p_TCB);
+      p_TCB->state = READY;
+      rt_put_prio (&os_rdy, p_TCB);
+    }
+    else {
+      if (p_MCB->count == p_MCB->size) {
+        /* Mailbox is full */
+        break;
+      }
+      p_MCB->msg[p_MCB->first] = p_msg[sent];
+      rt_inc (&p_MCB->count);
+      if (++p_MCB->first == p_MCB->size) {
+        p_MCB->first = 0U;
+      }
+    }
+  }
+
+  if ((os_rdy.p_lnk != NULL) && (os_rdy.p_lnk->prio > os_tsk.run->prio)) {
+    /* preempt running task */
+    rt_put_prio (&os_rdy, os_tsk.run);
+    os_tsk.run->state = READY;
+    rt_dispatch (NULL);
+  }
+  return (sent);
+}
+
+
+/*--------------------------- rt_mbx_wait_n ---------------------------------*/
+
+U32 rt_mbx_wait_n (OS_ID mailbox, void **message, U32 count) {
+  /* Receive up to "count" messages from a mailbox without waiting. Tasks  */
+  /* blocked on a full mailbox are made ready and a task switch is         */
+  /* requested only once.                                                  */
+  P_MCB p_MCB = mailbox;
+  P_TCB p_TCB;
+  U32   recv;
+
+  for (recv = 0U; (recv < count) && (p_MCB->count != 0U); recv++) {
+    message[recv] = p_MCB->msg[p_MCB->last];
+    if (++p_MCB->last == p_MCB->size) {
+      p_MCB->last = 0U;
+    }
+    if ((p_MCB->p_lnk != NULL) && (p_MCB->state == 2U)) {
+      /* A task is waiting to send message */
+      p_TCB = rt_get_first ((P_XCB)p_MCB);
+#ifdef __CMSIS_RTOS
+      rt_ret_val(p_TCB, 0U/*osOK*/);
+#else
+      rt_ret_val(p_TCB, OS_R_OK);
+#endif
+      p_MCB->msg[p_MCB->first] = p_TCB->msg;
+      if (++p_MCB->first == p_MCB->size) {
+        p_MCB->first = 0U;
+      }
+      rt_rmv_dly (p_TCB);
+      p_TCB->state = READY;
+      rt_put_prio (&os_rdy, p_TCB);
+    }
+    else {
+      rt_dec (&p_MCB->count);
+    }
+  }
+
+  if ((os_rdy.p_lnk != NULL) && (os_rdy.p_lnk->prio > os_tsk.run->prio)) {
+    /* preempt running task */
+    rt_put_prio (&os_rdy, os_tsk.run);
+    os_tsk.run->state = READY;
+    rt_dispatch (NULL);
+  }
+  return (recv);
+}
+
+
 /*--------------------------- rt_mbx_check ----------------------------------*/
 
 OS_RESULT rt_mbx_check (OS_ID mailbox) {
@@ -39,6 +39,8 @@
 extern void      rt_mbx_init  (OS_ID mailbox, U16 mbx_size);
 extern OS_RESULT rt_mbx_send  (OS_ID mailbox, void *p_msg,    U16 timeout);
 extern OS_RESULT rt_mbx_wait  (OS_ID mailbox, void **message, U16 timeout);
+extern U32       rt_mbx_send_n (OS_ID mailbox, void *const *p_msg, U32 count);
+extern U32       rt_mbx_wait_n (OS_ID mailbox, void **message, U32 count);
 extern OS_RESULT rt_mbx_check (OS_ID mailbox);
 extern void      isr_mbx_send (OS_ID mailbox, void *p_msg);
 extern OS_RESULT isr_mbx_receive (OS_ID mailbox, void **message);
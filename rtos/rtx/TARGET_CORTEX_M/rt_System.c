@@ -132,6 +132,7 @@ void rt_resume (U32 sleep_time) {
         delta--;
         os_time++;
       }
+      os_time += delta;
     } else {
       os_time           +=      delta;
       os_dly.delta_time -= (U16)delta;
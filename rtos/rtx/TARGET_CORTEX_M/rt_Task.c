@@ -87,6 +87,9 @@ static void rt_init_context (P_TCB p_TCB, U8 priority, FUNCP task_body) {
   p_TCB->events  = 0U;
   p_TCB->waits   = 0U;
   p_TCB->stack_frame = 0U;
+  if ((p_TCB->task_id != 0U) && (p_TCB->task_id <= os_maxtaskrun)) {
+    os_stack_hwm[p_TCB->task_id-1U] = 0U;
+  }
 
   if (p_TCB->priv_stack == 0U) {
     /* Allocate the memory space for the stack. */